@@ -0,0 +1,158 @@
+#ifndef __BASIC_PROBE
+#define __BASIC_PROBE
+#include <ProbeTelemetry.hpp>
+#include <ProbeUtilities.hpp>
+
+/*
+ * Определения методов BasicProbe. Нужны только там, где шаблон
+ * инстанцируется: в ProbeUtilities.cpp для реализации текущей ОС и в
+ * программах, которые подставляют собственную реализацию
+ * */
+
+namespace info
+{
+template <typename Backend>
+BasicProbe<Backend>::BasicProbe() : BasicProbe(ProbeOptions{})
+{
+}
+
+template <typename Backend>
+BasicProbe<Backend>::BasicProbe(ProbeOptions options)
+    : BasicProbe(std::make_unique<Backend>(options))
+{
+}
+
+template <typename Backend>
+BasicProbe<Backend>::BasicProbe(std::unique_ptr<Backend> backend)
+    : _backend(std::move(backend)), _telemetry(new ProbeTelemetry)
+{
+}
+
+template <typename Backend> BasicProbe<Backend>::~BasicProbe() = default;
+
+template <typename Backend>
+OSInfo BasicProbe<Backend>::getOSInfo(OSField fields)
+{
+    ProbeTelemetry::Scope scope(*_telemetry, ProbeKind::OSInfo);
+    return _backend->getOSInfo(fields);
+}
+
+template <typename Backend>
+std::vector<UserInfo> BasicProbe<Backend>::getUserInfo()
+{
+    ProbeTelemetry::Scope scope(*_telemetry, ProbeKind::UserInfo);
+    return _backend->getUserInfo();
+}
+
+template <typename Backend>
+std::vector<DiscPartitionInfo> BasicProbe<Backend>::getDiscPartitionInfo()
+{
+    ProbeTelemetry::Scope scope(*_telemetry, ProbeKind::DiscPartitionInfo);
+    return _backend->getDiscPartitionInfo();
+}
+
+template <typename Backend>
+std::vector<MountInfo> BasicProbe<Backend>::getMountInfo(const MountFilter &filter)
+{
+    ProbeTelemetry::Scope scope(*_telemetry, ProbeKind::MountInfo);
+    return _backend->getMountInfo(filter);
+}
+
+template <typename Backend>
+std::vector<PeripheryInfo> BasicProbe<Backend>::getPeripheryInfo()
+{
+    ProbeTelemetry::Scope scope(*_telemetry, ProbeKind::PeripheryInfo);
+    return _backend->getPeripheryInfo();
+}
+
+template <typename Backend>
+std::vector<NetworkInterfaceInfo> BasicProbe<Backend>::getNetworkInterfaceInfo()
+{
+    ProbeTelemetry::Scope scope(*_telemetry, ProbeKind::NetworkInterfaceInfo);
+    return _backend->getNetworkInterfaceInfo();
+}
+
+template <typename Backend>
+SocketInfo BasicProbe<Backend>::getSocketInfo()
+{
+    ProbeTelemetry::Scope scope(*_telemetry, ProbeKind::SocketInfo);
+    return _backend->getSocketInfo();
+}
+
+template <typename Backend>
+MemoryInfo BasicProbe<Backend>::getMemoryInfo(MemoryField fields)
+{
+    ProbeTelemetry::Scope scope(*_telemetry, ProbeKind::MemoryInfo);
+    return _backend->getMemoryInfo(fields);
+}
+
+template <typename Backend> VMInfo BasicProbe<Backend>::getVMInfo()
+{
+    ProbeTelemetry::Scope scope(*_telemetry, ProbeKind::VMInfo);
+    return _backend->getVMInfo();
+}
+
+template <typename Backend>
+std::vector<CgroupInfo>
+BasicProbe<Backend>::getCgroupInfo(const CgroupFilter &filter)
+{
+    ProbeTelemetry::Scope scope(*_telemetry, ProbeKind::CgroupInfo);
+    return _backend->getCgroupInfo(filter);
+}
+
+template <typename Backend>
+CPUInfo BasicProbe<Backend>::getCPUInfo(CPUField fields)
+{
+    ProbeTelemetry::Scope scope(*_telemetry, ProbeKind::CPUInfo);
+    return _backend->getCPUInfo(fields);
+}
+
+template <typename Backend>
+CPUTimesInfo BasicProbe<Backend>::getCPUTimes()
+{
+    ProbeTelemetry::Scope scope(*_telemetry, ProbeKind::CPUTimes);
+    return _backend->getCPUTimes();
+}
+
+template <typename Backend>
+SchedulerInfo BasicProbe<Backend>::getSchedulerInfo()
+{
+    ProbeTelemetry::Scope scope(*_telemetry, ProbeKind::SchedulerInfo);
+    return _backend->getSchedulerInfo();
+}
+
+template <typename Backend>
+InterruptInfo BasicProbe<Backend>::getInterruptInfo()
+{
+    InterruptInfo output;
+    getInterruptInfo(output);
+    return output;
+}
+
+template <typename Backend>
+void BasicProbe<Backend>::getInterruptInfo(InterruptInfo &output)
+{
+    ProbeTelemetry::Scope scope(*_telemetry, ProbeKind::InterruptInfo);
+    _backend->getInterruptInfo(output);
+}
+
+template <typename Backend> ThermalInfo BasicProbe<Backend>::getThermalInfo()
+{
+    ProbeTelemetry::Scope scope(*_telemetry, ProbeKind::ThermalInfo);
+    return _backend->getThermalInfo();
+}
+
+template <typename Backend>
+PerfCounterInfo BasicProbe<Backend>::getPerfCounterInfo()
+{
+    ProbeTelemetry::Scope scope(*_telemetry, ProbeKind::PerfCounterInfo);
+    return _backend->getPerfCounterInfo();
+}
+
+template <typename Backend> SelfStats BasicProbe<Backend>::getSelfStats() const
+{
+    return _telemetry->snapshot();
+}
+} // namespace info
+
+#endif
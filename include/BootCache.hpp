@@ -0,0 +1,99 @@
+#ifndef __BOOT_CACHE
+#define __BOOT_CACHE
+#include <ProbeUtilities.hpp>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+ * Кэш статической информации о системе на диске (Linux): модель и кэши
+ * процессора и список периферийных устройств. Эти данные не меняются до
+ * перезагрузки, а их получение (lscpu, lshw) занимает сотни миллисекунд,
+ * поэтому короткоживущие процессы берут их из компактного двоичного файла.
+ * Файл привязан к /proc/sys/kernel/random/boot_id, а список устройств еще и
+ * к счетчику событий горячего подключения /sys/kernel/uevent_seqnum
+ * */
+
+namespace info
+{
+class BootCache
+{
+  public:
+    /**
+     * @param path Файл кэша. Пустая строка отключает кэш
+     */
+    explicit BootCache(std::string path);
+
+    BootCache(const BootCache &) = delete;
+    BootCache &operator=(const BootCache &) = delete;
+
+    bool enabled() const { return !_path.empty(); }
+
+    /**
+     * @brief Заполняет name, cores, physid и overall_cache и отмечает в
+     * out.fields те из них, что были найдены при сохранении
+     *
+     * @return false, если в кэше нет этих данных
+     *
+     * @note Пустые результаты (lscpu или lshw не отработали) не сохраняются
+     */
+    bool cpuBasic(CPUInfo &out);
+    void storeCPUBasic(const CPUInfo &info);
+
+    /**
+     * @brief Заполняет l1_cache, l2_cache и l3_cache
+     */
+    bool cpuCache(CPUInfo &out);
+    void storeCPUCache(const CPUInfo &info);
+
+    /**
+     * @brief Текущее значение счетчика событий горячего подключения
+     *
+     * @details Считывается до опроса устройств и передается в
+     * storePeriphery(): если устройство подключили во время опроса, запись
+     * сразу окажется устаревшей
+     */
+    uint64_t generation() const;
+
+    /**
+     * @return false, если в кэше нет списка или он записан при другом
+     * значении счетчика
+     */
+    bool periphery(uint64_t generation, std::vector<PeripheryInfo> &out);
+    void storePeriphery(uint64_t generation,
+                        const std::vector<PeripheryInfo> &devices);
+
+    /**
+     * @brief Идентификатор текущей загрузки системы
+     */
+    static std::string bootId();
+
+  private:
+    enum Section : uint32_t
+    {
+        CPUBasic = 1,
+        CPUCache = 2,
+        Periphery = 4
+    };
+
+    std::string _path;
+    std::mutex _mutex;
+    bool _loaded{false};
+    std::string _bootId;
+    uint32_t _sections{0};
+
+    std::string _cpuName;
+    uint32_t _cores{0};
+    uint64_t _physid{0}, _overallCache{0};
+    CPUField _cpuFields{}; ///< Какие из полей выше были найдены
+    uint64_t _l1{0}, _l2{0}, _l3{0};
+    uint64_t _generation{0};
+    std::vector<PeripheryInfo> _periphery;
+
+    void _load();
+    void _save();
+};
+} // namespace info
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef __CGROUP_PROBE
+#define __CGROUP_PROBE
+#include <ProbeSource.hpp>
+#include <ProbeUtilities.hpp>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Обход иерархии контрольных групп cgroup v2. На машинах с контейнерами
+ * групп бывают десятки тысяч, и последовательный обход с четырьмя файлами
+ * на группу занимает сотни миллисекунд. Поэтому иерархия обходится
+ * несколькими потоками: у каждого своя очередь поддиректорий, свободный
+ * поток забирает работу из начала чужой очереди, где лежат поддеревья
+ * ближе к корню и, как правило, крупнее
+ * */
+
+namespace info
+{
+/**
+ * @brief Накопленные счетчики одной группы
+ */
+struct CgroupCounters
+{
+    uint64_t usage{0};     ///< usage_usec из cpu.stat
+    uint64_t user{0};      ///< user_usec
+    uint64_t system{0};    ///< system_usec
+    uint64_t throttled{0}; ///< throttled_usec
+    uint64_t readBytes{0}, writeBytes{0}; ///< Суммы по устройствам io.stat
+    uint64_t readOps{0}, writeOps{0};
+};
+
+class CgroupProbe
+{
+  public:
+    CgroupProbe(ProbeSource &source, std::chrono::milliseconds warmup);
+
+    CgroupProbe(const CgroupProbe &) = delete;
+    CgroupProbe &operator=(const CgroupProbe &) = delete;
+
+    /**
+     * @brief Обходит иерархию и считает частоты с предыдущего обхода
+     *
+     * @details Первый вызов делает начальный обход и ждет
+     * ProbeOptions::warmupDelay. Предыдущие счетчики хранятся для каждой
+     * группы отдельно, поэтому вызовы с разными фильтрами не мешают друг
+     * другу
+     */
+    std::vector<CgroupInfo> sample(const CgroupFilter &filter);
+
+    /**
+     * @brief Разбирает содержимое cpu.stat
+     */
+    static void parseCpuStat(const std::string &raw, CgroupCounters &out);
+
+    /**
+     * @brief Разбирает содержимое io.stat, суммируя строки всех устройств
+     */
+    static void parseIoStat(const std::string &raw, CgroupCounters &out);
+
+  private:
+    struct Group
+    {
+        std::string path;
+        uint32_t depth;
+        uint64_t memory;
+        uint64_t pids;
+        CgroupCounters counters;
+    };
+
+    struct Previous
+    {
+        CgroupCounters counters;
+        std::chrono::nanoseconds time;
+        uint32_t depth;
+        bool seen;
+    };
+
+    ProbeSource &_source;
+    std::chrono::milliseconds _warmup;
+    std::mutex _mutex;
+    bool _opened{false};
+    std::string _root;
+    unsigned _threads;
+    std::unordered_map<std::string, Previous> _previous;
+
+    std::vector<CgroupInfo> _collect(const CgroupFilter &filter);
+    std::vector<Group> _walk(const CgroupFilter &filter);
+    void _readGroup(Group &group, std::string &buffer);
+};
+} // namespace info
+
+#endif
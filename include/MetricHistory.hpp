@@ -0,0 +1,199 @@
+#ifndef __METRIC_HISTORY
+#define __METRIC_HISTORY
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * История замеров в памяти и статистика по ней: минимум, максимум, среднее,
+ * квантили по окнам времени для каждого ряда и по всем рядам вместе (например,
+ * по всем ядрам из CPUInfo::load), а также экспоненциальное скользящее
+ * среднее. Значения каждого ряда лежат в своем кольцевом буфере подряд, а
+ * для каждого блока из BLOCK замеров заранее считаются минимум, максимум,
+ * сумма и сжатая гистограмма, поэтому запрос по длинному окну обходит
+ * итоги блоков, а не все значения
+ * */
+
+namespace info
+{
+/**
+ * @brief Итоги ряда или группы рядов за окно
+ */
+struct SeriesStats
+{
+    std::size_t count{0}; ///< Количество значений, 0 - в окне нет замеров
+    double min{0};
+    double max{0};
+    double mean{0};
+};
+
+/**
+ * @brief История нескольких рядов с общими моментами замеров
+ *
+ * @details Окно задается длительностью и отсчитывается от последнего
+ * замера: в окно попадают замеры, сделанные позже, чем time - window.
+ * Значения хранятся как float.
+ *
+ * Квантили по окну не длиннее EXACT_LIMIT значений точные. Для длинных окон
+ * используются гистограммы блоков: значения в них округлены до 8 значащих
+ * двоичных разрядов, поэтому относительная погрешность квантиля не больше
+ * 0.4%
+ *
+ * @note Не потокобезопасен: замеры и запросы должны выполняться из одного
+ * потока или под внешней блокировкой
+ */
+class MetricHistory
+{
+  public:
+    using clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Количество замеров в блоке с заранее посчитанными итогами
+     */
+    static constexpr std::size_t BLOCK = 64;
+
+    /**
+     * @brief Наибольшее количество значений, по которому квантиль считается
+     * точно
+     */
+    static constexpr std::size_t EXACT_LIMIT = 2 * BLOCK;
+
+    /**
+     * @param series Количество рядов, например количество ядер
+     * @param capacity Количество хранимых замеров, округляется вверх до
+     * кратного BLOCK
+     * @param halfLife Период полураспада для ewma()
+     */
+    MetricHistory(std::size_t series, std::size_t capacity,
+                  std::chrono::milliseconds halfLife = std::chrono::seconds(60));
+
+    /**
+     * @brief Добавляет замер всех рядов
+     *
+     * @details Время замеров не должно убывать. Нечисловые значения (NaN,
+     * бесконечность) заменяются предыдущим значением ряда
+     *
+     * @return false, если количество значений не совпадает с series()
+     */
+    bool append(clock::time_point time, const std::vector<float> &values);
+    bool append(clock::time_point time, const std::vector<double> &values);
+
+    std::size_t series() const { return _series; }
+    std::size_t capacity() const { return _capacity; }
+
+    /**
+     * @brief Количество хранимых замеров
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Итоги одного ряда за окно
+     */
+    SeriesStats stats(std::size_t series, clock::duration window) const;
+
+    /**
+     * @brief Итоги каждого ряда за окно
+     */
+    std::vector<SeriesStats> stats(clock::duration window) const;
+
+    /**
+     * @brief Итоги всех рядов вместе за окно
+     */
+    SeriesStats pooledStats(clock::duration window) const;
+
+    /**
+     * @brief Квантиль одного ряда за окно
+     *
+     * @param q Уровень от 0 до 1, например 0.95
+     *
+     * @return 0, если в окне нет замеров
+     */
+    double quantile(std::size_t series, clock::duration window,
+                    double q) const;
+
+    /**
+     * @brief Квантиль каждого ряда за окно
+     */
+    std::vector<double> quantiles(clock::duration window, double q) const;
+
+    /**
+     * @brief Квантиль всех значений всех рядов за окно
+     */
+    double pooledQuantile(clock::duration window, double q) const;
+
+    /**
+     * @brief Экспоненциальное скользящее среднее ряда
+     *
+     * @details Обновляется при каждом замере с весом, зависящим от времени
+     * между замерами, поэтому не зависит от периода опроса и не ограничено
+     * емкостью истории
+     */
+    double ewma(std::size_t series) const;
+
+    const std::vector<double> &ewma() const { return _ewma; }
+
+  private:
+    // Диапазон логических номеров замеров [begin, end)
+    struct Range
+    {
+        uint64_t begin, end;
+    };
+
+    std::size_t _series;
+    std::size_t _capacity;
+    std::size_t _blocks; ///< Количество блоков в кольце
+    double _halfLife;    ///< В единицах clock::duration
+
+    uint64_t _total{0}; ///< Количество замеров с начала работы
+    std::vector<int64_t> _times; ///< clock::time_point::time_since_epoch()
+    std::vector<float> _values; ///< По _capacity значений на ряд подряд
+
+    // Итоги завершенных блоков, по _blocks на ряд подряд
+    std::vector<float> _blockMin, _blockMax;
+    std::vector<double> _blockSum;
+
+    // Гистограммы завершенных блоков: пары (код значения << 16 | количество
+    // значений с кодом не больше этого) по возрастанию кода, по BLOCK на блок
+    // ряда
+    std::vector<uint32_t> _runs;
+    std::vector<uint8_t> _runCount;
+
+    // Общие гистограммы всех рядов по блокам: пары (код << 32 | накопленное
+    // количество)
+    std::vector<std::vector<uint64_t>> _pooledRuns;
+    std::vector<uint32_t> _blockCounts; ///< Количество по кодам при закрытии блока
+
+    // Последний замер и итоги текущего блока
+    std::vector<float> _last;
+    std::vector<float> _curMin, _curMax;
+    std::vector<double> _curSum;
+
+    std::vector<double> _ewma;
+
+    // Отсортированный кусок гистограммы в формате _runs
+    struct Span
+    {
+        const uint32_t *runs;
+        std::size_t count;
+    };
+
+    // Рабочие буферы запросов
+    mutable std::vector<float> _scratch;
+    mutable std::vector<uint32_t> _edges;
+    mutable std::vector<Span> _spans;
+    mutable std::vector<uint64_t> _histogram;
+
+    bool _append(clock::time_point time);
+    void _closeBlock(uint64_t block);
+
+    Range _window(clock::duration window) const;
+    SeriesStats _stats(std::size_t series, Range range) const;
+    void _merge(SeriesStats &into, const SeriesStats &part) const;
+    void _gather(std::size_t series, Range range) const;
+    void _addEdge(const float *values, std::size_t count) const;
+    double _select(uint64_t count, double q, const SeriesStats &bounds) const;
+};
+} // namespace info
+
+#endif
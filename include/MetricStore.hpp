@@ -0,0 +1,171 @@
+#ifndef __METRIC_STORE
+#define __METRIC_STORE
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * Хранилище истории замеров на диске. Замеры дописываются в сжатом виде в
+ * файлы-сегменты фиксированного размера, отображенные в память, поэтому
+ * после аварийного завершения процесса в файлах остается все, что он успел
+ * записать. Когда сегмент заполняется, создается следующий, а самые старые
+ * удаляются.
+ *
+ * Каждый сегмент разбит на блоки по BLOCK_SAMPLES замеров, и каждый блок
+ * сжат независимо: время - разностями второго порядка (delta-of-delta),
+ * значения-уровни - исключающим ИЛИ с предыдущим значением (как в Gorilla),
+ * значения-счетчики - приращениями в формате varint. Индекс блоков с
+ * временем первого замера хранится в начале сегмента, поэтому запрос за
+ * интервал распаковывает только блоки, попавшие в интервал
+ * */
+
+namespace info
+{
+struct MetricSegment;
+
+/**
+ * @brief Способ сжатия ряда
+ */
+enum class SeriesKind : uint8_t
+{
+    Gauge = 0,  ///< Произвольное число, сжимается через XOR
+    Counter = 1 ///< Целый счетчик, сжимается приращениями
+};
+
+/**
+ * @brief Описание ряда значений
+ */
+struct SeriesSpec
+{
+    std::string name;
+    SeriesKind kind{SeriesKind::Gauge};
+};
+
+/**
+ * @brief Параметры хранилища
+ */
+struct MetricStoreOptions
+{
+    /**
+     * @brief Размер одного файла-сегмента, в байтах
+     */
+    std::size_t segmentSize{1 << 20};
+
+    /**
+     * @brief Количество хранимых сегментов. Самые старые удаляются
+     */
+    std::size_t maxSegments{16};
+};
+
+/**
+ * @brief Значение ряда в момент замера
+ */
+struct MetricPoint
+{
+    std::chrono::system_clock::time_point time;
+    double value;
+};
+
+/**
+ * @brief Процесс, записывающий историю
+ *
+ * @details Запись каждый раз начинается с нового сегмента, сегменты
+ * предыдущих запусков остаются доступны для чтения. Время хранится с
+ * точностью до миллисекунды. Для одной директории должен работать только
+ * один писатель
+ */
+class MetricStore
+{
+  public:
+    /**
+     * @brief Количество замеров в одном блоке
+     */
+    static constexpr uint32_t BLOCK_SAMPLES = 128;
+
+    /**
+     * @param directory Директория сегментов, создается при необходимости
+     * @param series Ряды, значения которых передаются в append()
+     * @param options Размер и количество сегментов
+     */
+    MetricStore(std::string directory, std::vector<SeriesSpec> series,
+                MetricStoreOptions options = {});
+    ~MetricStore();
+
+    MetricStore(const MetricStore &) = delete;
+    MetricStore &operator=(const MetricStore &) = delete;
+
+    /**
+     * @brief Удалось ли создать сегмент
+     */
+    bool valid() const { return _segment != nullptr; }
+
+    /**
+     * @brief Дописывает замер
+     *
+     * @details Время, меньшее времени предыдущего замера (например, после
+     * перевода часов), заменяется временем предыдущего замера
+     *
+     * @param values Значения в порядке рядов из конструктора. Значения
+     * счетчиков округляются до целых
+     *
+     * @return false, если количество значений не совпадает с количеством
+     * рядов или не удалось создать новый сегмент
+     */
+    bool append(std::chrono::system_clock::time_point time,
+                const std::vector<double> &values);
+
+    const std::vector<SeriesSpec> &series() const { return _series; }
+
+  private:
+    std::string _directory;
+    std::vector<SeriesSpec> _series;
+    MetricStoreOptions _options;
+    MetricSegment *_segment{nullptr};
+    uint64_t _number{0};
+
+    // Состояние сжатия текущего блока
+    uint32_t _block{0};
+    uint32_t _samples{0};
+    uint64_t _bits{0};
+    int64_t _lastTime{0};
+    int64_t _lastDelta{0};
+    std::vector<uint64_t> _previous;
+    std::vector<uint8_t> _leading, _trailing;
+
+    bool _openSegment();
+    void _closeSegment();
+    void _removeOld();
+};
+
+/**
+ * @brief Чтение истории, в том числе во время записи другим процессом
+ */
+class MetricStoreReader
+{
+  public:
+    explicit MetricStoreReader(std::string directory);
+
+    /**
+     * @brief Имена рядов во всех сегментах, в порядке первого появления
+     */
+    std::vector<std::string> series() const;
+
+    /**
+     * @brief Значения ряда за интервал [from, to)
+     *
+     * @details Сегменты вне интервала не читаются, в остальных
+     * распаковываются только блоки, пересекающие интервал
+     *
+     * @return Значения в порядке записи. Пустой вектор, если ряда нет
+     */
+    std::vector<MetricPoint>
+    query(const std::string &series, std::chrono::system_clock::time_point from,
+          std::chrono::system_clock::time_point to) const;
+
+  private:
+    std::string _directory;
+};
+} // namespace info
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef __MOUNT_PROBE
+#define __MOUNT_PROBE
+#include <ProbeSource.hpp>
+#include <ProbeUtilities.hpp>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Заполненность всех точек монтирования. statvfs для сетевой файловой
+ * системы может зависнуть в ядре без возможности прерывания, поэтому
+ * вызовы выполняются в отдельных потоках, а вызывающий поток ждет каждый не
+ * дольше заданного времени и весь опрос - не дольше двух таких времен.
+ * Зависший поток не отменяется: он продолжает
+ * ждать ответа сервера, а точка монтирования не опрашивается повторно,
+ * пока он не вернется
+ * */
+
+namespace info
+{
+class MountProbe
+{
+  public:
+    MountProbe(ProbeSource &source, std::chrono::milliseconds timeout);
+
+    MountProbe(const MountProbe &) = delete;
+    MountProbe &operator=(const MountProbe &) = delete;
+
+    /**
+     * @brief Точки монтирования с размерами
+     */
+    std::vector<MountInfo> sample(const MountFilter &filter);
+
+    /**
+     * @brief Разбирает /proc/self/mountinfo
+     *
+     * @details Заполняет все поля, кроме размеров. Если точка
+     * перемонтирована поверх, остается только последняя запись
+     */
+    static std::vector<MountInfo> parseMountInfo(const std::string &raw);
+
+  private:
+    struct Batch;
+
+    ProbeSource &_source;
+    std::chrono::milliseconds _timeout;
+    std::mutex _mutex;
+    std::string _buffer;
+
+    /**
+     * @brief Точки, statvfs для которых еще не вернулся. Флаг выставляет
+     * поток, выполняющий statvfs, когда тот завершится
+     */
+    std::unordered_map<std::string, std::shared_ptr<std::atomic<bool>>> _hung;
+
+    void _stat(std::vector<MountInfo> &mounts);
+    void _replay(std::vector<MountInfo> &mounts);
+};
+} // namespace info
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef __PERF_EVENT_PROBE
+#define __PERF_EVENT_PROBE
+#include <ProbeSource.hpp>
+#include <ProbeUtilities.hpp>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+/*
+ * Счетчики производительности через perf_event_open. Для каждого логического
+ * процессора открывается одна группа событий с PERF_FORMAT_GROUP, поэтому
+ * все счетчики процессора читаются одним read(). Группы открываются при
+ * первом замере и остаются открытыми до уничтожения объекта
+ * */
+
+namespace info
+{
+class PerfEventProbe
+{
+  public:
+    PerfEventProbe(ProbeSource &source, std::chrono::milliseconds warmup);
+    ~PerfEventProbe();
+
+    PerfEventProbe(const PerfEventProbe &) = delete;
+    PerfEventProbe &operator=(const PerfEventProbe &) = delete;
+
+    /**
+     * @brief Частоты событий с предыдущего замера
+     *
+     * @details Первый вызов открывает события, делает начальный замер и ждет
+     * ProbeOptions::warmupDelay
+     */
+    PerfCounterInfo sample();
+
+    /**
+     * @brief Разбирает список процессоров в формате /sys ("0-3,8,10-11")
+     */
+    static std::vector<uint32_t> parseCPUList(const std::string &list);
+
+  private:
+    struct Group
+    {
+        uint32_t cpu;
+        std::vector<int> fds;  ///< Первый дескриптор - лидер группы
+        std::string previous; ///< Предыдущий ответ read() в сыром виде
+    };
+
+    ProbeSource &_source;
+    std::chrono::milliseconds _warmup;
+    std::mutex _mutex;
+    bool _opened{false};
+    std::vector<Group> _groups;
+
+    void _open();
+    bool _openGroup(Group &group, bool hardware);
+    bool _read(Group &group, std::string &out);
+};
+} // namespace info
+
+#endif
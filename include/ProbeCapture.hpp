@@ -0,0 +1,125 @@
+#ifndef __PROBE_CAPTURE
+#define __PROBE_CAPTURE
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace info
+{
+/**
+ * @brief Тип сырых данных, сохраняемых в файл записи
+ */
+enum class CaptureKind : uint8_t
+{
+    File = 1,          ///< Содержимое файла из /proc, /sys и т.д.
+    Command = 2,       ///< Вывод внешней утилиты
+    Netlink = 3,       ///< Ответ netlink-сокета
+    Syscall = 4,       ///< Структура, заполненная системным вызовом (statvfs, uname)
+    Directory = 5,     ///< Список имен в директории, через '\n'
+    Subdirectories = 6 ///< Список поддиректорий, через '\n'
+};
+
+/**
+ * @brief Запись сырых входных данных библиотеки в файл
+ *
+ * @details Формат файла: 8-байтовая сигнатура, затем последовательность
+ * записей. Каждая запись содержит тип, разницу во времени с предыдущей записью
+ * в наносекундах, идентификатор ключа (путь к файлу, команда и т.д.) и данные.
+ * Числа кодируются varint'ами, ключ записывается целиком только при первом
+ * появлении. Запись из разных потоков допустима
+ */
+class CaptureWriter
+{
+  public:
+    /**
+     * @brief Открывает файл записи
+     *
+     * @param path Путь к файлу. Существующий файл перезаписывается
+     */
+    explicit CaptureWriter(const std::string &path);
+
+    /**
+     * @brief Удалось ли открыть файл записи
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Добавляет запись в файл
+     *
+     * @param kind Тип данных
+     * @param key Ключ, по которому данные будут искаться при воспроизведении
+     * @param data Сырые данные
+     * @param size Размер данных, в байтах
+     */
+    void write(CaptureKind kind, const std::string &key, const void *data,
+               std::size_t size);
+
+  private:
+    std::mutex _mutex;
+    std::ofstream _out;
+    std::chrono::steady_clock::time_point _last;
+    std::unordered_map<std::string, uint64_t> _keys;
+
+    void _writeVarint(uint64_t value);
+};
+
+/**
+ * @brief Воспроизведение данных, записанных CaptureWriter
+ *
+ * @details Файл читается целиком при создании объекта. Для каждой пары
+ * (тип, ключ) записи выдаются в том порядке, в котором были сделаны. Если
+ * скорость воспроизведения положительна, выдача записи задерживается до
+ * момента, соответствующего времени записи, деленному на скорость. Чтение из
+ * разных потоков допустимо
+ */
+class CaptureReader
+{
+  public:
+    /**
+     * @brief Загружает файл записи
+     *
+     * @param path Путь к файлу
+     * @param speed Скорость воспроизведения: 1 - исходная, 10 - в десять раз
+     * быстрее, 0 - без задержек
+     */
+    CaptureReader(const std::string &path, double speed);
+
+    /**
+     * @brief Удалось ли загрузить файл записи
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Выдает следующую запись с данным типом и ключом
+     *
+     * @param kind Тип данных
+     * @param key Ключ записи
+     * @param out Куда записать данные
+     *
+     * @return false, если записи закончились
+     */
+    bool next(CaptureKind kind, const std::string &key, std::string &out);
+
+  private:
+    struct Entry
+    {
+        uint64_t timestamp; ///< Наносекунды от начала записи
+        std::string data;
+    };
+
+    std::mutex _mutex;
+    bool _loaded{false};
+    double _speed;
+    std::chrono::steady_clock::time_point _start;
+    std::map<std::pair<CaptureKind, std::string>, std::deque<Entry>> _entries;
+};
+} // namespace info
+
+#endif
@@ -0,0 +1,175 @@
+#ifndef __PROBE_SOURCE
+#define __PROBE_SOURCE
+#include <ProbeCapture.hpp>
+#include <ProbeUtilities.hpp>
+#include <chrono>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+ * Источник сырых данных для Linux-реализации. Через него проходят все чтения
+ * системных файлов и запуски внешних утилит, поэтому именно здесь
+ * применяются sysroot, запись и воспроизведение. Все методы потокобезопасны
+ * */
+
+namespace info
+{
+class ProbeSource
+{
+  public:
+    explicit ProbeSource(const ProbeOptions &options);
+
+    /**
+     * @brief Путь к системному файлу с учетом sysroot
+     */
+    std::string path(const std::string &path) const;
+
+    /**
+     * @brief Читает системный файл целиком
+     *
+     * @param path Абсолютный путь в целевой системе (без sysroot)
+     * @param out Буфер, в который записывается содержимое. Память буфера
+     * переиспользуется между вызовами
+     *
+     * @return false, если файл не удалось прочитать
+     */
+    bool readFile(const std::string &path, std::string &out);
+
+    /**
+     * @brief Возвращает отсортированный список имен в директории
+     *
+     * @details "." и ".." не включаются. Если директорию не удалось
+     * открыть, возвращается пустой список
+     *
+     * @param path Абсолютный путь в целевой системе (без sysroot)
+     */
+    std::vector<std::string> listDirectory(const std::string &path);
+
+    /**
+     * @brief То же, что listDirectory, но возвращает только поддиректории
+     *
+     * @details Тип берется из readdir, поэтому для каждой записи не нужен
+     * отдельный stat
+     */
+    std::vector<std::string> listSubdirectories(const std::string &path);
+
+    /**
+     * @brief Текущее значение монотонных часов
+     *
+     * @details При воспроизведении возвращается записанное значение, поэтому
+     * интервалы между замерами не зависят от скорости воспроизведения
+     */
+    std::chrono::nanoseconds monotonic();
+
+    /**
+     * @brief Запускает внешнюю утилиту и возвращает ее стандартный вывод
+     *
+     * @details Вывод читается через pipe, временные файлы не создаются,
+     * поэтому одновременные вызовы из разных потоков не мешают друг другу
+     *
+     * @param command Команда для оболочки
+     */
+    std::string runCommand(const std::string &command);
+
+    /**
+     * @brief Запускает внешнюю утилиту и передает ее вывод потоком
+     *
+     * @details consume читает вывод по мере поступления из pipe, поэтому
+     * вывод не накапливается в памяти целиком (кроме режима записи). Если
+     * consume прочитал не все, остаток вычитывается и отбрасывается
+     *
+     * @param command Команда для оболочки
+     * @param consume Читатель вывода
+     */
+    void runCommand(const std::string &command,
+                    const std::function<void(std::istream &)> &consume);
+
+    /**
+     * @brief Сохраняет сырые данные, полученные в обход readFile (ответы
+     * netlink, структуры системных вызовов)
+     */
+    void record(CaptureKind kind, const std::string &key, const void *data,
+                std::size_t size);
+
+    /**
+     * @brief Выдает записанные ранее сырые данные
+     *
+     * @return false, если воспроизведение выключено или записи закончились
+     */
+    bool replay(CaptureKind kind, const std::string &key, std::string &out);
+
+    /**
+     * @brief Включено ли воспроизведение записанных данных
+     */
+    bool replaying() const { return _replayer != nullptr; }
+
+  private:
+    std::string _sysroot;
+
+    std::vector<std::string> _list(CaptureKind kind, const std::string &path);
+    std::unique_ptr<CaptureWriter> _recorder;
+    std::unique_ptr<CaptureReader> _replayer;
+};
+
+/**
+ * @brief Системный файл, который держится открытым между чтениями
+ *
+ * @details Подходит для атрибутов sysfs, которые опрашиваются
+ * периодически: каждое чтение - один pread с нулевого смещения вместо
+ * open, read и close. Файл открывается при первом чтении. Запись и
+ * воспроизведение работают так же, как в ProbeSource::readFile.
+ *
+ * Незакрепленный файл (pin = false) открывается и закрывается при каждом
+ * чтении: так читаются файлы, которых слишком много, чтобы держать открытыми
+ * все сразу, например stat каждого потока процесса
+ */
+class PinnedFile
+{
+  public:
+    /**
+     * @param source Источник данных, должен жить дольше объекта
+     * @param path Абсолютный путь в целевой системе (без sysroot)
+     * @param pin Держать файл открытым между чтениями
+     */
+    PinnedFile(ProbeSource &source, std::string path, bool pin = true);
+    ~PinnedFile();
+
+    PinnedFile(PinnedFile &&other) noexcept;
+    PinnedFile &operator=(PinnedFile &&other) noexcept;
+    PinnedFile(const PinnedFile &) = delete;
+    PinnedFile &operator=(const PinnedFile &) = delete;
+
+    /**
+     * @brief Перечитывает файл с начала
+     *
+     * @return false, если файл не удалось открыть или прочитать
+     */
+    bool read(std::string &out);
+
+    /**
+     * @return errno последнего неудачного чтения, 0 после удачного
+     */
+    int error() const { return _error; }
+
+    bool pinned() const { return _pin; }
+
+    /**
+     * @brief Закрывает файл, следующие чтения открывают его каждый раз
+     */
+    void unpin();
+
+    const std::string &path() const { return _path; }
+
+  private:
+    ProbeSource *_source;
+    std::string _path;
+    int _fd{-1};
+    int _error{0};
+    bool _pin;
+};
+} // namespace info
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef __PROBE_TELEMETRY
+#define __PROBE_TELEMETRY
+#include <ProbeUtilities.hpp>
+#include <array>
+#include <atomic>
+#include <chrono>
+
+/*
+ * Сбор статистики о работе самой библиотеки. Счетчики обновляются relaxed
+ * атомарными операциями, поэтому запись из разных потоков не требует
+ * блокировок. Реализации платформ сообщают о прочитанных байтах, системных
+ * вызовах и т.д. через статические методы, которые относят событие к методу
+ * ProbeUtilities, выполняющемуся в текущем потоке
+ * */
+
+namespace info
+{
+class ProbeTelemetry
+{
+  public:
+    /**
+     * @brief Атомарные счетчики одного метода
+     */
+    struct Counters
+    {
+        std::atomic<uint64_t> calls{0};
+        std::atomic<uint64_t> bytesRead{0};
+        std::atomic<uint64_t> syscalls{0};
+        std::atomic<uint64_t> subprocesses{0};
+        std::atomic<uint64_t> cacheHits{0};
+        std::atomic<uint64_t> cacheMisses{0};
+        std::atomic<uint64_t> cacheCoalesced{0};
+        std::array<std::atomic<uint64_t>, ProbeStats::LATENCY_BUCKETS>
+            latency{};
+    };
+
+    /**
+     * @brief Замер одного вызова метода ProbeUtilities
+     *
+     * @details На время жизни объекта все события текущего потока относятся к
+     * методу probe. При уничтожении записывается длительность вызова
+     */
+    class Scope
+    {
+      public:
+        Scope(ProbeTelemetry &telemetry, ProbeKind probe);
+        ~Scope();
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+      private:
+        Counters &_counters;
+        Counters *_previous;
+        std::chrono::steady_clock::time_point _start;
+    };
+
+    /**
+     * @brief Перенос замера в рабочий поток метода
+     *
+     * @details На время жизни объекта события текущего потока относятся к
+     * счетчикам, полученным через current() в потоке, выполняющем метод.
+     * Вызов и его длительность записывает только Scope
+     */
+    class Attach
+    {
+      public:
+        explicit Attach(Counters *counters);
+        ~Attach();
+
+        Attach(const Attach &) = delete;
+        Attach &operator=(const Attach &) = delete;
+
+      private:
+        Counters *_previous;
+    };
+
+    /**
+     * @return Счетчики метода, выполняющегося в текущем потоке, или nullptr
+     */
+    static Counters *current();
+
+    /**
+     * @brief Снимок всех счетчиков
+     */
+    SelfStats snapshot() const;
+
+    static void addBytes(uint64_t bytes);
+    static void addSyscalls(uint64_t count);
+    static void addSubprocess();
+    static void cacheHit();
+    static void cacheMiss();
+    static void cacheCoalesced();
+
+  private:
+    std::array<Counters, static_cast<std::size_t>(ProbeKind::Count)> _counters;
+};
+} // namespace info
+
+#endif
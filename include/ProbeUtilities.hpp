@@ -3,14 +3,63 @@
 
 #include <array>
 #include <chrono>
+#include <climits>
 #include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 namespace info
 {
+/**
+ * @brief Признак перечисления-маски полей, для которого определены
+ * операции | и &
+ */
+template <typename E> struct IsFieldMask : std::false_type
+{
+};
+
+template <typename E, typename = std::enable_if_t<IsFieldMask<E>::value>>
+constexpr E operator|(E a, E b)
+{
+    using U = std::underlying_type_t<E>;
+    return static_cast<E>(static_cast<U>(a) | static_cast<U>(b));
+}
+
+template <typename E, typename = std::enable_if_t<IsFieldMask<E>::value>>
+constexpr E operator&(E a, E b)
+{
+    using U = std::underlying_type_t<E>;
+    return static_cast<E>(static_cast<U>(a) & static_cast<U>(b));
+}
+
+/**
+ * @brief Проверка, что в маске установлены все биты field
+ */
+template <typename E, typename = std::enable_if_t<IsFieldMask<E>::value>>
+constexpr bool hasFields(E mask, E field)
+{
+    return (mask & field) == field;
+}
+
+/**
+ * @brief Поля OSInfo, которые нужно заполнить в getOSInfo()
+ */
+enum class OSField : uint16_t
+{
+    Name = 1 << 0,     ///< OSInfo::name
+    Hostname = 1 << 1, ///< OSInfo::hostname
+    Kernel = 1 << 2,   ///< OSInfo::kernel
+    Arch = 1 << 3,     ///< OSInfo::arch
+    All = (1 << 4) - 1
+};
+
+template <> struct IsFieldMask<OSField> : std::true_type
+{
+};
+
 /**
  * @brief Структура, описывающая операционную систему
  */
@@ -20,6 +69,10 @@ struct OSInfo
     std::string hostname; ///< Название машины-хоста
     std::string kernel;   ///< Название ядра операционной системы
     uint16_t arch;        ///< Разрядность операционной системы
+
+    OSField fields{}; ///< Заполненные поля, остальные не определены
+
+    bool has(OSField field) const { return hasFields(fields, field); }
 };
 
 /**
@@ -52,6 +105,51 @@ struct DiscPartitionInfo
     uint64_t freeSpace; ///< Емкость раздела, в байтах
 };
 
+/**
+ * @brief Результат опроса точки монтирования
+ */
+enum class MountStatus : uint8_t
+{
+    Ok,      ///< Размеры получены
+    Failed,  ///< statvfs вернул ошибку (нет доступа, точка недоступна)
+    TimedOut ///< statvfs не завершился за ProbeOptions::mountTimeout
+};
+
+/**
+ * @brief Структура, описывающая смонтированную файловую систему
+ */
+struct MountInfo
+{
+    std::string mountPoint; ///< Точка монтирования
+    std::string source;     ///< Устройство или "server:/export"
+    std::string filesystem; ///< Тип файловой системы: "ext4", "nfs4"
+    bool readOnly;          ///< Смонтирована только для чтения
+
+    MountStatus status; ///< Удалось ли получить размеры
+
+    uint64_t capacity;   ///< Емкость, в байтах
+    uint64_t freeSpace;  ///< Свободное место, в байтах
+    uint64_t available;  ///< Место, доступное непривилегированным пользователям
+    uint64_t inodes;     ///< Всего индексных дескрипторов
+    uint64_t freeInodes; ///< Свободных индексных дескрипторов
+};
+
+/**
+ * @brief Отбор файловых систем по типу для getMountInfo()
+ */
+struct MountFilter
+{
+    /**
+     * @brief Возвращать только эти типы. Пустой список - все типы
+     */
+    std::vector<std::string> fstypes;
+
+    /**
+     * @brief Не возвращать эти типы (например, "proc", "sysfs", "cgroup2")
+     */
+    std::vector<std::string> excludeFstypes;
+};
+
 /**
  * @brief Структура, содержащая информацию о периферийных устройствах
  */
@@ -120,6 +218,138 @@ struct NetworkInterfaceInfo
     uint8_t ipv6_mask;
 };
 
+/**
+ * @brief Состояние TCP-сокета. Значения совпадают с номерами состояний в ядре
+ */
+enum class TCPState : uint8_t
+{
+    Established = 1,
+    SynSent,
+    SynRecv,
+    FinWait1,
+    FinWait2,
+    TimeWait,
+    Close,
+    CloseWait,
+    LastAck,
+    Listen,
+    Closing,
+    NewSynRecv,
+    Count ///< Количество состояний, не является состоянием
+};
+
+/**
+ * @brief Количество сокетов на одном локальном порту
+ */
+struct SocketPortStats
+{
+    uint16_t port; ///< Номер порта
+    uint32_t tcp;  ///< TCP-сокетов (IPv4 и IPv6)
+    uint32_t udp;  ///< UDP-сокетов (IPv4 и IPv6)
+};
+
+/**
+ * @brief Количество соединений с одной удаленной подсетью
+ */
+struct SocketSubnetStats
+{
+    /**
+     * @brief Адрес подсети в двоичном виде. Для IPv4 заняты первые 4 байта
+     */
+    std::array<uint8_t, 16> address;
+    bool ipv6;            ///< Подсеть IPv6
+    uint8_t prefixLength; ///< Длина префикса: 24 для IPv4, 64 для IPv6
+    uint64_t sockets;     ///< Количество сокетов
+};
+
+/**
+ * @brief Сводная статистика сокетов системы
+ */
+struct SocketInfo
+{
+    static constexpr std::size_t TCP_STATES =
+        static_cast<std::size_t>(TCPState::Count);
+
+    /**
+     * @brief Количество TCP-сокетов в каждом состоянии, индексируется
+     * TCPState. Элемент 0 не используется
+     */
+    std::array<uint64_t, TCP_STATES> tcpStates{};
+
+    uint64_t tcp4{0};          ///< TCP-сокетов IPv4
+    uint64_t tcp6{0};          ///< TCP-сокетов IPv6
+    uint64_t udp4{0};          ///< UDP-сокетов IPv4
+    uint64_t udp6{0};          ///< UDP-сокетов IPv6
+    uint64_t unixStream{0};    ///< Unix-сокетов SOCK_STREAM
+    uint64_t unixDgram{0};     ///< Unix-сокетов SOCK_DGRAM
+    uint64_t unixSeqpacket{0}; ///< Unix-сокетов SOCK_SEQPACKET
+
+    uint64_t receiveQueue{0}; ///< Непрочитанных байт во всех сокетах
+    uint64_t sendQueue{0};    ///< Неотправленных байт во всех сокетах
+
+    /**
+     * @brief Соединений, ожидающих accept() на слушающих TCP-сокетах
+     */
+    uint64_t acceptQueue{0};
+
+    /**
+     * @brief Слушающих TCP-сокетов с переполненной очередью accept()
+     *
+     * @details Очередь переполнена, когда ее длина больше backlog: ядро в
+     * этом состоянии отбрасывает новые соединения
+     */
+    uint64_t fullAcceptQueues{0};
+
+    uint64_t retransmitting{0};   ///< TCP-сокетов с неподтвержденным повтором
+    uint64_t totalRetransmits{0}; ///< Повторных передач за жизнь сокетов
+
+    /**
+     * @brief Сокеты TCP и UDP по локальным портам, по возрастанию порта
+     */
+    std::vector<SocketPortStats> localPorts;
+
+    /**
+     * @brief Подключенные сокеты TCP и UDP по удаленным подсетям (/24 для
+     * IPv4, /64 для IPv6), по убыванию количества сокетов
+     */
+    std::vector<SocketSubnetStats> remoteSubnets;
+
+    uint64_t operator[](TCPState state) const
+    {
+        return tcpStates[static_cast<std::size_t>(state)];
+    }
+};
+
+/**
+ * @brief Поля CPUInfo, которые нужно заполнить в getCPUInfo()
+ */
+enum class CPUField : uint16_t
+{
+    Name = 1 << 0,  ///< CPUInfo::name
+    Arch = 1 << 1,  ///< CPUInfo::arch
+    Cores = 1 << 2, ///< CPUInfo::cores
+
+    /**
+     * @brief CPUInfo::load. Считается за интервал, первый запрос ждет
+     * ProbeOptions::warmupDelay
+     */
+    Load = 1 << 3,
+
+    /**
+     * @brief CPUInfo::l1_cache, l2_cache и l3_cache. На Linux запускает lscpu
+     */
+    Cache = 1 << 4,
+
+    OverallCache = 1 << 5, ///< CPUInfo::overall_cache
+    PhysId = 1 << 6,       ///< CPUInfo::physid
+    ClockFreq = 1 << 7,    ///< CPUInfo::clockFreq
+    All = (1 << 8) - 1
+};
+
+template <> struct IsFieldMask<CPUField> : std::true_type
+{
+};
+
 /**
  * @brief Структура, описывающая процессор компьютерной системы
  */
@@ -135,6 +365,201 @@ struct CPUInfo
         overall_cache;       ///< Общая емкость кэша, в байтах
     uint64_t physid; ///< Physical ID процессора
     float clockFreq; ///< Текущая рабочая частота процессора, в мегагерцах
+
+    CPUField fields{}; ///< Заполненные поля, остальные не определены
+
+    bool has(CPUField field) const { return hasFields(fields, field); }
+};
+
+/**
+ * @brief Состояния процессора в том порядке, в котором они идут в /proc/stat
+ */
+enum class CPUState : uint8_t
+{
+    User,      ///< Пользовательский код
+    Nice,      ///< Пользовательский код с пониженным приоритетом
+    System,    ///< Код ядра
+    Idle,      ///< Простой
+    IOWait,    ///< Простой в ожидании ввода-вывода
+    IRQ,       ///< Обработка аппаратных прерываний
+    SoftIRQ,   ///< Обработка программных прерываний
+    Steal,     ///< Время, отнятое гипервизором у виртуальной машины
+    Guest,     ///< Выполнение гостевой ОС (входит в User)
+    GuestNice, ///< Выполнение гостевой ОС с пониженным приоритетом (входит в Nice)
+    Count      ///< Количество состояний, не является состоянием
+};
+
+/**
+ * @brief Распределение времени процессора по состояниям за интервал
+ */
+struct CPUTimes
+{
+    static constexpr std::size_t STATES =
+        static_cast<std::size_t>(CPUState::Count);
+
+    /**
+     * @brief Номер логического процессора (N из строки cpuN). Для суммы по
+     * всем процессорам не используется
+     */
+    uint32_t cpu{0};
+
+    /**
+     * @brief Приращение времени в каждом состоянии, в тактах таймера ядра
+     * (USER_HZ)
+     */
+    std::array<uint64_t, STATES> ticks{};
+
+    /**
+     * @brief Доля каждого состояния, в процентах
+     *
+     * @details Доли считаются от суммы всех состояний, кроме Guest и
+     * GuestNice: ядро уже учитывает их в User и Nice
+     */
+    std::array<float, STATES> percent{};
+
+    uint64_t operator[](CPUState state) const
+    {
+        return ticks[static_cast<std::size_t>(state)];
+    }
+
+    float percentOf(CPUState state) const
+    {
+        return percent[static_cast<std::size_t>(state)];
+    }
+};
+
+/**
+ * @brief Распределение времени всех процессоров по состояниям
+ */
+struct CPUTimesInfo
+{
+    /**
+     * @brief Длительность интервала, за который посчитаны приращения
+     */
+    std::chrono::duration<float> interval{0};
+
+    CPUTimes total; ///< Сумма по всем процессорам
+
+    /**
+     * @brief Логические процессоры, работавшие в обоих замерах, по
+     * возрастанию номера. Отключенный или подключенный между замерами
+     * процессор пропускается
+     */
+    std::vector<CPUTimes> cores;
+};
+
+/**
+ * @brief Показатели планировщика одного логического процессора
+ */
+struct SchedCoreInfo
+{
+    uint32_t cpu; ///< Номер логического процессора
+
+    /**
+     * @brief Доля интервала, в течение которой процессор выполнял задачи
+     */
+    double busy;
+
+    /**
+     * @brief Суммарное время ожидания задач в очереди, в секундах за секунду
+     *
+     * @details Равно среднему количеству задач, которые готовы выполняться,
+     * но ждут процессор. Значение больше нуля при высокой загрузке говорит
+     * о насыщении процессора, а не просто о его полной занятости
+     */
+    double runDelay;
+
+    double timeslices; ///< Выданных квантов времени в секунду
+
+    /**
+     * @brief Среднее ожидание в очереди перед получением кванта, в секундах
+     */
+    double waitPerTimeslice;
+};
+
+/**
+ * @brief Структура, описывающая состояние планировщика задач
+ */
+struct SchedulerInfo
+{
+    /**
+     * @brief Средняя длина очереди выполнения за 1, 5 и 15 минут
+     */
+    std::array<float, 3> loadAverage{};
+
+    uint32_t runnable{0};        ///< Задач в очереди выполнения (loadavg)
+    uint32_t threads{0};         ///< Всего задач в системе (loadavg)
+    uint32_t procsRunning{0};    ///< Выполняемых задач (procs_running)
+    uint32_t procsBlocked{0};    ///< Задач, ожидающих ввода-вывода
+    double contextSwitches{0};   ///< Переключений контекста в секунду
+    double forks{0};             ///< Созданных задач в секунду
+
+    /**
+     * @brief Длительность интервала, за который посчитаны частоты
+     */
+    std::chrono::duration<float> interval{0};
+
+    /**
+     * @brief Показатели каждого процессора
+     *
+     * @details Заполняется, только если ядро собрано с CONFIG_SCHEDSTATS
+     */
+    std::vector<SchedCoreInfo> cores;
+};
+
+/**
+ * @brief Счетчики прерываний по строкам и процессорам
+ *
+ * @details Значения хранятся плотной матрицей по строкам: элемент
+ * (row, col) находится в counts[row * cpus.size() + col]
+ */
+struct InterruptMatrix
+{
+    std::vector<std::string> labels; ///< Метка строки: "24", "NMI", "NET_RX"
+
+    /**
+     * @brief Описание строки: контроллер, тип и устройство ("IR-PCI-MSI
+     * 524288-edge eth0-TxRx-0"). Для программных прерываний пусто
+     */
+    std::vector<std::string> descriptions;
+
+    std::vector<uint32_t> cpus;   ///< Номера процессоров в столбцах
+    std::vector<uint64_t> counts; ///< Приращения счетчиков за интервал
+
+    std::size_t rows() const { return labels.size(); }
+
+    uint64_t at(std::size_t row, std::size_t col) const
+    {
+        return counts[row * cpus.size() + col];
+    }
+};
+
+/**
+ * @brief Распределение прерываний по процессорам
+ */
+struct InterruptInfo
+{
+    /**
+     * @brief Длительность интервала, за который посчитаны приращения
+     */
+    std::chrono::duration<float> interval{0};
+
+    InterruptMatrix interrupts; ///< Аппаратные прерывания (/proc/interrupts)
+    InterruptMatrix softirqs;   ///< Программные прерывания (/proc/softirqs)
+};
+
+/**
+ * @brief Поля MemoryInfo, которые нужно заполнить в getMemoryInfo()
+ */
+enum class MemoryField : uint16_t
+{
+    Capacity = 1 << 0,  ///< MemoryInfo::capacity
+    FreeSpace = 1 << 1, ///< MemoryInfo::freeSpace
+    All = (1 << 2) - 1
+};
+
+template <> struct IsFieldMask<MemoryField> : std::true_type
+{
 };
 
 /**
@@ -144,35 +569,518 @@ struct MemoryInfo
 {
     uint64_t capacity;  ///< Общая емкость ОЗУ, в байтах
     uint64_t freeSpace; ///< Доступное пространство ОЗУ, в байтах
+
+    MemoryField fields{}; ///< Заполненные поля, остальные не определены
+
+    bool has(MemoryField field) const { return hasFields(fields, field); }
+};
+
+/**
+ * @brief Счетчики /proc/vmstat, связанные с нехваткой памяти
+ */
+enum class VMCounter : uint8_t
+{
+    PgFault,          ///< Страничные прерывания (pgfault)
+    PgMajFault,       ///< Страничные прерывания с чтением с диска
+    PswpIn,           ///< Страниц прочитано из подкачки
+    PswpOut,          ///< Страниц записано в подкачку
+    PgscanKswapd,     ///< Страниц просмотрено фоновым освобождением (kswapd)
+    PgscanDirect,     ///< Страниц просмотрено прямым освобождением
+    PgstealKswapd,    ///< Страниц освобождено kswapd
+    PgstealDirect,    ///< Страниц освобождено прямым освобождением
+    AllocStall,       ///< Выделений, ушедших в прямое освобождение
+    CompactStall,     ///< Выделений, ожидавших уплотнения памяти
+    CompactFail,      ///< Неудачных уплотнений
+    CompactSuccess,   ///< Удачных уплотнений
+    ThpFaultAlloc,    ///< Огромных страниц выделено при прерывании
+    ThpFaultFallback, ///< Прерываний, не получивших огромную страницу
+    ThpCollapseAlloc, ///< Огромных страниц собрано khugepaged
+    ThpSplitPage,     ///< Огромных страниц разбито
+    OomKill,          ///< Процессов завершено OOM killer
+    Count ///< Количество счетчиков, не является счетчиком
+};
+
+/**
+ * @brief Свободная память одной зоны одного узла NUMA
+ */
+struct BuddyZoneInfo
+{
+    /**
+     * @brief Количество порядков блоков в /proc/buddyinfo
+     */
+    static constexpr std::size_t ORDERS = 11;
+
+    uint32_t node;    ///< Номер узла NUMA
+    std::string zone; ///< Имя зоны: "DMA", "DMA32", "Normal"
+
+    /**
+     * @brief Свободных блоков из 2^i страниц для каждого порядка i
+     */
+    std::array<uint64_t, ORDERS> freeBlocks{};
+
+    uint64_t freePages{0}; ///< Свободных страниц (/proc/zoneinfo)
+    uint64_t min{0};  ///< Порог, ниже которого выделения ждут освобождения
+    uint64_t low{0};  ///< Порог, ниже которого просыпается kswapd
+    uint64_t high{0}; ///< Порог, до которого kswapd освобождает память
+};
+
+/**
+ * @brief Пул огромных страниц одного размера на одном узле NUMA
+ */
+struct HugePagePoolInfo
+{
+    uint32_t node;     ///< Номер узла NUMA
+    uint64_t pageSize; ///< Размер страницы, в байтах
+    uint64_t total;    ///< Страниц в пуле (nr_hugepages)
+    uint64_t free;     ///< Свободных страниц
+    uint64_t surplus;  ///< Страниц сверх пула (overcommit)
+};
+
+/**
+ * @brief Отбор контрольных групп для getCgroupInfo()
+ */
+struct CgroupFilter
+{
+    /**
+     * @brief Возвращать только группу с этим путем и вложенные в нее,
+     * например "/system.slice". Пустая строка - все группы
+     */
+    std::string prefix;
+
+    /**
+     * @brief Максимальная глубина группы, у корня иерархии глубина 0
+     */
+    uint32_t maxDepth{UINT32_MAX};
+};
+
+/**
+ * @brief Потребление ресурсов одной контрольной группой (cgroup v2)
+ *
+ * @details Частоты считаются за интервал с предыдущего обхода. Для групп,
+ * которых при предыдущем обходе не было, интервал нулевой и частоты не
+ * посчитаны. Если у группы нет файла контроллера (например, memory.current
+ * у корня), соответствующие поля нулевые
+ */
+struct CgroupInfo
+{
+    std::string path; ///< Путь от корня иерархии: "/system.slice/nginx.service"
+    uint32_t depth;   ///< Глубина, у корня 0
+
+    /**
+     * @brief Длительность интервала, за который посчитаны частоты
+     */
+    std::chrono::duration<float> interval{0};
+
+    double cpuUsage{0};  ///< Процессорное время, в ядрах (секунд в секунду)
+    double cpuUser{0};   ///< Из них в пользовательском коде
+    double cpuSystem{0}; ///< Из них в коде ядра
+
+    /**
+     * @brief Время, в течение которого группа была ограничена квотой
+     * cpu.max, в секундах за секунду
+     */
+    double throttled{0};
+
+    uint64_t memoryCurrent{0}; ///< Занятая память (memory.current), в байтах
+    uint64_t pids{0};          ///< Задач в группе (pids.current)
+
+    double readBytes{0};  ///< Прочитано с блочных устройств, байт в секунду
+    double writeBytes{0}; ///< Записано на блочные устройства, байт в секунду
+    double readOps{0};    ///< Операций чтения в секунду
+    double writeOps{0};   ///< Операций записи в секунду
+};
+
+/**
+ * @brief Состояние подсистемы управления памятью ядра
+ */
+struct VMInfo
+{
+    static constexpr std::size_t COUNTERS =
+        static_cast<std::size_t>(VMCounter::Count);
+
+    /**
+     * @brief Длительность интервала, за который посчитаны частоты
+     */
+    std::chrono::duration<float> interval{0};
+
+    std::array<uint64_t, COUNTERS> totals{}; ///< Значения счетчиков
+    std::array<double, COUNTERS> rates{};    ///< Событий в секунду
+
+    std::vector<BuddyZoneInfo> zones;        ///< Зоны всех узлов
+    std::vector<HugePagePoolInfo> hugepages; ///< Пулы огромных страниц
+
+    uint64_t total(VMCounter counter) const
+    {
+        return totals[static_cast<std::size_t>(counter)];
+    }
+
+    double rate(VMCounter counter) const
+    {
+        return rates[static_cast<std::size_t>(counter)];
+    }
+};
+
+/**
+ * @brief Аппаратные счетчики производительности одного логического
+ * процессора за интервал между замерами
+ *
+ * @details Все частоты - в событиях в секунду, уже пересчитанные с учетом
+ * мультиплексирования счетчиков ядром
+ */
+struct PerfCoreCounters
+{
+    uint32_t cpu; ///< Номер логического процессора
+
+    double cycles;       ///< Такты процессора в секунду
+    double instructions; ///< Выполненные инструкции в секунду
+    double cacheMisses;  ///< Промахи кэша последнего уровня в секунду
+    double branchMisses; ///< Неверно предсказанные переходы в секунду
+    double ipc;          ///< Инструкций за такт
+    double cacheMissesPerKI;  ///< Промахов кэша на тысячу инструкций
+    double branchMissesPerKI; ///< Промахов предсказания на тысячу инструкций
+
+    double contextSwitches; ///< Переключения контекста в секунду
+    double pageFaults;      ///< Страничные прерывания в секунду
+};
+
+/**
+ * @brief Структура, содержащая показания счетчиков производительности
+ */
+struct PerfCounterInfo
+{
+    /**
+     * @brief Доступны ли аппаратные счетчики
+     *
+     * @details Если доступ к PMU запрещен (perf_event_paranoid, виртуальная
+     * машина без vPMU), заполняются только программные события:
+     * contextSwitches и pageFaults. Остальные поля равны нулю
+     */
+    bool hardware{false};
+
+    /**
+     * @brief Длительность интервала, за который посчитаны частоты
+     */
+    std::chrono::duration<float> interval{0};
+
+    std::vector<PerfCoreCounters> cores; ///< Счетчики каждого процессора
+};
+
+/**
+ * @brief Температурная зона из /sys/class/thermal
+ */
+struct ThermalZoneInfo
+{
+    std::string name;  ///< Имя зоны: "thermal_zone0"
+    std::string type;  ///< Тип зоны: "x86_pkg_temp", "acpitz"
+    float temperature; ///< Температура, в градусах Цельсия
 };
 
+/**
+ * @brief Датчик hwmon: температура или скорость вентилятора
+ */
+struct HwmonSensorInfo
+{
+    std::string chip;  ///< Имя микросхемы датчиков: "coretemp", "nct6775"
+    std::string label; ///< Метка датчика ("Core 0") или имя файла ("temp1")
+    float value;       ///< Градусы Цельсия или обороты в минуту
+};
+
+/**
+ * @brief Домен учета энергии RAPL из /sys/class/powercap
+ */
+struct PowerZoneInfo
+{
+    std::string name; ///< Имя домена: "package-0", "core", "dram"
+    std::string path; ///< Директория домена: "intel-rapl:0:1"
+
+    /**
+     * @brief Средняя мощность за интервал, в ваттах
+     *
+     * @details Счетчик энергии периодически переполняется, переполнение
+     * учитывается по max_energy_range_uj
+     */
+    double power;
+};
+
+/**
+ * @brief Структура, содержащая показания датчиков температуры и мощности
+ */
+struct ThermalInfo
+{
+    /**
+     * @brief Длительность интервала, за который посчитана мощность
+     */
+    std::chrono::duration<float> interval{0};
+
+    std::vector<ThermalZoneInfo> zones;        ///< Температурные зоны
+    std::vector<HwmonSensorInfo> temperatures; ///< Датчики температуры hwmon
+    std::vector<HwmonSensorInfo> fans;         ///< Вентиляторы hwmon
+    std::vector<PowerZoneInfo> power;          ///< Домены RAPL
+};
+
+/**
+ * @brief Методы ProbeUtilities, для которых собирается статистика
+ */
+enum class ProbeKind : uint8_t
+{
+    OSInfo,
+    UserInfo,
+    DiscPartitionInfo,
+    PeripheryInfo,
+    NetworkInterfaceInfo,
+    MemoryInfo,
+    CPUInfo,
+    PerfCounterInfo,
+    CPUTimes,
+    SchedulerInfo,
+    InterruptInfo,
+    ThermalInfo,
+    MountInfo,
+    SocketInfo,
+    VMInfo,
+    CgroupInfo,
+    Count ///< Количество методов, не является методом
+};
+
+/**
+ * @brief Статистика работы одного метода ProbeUtilities
+ */
+struct ProbeStats
+{
+    /**
+     * @brief Количество интервалов гистограммы задержек
+     *
+     * @details Интервалы логарифмические: каждая степень двойки наносекунд
+     * делится на 8 равных частей, что дает относительную погрешность не хуже
+     * 12.5%. Длительности больше 2^40 нс попадают в последний интервал
+     */
+    static constexpr std::size_t LATENCY_BUCKETS = 304;
+
+    const char *name;      ///< Название метода
+    uint64_t calls;        ///< Количество вызовов
+    uint64_t bytesRead;    ///< Прочитано байт из системных файлов и утилит
+    uint64_t syscalls;     ///< Выполнено системных вызовов
+    uint64_t subprocesses; ///< Запущено внешних утилит
+    uint64_t cacheHits;    ///< Ответов из кэша
+    uint64_t cacheMisses;  ///< Обновлений кэша
+
+    /**
+     * @brief Вызовов, дождавшихся обновления кэша, начатого другим потоком.
+     * Не входят ни в cacheHits, ни в cacheMisses
+     */
+    uint64_t cacheCoalesced;
+
+    /**
+     * @brief Гистограмма длительностей вызовов
+     */
+    std::array<uint64_t, LATENCY_BUCKETS> latency;
+
+    /**
+     * @brief Номер интервала гистограммы для длительности
+     */
+    static std::size_t bucketOf(std::chrono::nanoseconds duration);
+
+    /**
+     * @brief Нижняя граница интервала гистограммы
+     */
+    static std::chrono::nanoseconds bucketLowerBound(std::size_t bucket);
+
+    /**
+     * @brief Оценка квантиля длительности вызова
+     *
+     * @param q Квантиль от 0 до 1 (например, 0.99)
+     *
+     * @return Нижняя граница интервала, в который попадает квантиль. Если
+     * вызовов не было, возвращается 0
+     */
+    std::chrono::nanoseconds percentile(double q) const;
+};
+
+/**
+ * @brief Статистика работы библиотеки
+ */
+struct SelfStats
+{
+    /**
+     * @brief Статистика по каждому методу, индексируется ProbeKind
+     */
+    std::array<ProbeStats, static_cast<std::size_t>(ProbeKind::Count)> probes;
+
+    const ProbeStats &operator[](ProbeKind probe) const
+    {
+        return probes[static_cast<std::size_t>(probe)];
+    }
+};
+
+/**
+ * @brief Параметры, с которыми создается объект ProbeUtilities
+ */
+struct ProbeOptions
+{
+    /**
+     * @brief Корневая директория для чтения системных файлов
+     *
+     * @details Все обращения к /proc, /sys и /var/run выполняются относительно
+     * этой директории. Пустая строка соответствует корню текущей системы.
+     * Используется для запуска библиотеки на заранее подготовленном дереве
+     * файлов (например, сгенерированном утилитой fixturegen)
+     *
+     * @note Вывод внешних утилит (lsblk, lshw, ip) не может быть перенаправлен
+     * в sysroot. На Windows параметр игнорируется
+     */
+    std::string sysroot;
+
+    /**
+     * @brief Файл для записи сырых входных данных
+     *
+     * @details Если путь задан, все прочитанные системные файлы, вывод внешних
+     * утилит и ответы системных вызовов вместе с моментами их получения
+     * сохраняются в этот файл. Запись можно воспроизвести через replayPath
+     */
+    std::string recordPath;
+
+    /**
+     * @brief Файл с записью, из которого берутся входные данные
+     *
+     * @details Если путь задан, библиотека не обращается к системе, а выдает
+     * данные из записи, сделанной через recordPath. Имеет приоритет над
+     * recordPath
+     */
+    std::string replayPath;
+
+    /**
+     * @brief Скорость воспроизведения записи
+     *
+     * @details 1 соответствует исходному темпу, большие значения ускоряют
+     * воспроизведение, 0 выдает данные без задержек
+     */
+    double replaySpeed = 1.0;
+
+    /**
+     * @brief Время жизни кэшированной информации о разделах жестких дисков
+     *
+     * @details По истечении этого времени getDiscPartitionInfo() обновляет
+     * информацию. По умолчанию информация не обновляется никогда
+     */
+    std::chrono::steady_clock::duration cacheTtl =
+        std::chrono::steady_clock::duration::max();
+
+    /**
+     * @brief Наибольшее время ожидания statvfs для одной точки монтирования
+     *
+     * @details Используется в getMountInfo(). Точки, не ответившие за это
+     * время, возвращаются со статусом MountStatus::TimedOut. Весь вызов
+     * getMountInfo() длится не дольше двух mountTimeout
+     */
+    std::chrono::milliseconds mountTimeout{1000};
+
+    /**
+     * @brief Пауза между начальным и первым замером у методов, которые
+     * считают приращения (getCPUTimes(), getSchedulerInfo(),
+     * getInterruptInfo(), getThermalInfo(), getPerfCounterInfo())
+     *
+     * @details При нулевой паузе первый вызов только запоминает начальные
+     * значения и возвращает нулевые приращения. Так удобно делать при
+     * периодическом опросе: первый вызов служит точкой отсчета
+     */
+    std::chrono::milliseconds warmupDelay{1000};
+
+    /**
+     * @brief Файл для кэширования статической информации между запусками
+     *
+     * @details Если путь задан, модель и кэши процессора (getCPUInfo()) и
+     * список периферийных устройств (getPeripheryInfo()) сохраняются в этот
+     * файл и при следующих запусках берутся из него без вызова lscpu, lshw и
+     * чтения /proc/cpuinfo. Кэш действует до перезагрузки системы, а список
+     * устройств - до следующего события горячего подключения. Пустая строка
+     * отключает кэш
+     *
+     * @note Кэш не используется вместе с sysroot, recordPath и replayPath.
+     * На Windows параметр игнорируется
+     */
+    std::string bootCachePath;
+};
+
+class ProbeTelemetry;
+
+/**
+ * @brief Реализация сбора информации для текущей ОС
+ *
+ * @details Определяется в ProbeUtilsImplLinux.hpp или ProbeUtilsImplWin.hpp
+ */
+class ProbeUtilsImpl;
+
 /**
  * @brief Класс, предоставляющий интерфейс для сбора информации
  *
  * @details Данный класс предоставляет методы, возвращающие информацию о
- * состоянии компьютерной системы
+ * состоянии компьютерной системы.
+ *
+ * Методы одного объекта можно вызывать одновременно из нескольких потоков.
+ * Кэшированные значения хранятся как неизменяемые снимки и читаются без
+ * блокировок; если значение устарело, его обновляет один поток, а остальные
+ * потоки, вызвавшие тот же метод, дожидаются этого обновления
+ *
+ * Сбор информации выполняет Backend, а шаблон добавляет к каждому вызову
+ * статистику getSelfStats(). Для текущей ОС используется псевдоним
+ * ProbeUtilities, инстанцированный в библиотеке. Собственную реализацию
+ * (синтетические данные для тестов, другой источник) можно подставить,
+ * подключив BasicProbe.hpp: Backend конструируется из ProbeOptions и
+ * должен иметь одноименные методы только для тех методов BasicProbe,
+ * которые вызываются. Вызовы не виртуальные, и для такой реализации
+ * компилятор встраивает их вместе с методами Backend, определенными в
+ * заголовке.
+ *
+ * Реализация хранится в куче, чтобы размер BasicProbe не зависел от
+ * Backend: иначе этот заголовок включал бы заголовки реализации текущей
+ * ОС со всеми ее зависимостями. Поэтому методы ProbeUtilities вызываются
+ * из библиотеки как обычные функции, через одно разыменование указателя,
+ * что несущественно рядом с чтением /proc и /sys
+ *
+ * @tparam Backend Класс, выполняющий сбор информации
  */
-class ProbeUtilities
+template <typename Backend> class BasicProbe
 {
   public:
-    ProbeUtilities();
+    BasicProbe();
+
+    /**
+     * @brief Создание объекта с заданными параметрами
+     *
+     * @param options Параметры сбора информации
+     */
+    explicit BasicProbe(ProbeOptions options);
+
+    /**
+     * @brief Создание объекта с уже созданной реализацией
+     *
+     * @param backend Реализация сбора информации, не может быть пустой
+     */
+    explicit BasicProbe(std::unique_ptr<Backend> backend);
 
     // Нам нет смысла копировать/перемещать объект интерфейса
 
-    ProbeUtilities(const ProbeUtilities &) = delete;
-    ProbeUtilities(ProbeUtilities &&) = delete;
-    ProbeUtilities &operator=(const ProbeUtilities &) = delete;
-    ProbeUtilities &operator=(ProbeUtilities &&) = delete;
+    BasicProbe(const BasicProbe &) = delete;
+    BasicProbe(BasicProbe &&) = delete;
+    BasicProbe &operator=(const BasicProbe &) = delete;
+    BasicProbe &operator=(BasicProbe &&) = delete;
 
-    ~ProbeUtilities();
+    ~BasicProbe();
+
+    /**
+     * @brief Реализация, через которую выполняются вызовы
+     */
+    Backend &backend() { return *_backend; }
 
     /**
      * @brief Получение информации об операционной системе
      *
+     * @param fields Поля, которые нужно заполнить
+     *
      * @return Заполненная структура OSInfo, содержащая информацию о целевой
      * системе
      */
-    OSInfo getOSInfo();
+    OSInfo getOSInfo(OSField fields = OSField::All);
 
     /**
      * @brief Получение информации о пользователях
@@ -192,6 +1100,28 @@ class ProbeUtilities
      */
     std::vector<DiscPartitionInfo> getDiscPartitionInfo();
 
+    /**
+     * @brief Получение заполненности всех смонтированных файловых систем
+     *
+     * @details В отличие от getDiscPartitionInfo(), перечисляет все точки
+     * монтирования из /proc/self/mountinfo, включая tmpfs, overlay, NFS и
+     * FUSE. statvfs для точек выполняется параллельно, и каждый вызов
+     * ограничен по времени ProbeOptions::mountTimeout, а весь опрос - двумя
+     * mountTimeout: сколько бы точек ни было у зависшего сетевого сервера,
+     * вызывающий поток ждет не дольше этого времени, а не опрошенные к его
+     * концу точки помечаются как TimedOut. Пока statvfs для зависшей точки
+     * не завершится, она сразу помечается как TimedOut и повторно не
+     * опрашивается.
+     *
+     * @note На Windows не поддерживается
+     *
+     * @param filter Отбор по типу файловой системы
+     *
+     * @return Массив структур MountInfo в порядке монтирования. Если точка
+     * перемонтирована поверх, возвращается только верхняя файловая система
+     */
+    std::vector<MountInfo> getMountInfo(const MountFilter &filter = {});
+
     /**
      * @brief Получение информации о всех периферийных устройствах
      *
@@ -214,13 +1144,63 @@ class ProbeUtilities
      */
     std::vector<NetworkInterfaceInfo> getNetworkInterfaceInfo();
 
+    /**
+     * @brief Получение сводной статистики сокетов
+     *
+     * @details Сокеты TCP, UDP и Unix перечисляются дампами
+     * NETLINK_SOCK_DIAG (inet_diag, unix_diag). Ответы ядра агрегируются по
+     * мере получения, список сокетов в памяти не строится, поэтому
+     * потребление памяти не зависит от количества сокетов.
+     *
+     * @note Сокеты других сетевых пространств имен не учитываются, sysroot
+     * не применяется. На Windows не поддерживается
+     *
+     * @return Заполненная структура SocketInfo
+     */
+    SocketInfo getSocketInfo();
+
     /**
      * @brief Получение информации об оперативной памяти
      *
+     * @param fields Поля, которые нужно заполнить
+     *
      * @return Заполненная структура MemoryInfo, содержащая информацию об
      * оперативной памяти системы
      */
-    MemoryInfo getMemoryInfo();
+    MemoryInfo getMemoryInfo(MemoryField fields = MemoryField::All);
+
+    /**
+     * @brief Получение состояния подсистемы памяти ядра
+     *
+     * @details Частоты освобождения страниц, уплотнения, подкачки и
+     * огромных страниц из /proc/vmstat считаются за интервал с предыдущего
+     * вызова; первый вызов ждет ProbeOptions::warmupDelay. Кроме них
+     * возвращаются свободные блоки каждого порядка (/proc/buddyinfo), пороги
+     * зон (/proc/zoneinfo) и пулы огромных страниц каждого узла NUMA
+     *
+     * @note На Windows не поддерживается
+     *
+     * @return Заполненная структура VMInfo
+     */
+    VMInfo getVMInfo();
+
+    /**
+     * @brief Получение потребления ресурсов контрольными группами
+     *
+     * @details Обходит иерархию cgroup v2 (/sys/fs/cgroup или
+     * /sys/fs/cgroup/unified в смешанном режиме) в нескольких потоках:
+     * каждое поддерево обрабатывает свободный поток, забирая работу у
+     * занятых. Для каждой группы читаются cpu.stat, memory.current, io.stat
+     * и pids.current. Первый вызов ждет ProbeOptions::warmupDelay
+     *
+     * @note На Windows не поддерживается
+     *
+     * @param filter Отбор групп по пути и глубине. Поддеревья, не
+     * подходящие под отбор, не обходятся
+     *
+     * @return Группы, упорядоченные по пути
+     */
+    std::vector<CgroupInfo> getCgroupInfo(const CgroupFilter &filter = {});
 
     /**
      * @brief Получение информации о процессоре системы
@@ -229,15 +1209,135 @@ class ProbeUtilities
      * имеет один процессор. Поведение на мультипроцессорных системах не
      * определено.
      *
+     * @details Замеры, не нужные для запрошенных полей, не выполняются:
+     * например, getCPUInfo(CPUField::Name | CPUField::Cores) читает только
+     * /proc/cpuinfo, без lscpu и без ожидания для подсчета загрузки.
+     * Заполненные поля перечислены в CPUInfo::fields
+     *
+     * @param fields Поля, которые нужно заполнить
+     *
      * @return Заполненная структура CPUInfo, содержащая информацию об
      * центральном процессоре системы
      */
-    CPUInfo getCPUInfo();
+    CPUInfo getCPUInfo(CPUField fields = CPUField::All);
+
+    /**
+     * @brief Получение распределения времени процессоров по состояниям
+     *
+     * @details Для каждого логического процессора и для их суммы
+     * возвращаются приращения времени в каждом состоянии (user, nice, system,
+     * idle, iowait, irq, softirq, steal, guest, guest_nice) и их доли.
+     * Приращения считаются с предыдущего чтения /proc/stat, которое
+     * разделяется с getCPUInfo(); первый вызов ждет
+     * ProbeOptions::warmupDelay. Если с предыдущего чтения не прошло ни
+     * одного такта таймера, возвращается предыдущий результат.
+     *
+     * @note На Windows не поддерживается
+     *
+     * @return Заполненная структура CPUTimesInfo
+     */
+    CPUTimesInfo getCPUTimes();
+
+    /**
+     * @brief Получение показателей планировщика задач
+     *
+     * @details Читает /proc/loadavg, счетчики ctxt, processes,
+     * procs_running и procs_blocked из /proc/stat и время ожидания в
+     * очереди каждого процессора из /proc/schedstat. Частоты считаются за
+     * интервал с предыдущего вызова; первый вызов ждет
+     * ProbeOptions::warmupDelay. /proc/stat читается в тот же буфер, что и в
+     * getCPUTimes().
+     *
+     * @note На Windows не поддерживается
+     *
+     * @return Заполненная структура SchedulerInfo
+     */
+    SchedulerInfo getSchedulerInfo();
+
+    /**
+     * @brief Получение количества прерываний по процессорам
+     *
+     * @details Для каждой линии прерываний из /proc/interrupts и каждого
+     * типа программных прерываний из /proc/softirqs возвращает, сколько раз
+     * они обрабатывались каждым процессором с предыдущего вызова. Первый
+     * вызов ждет ProbeOptions::warmupDelay. Если набор строк или процессоров изменился,
+     * приращения новых строк равны нулю.
+     *
+     * @note На Windows не поддерживается
+     *
+     * @return Заполненная структура InterruptInfo
+     */
+    InterruptInfo getInterruptInfo();
+
+    /**
+     * @brief То же, что getInterruptInfo(), но с заполнением существующей
+     * структуры
+     *
+     * @details Память матриц и меток output переиспользуется, поэтому при
+     * периодическом опросе одной и той же структурой выделений памяти не
+     * происходит
+     */
+    void getInterruptInfo(InterruptInfo &output);
+
+    /**
+     * @brief Получение температуры, оборотов вентиляторов и мощности
+     *
+     * @details Температурные зоны берутся из /sys/class/thermal, датчики
+     * температуры и вентиляторы - из /sys/class/hwmon, мощность доменов RAPL
+     * считается по приращению их счетчиков энергии (energy_uj в
+     * /sys/class/powercap) с предыдущего вызова. Датчики находятся при
+     * первом вызове, их файлы остаются открытыми; первый вызов ждет
+     * ProbeOptions::warmupDelay.
+     *
+     * @note Чтение energy_uj на новых ядрах требует прав суперпользователя,
+     * без них список power пуст. На Windows не поддерживается
+     *
+     * @return Заполненная структура ThermalInfo
+     */
+    ThermalInfo getThermalInfo();
+
+    /**
+     * @brief Получение показаний счетчиков производительности процессора
+     *
+     * @details Для каждого логического процессора открывается группа событий
+     * perf (такты, инструкции, промахи кэша и предсказаний переходов,
+     * переключения контекста, страничные прерывания), которая читается одним
+     * системным вызовом. Частоты считаются за интервал с предыдущего вызова;
+     * первый вызов ждет ProbeOptions::warmupDelay.
+     *
+     * @note Требует прав на системные события perf (perf_event_paranoid <= 0
+     * или CAP_PERFMON). Если прав нет, возвращается пустой список cores. На
+     * Windows не поддерживается
+     *
+     * @return Заполненная структура PerfCounterInfo
+     */
+    PerfCounterInfo getPerfCounterInfo();
+
+    /**
+     * @brief Получение статистики о работе самой библиотеки
+     *
+     * @details Для каждого метода возвращается количество вызовов,
+     * гистограмма их длительностей, объем прочитанных данных, количество
+     * системных вызовов и запущенных утилит, попадания и промахи кэшей.
+     * Статистика накапливается с момента создания объекта
+     *
+     * @return Заполненная структура SelfStats
+     */
+    SelfStats getSelfStats() const;
 
   private:
-    class ProbeUtilsImpl;
-    std::unique_ptr<ProbeUtilsImpl> _impl;
+    std::unique_ptr<Backend> _backend;
+    std::unique_ptr<ProbeTelemetry> _telemetry;
 };
+
+/**
+ * @brief Сбор информации о текущей системе
+ */
+using ProbeUtilities = BasicProbe<ProbeUtilsImpl>;
+
+// Инстанцируется в ProbeUtilities.cpp, поэтому пользователям библиотеки
+// не нужны определения методов и реализация для их ОС
+extern template class BasicProbe<ProbeUtilsImpl>;
 } // namespace info
 
 #endif
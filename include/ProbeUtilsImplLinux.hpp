@@ -1,8 +1,19 @@
 #ifndef __PROBE_UTILS_IMPL_LINUX
 #define __PROBE_UTILS_IMPL_LINUX
+#include <BootCache.hpp>
+#include <CgroupProbe.hpp>
+#include <MountProbe.hpp>
+#include <PerfEventProbe.hpp>
+#include <ProcInterrupts.hpp>
+#include <ProbeSource.hpp>
+#include <ProcStat.hpp>
 #include <ProbeUtilities.hpp>
+#include <SharedCache.hpp>
+#include <SocketProbe.hpp>
+#include <ThermalProbe.hpp>
+#include <VMProbe.hpp>
+#include <mutex>
 #include <nlohmann/json.hpp>
-#include <optional>
 #include <sys/utsname.h>
 #include <unordered_set>
 
@@ -14,29 +25,97 @@
 
 namespace info
 {
-class ProbeUtilities::ProbeUtilsImpl
+class ProbeUtilsImpl
 {
   public:
-    ProbeUtilsImpl();
+    ProbeUtilsImpl(const ProbeOptions &options);
     ~ProbeUtilsImpl();
-    OSInfo getOSInfo();
+    OSInfo getOSInfo(OSField fields);
 
     std::vector<UserInfo> getUserInfo();
 
     std::vector<DiscPartitionInfo> getDiscPartitionInfo();
 
+    std::vector<MountInfo> getMountInfo(const MountFilter &filter);
+
     std::vector<PeripheryInfo> getPeripheryInfo();
 
     std::vector<NetworkInterfaceInfo> getNetworkInterfaceInfo();
 
-    MemoryInfo getMemoryInfo();
+    SocketInfo getSocketInfo();
+
+    MemoryInfo getMemoryInfo(MemoryField fields);
+
+    VMInfo getVMInfo();
+
+    std::vector<CgroupInfo> getCgroupInfo(const CgroupFilter &filter);
+
+    CPUInfo getCPUInfo(CPUField fields);
+
+    CPUTimesInfo getCPUTimes();
+
+    SchedulerInfo getSchedulerInfo();
 
-    CPUInfo getCPUInfo();
+    void getInterruptInfo(InterruptInfo &output);
+
+    ThermalInfo getThermalInfo();
+
+    PerfCounterInfo getPerfCounterInfo();
 
   private:
     static const std::unordered_set<std::string> _DESIRED_CLASSES;
-    std::optional<utsname> _osinfo{std::nullopt};
-    std::optional<std::vector<DiscPartitionInfo>> _cached_DPInfo{std::nullopt};
+    ProbeOptions _options;
+    ProbeSource _source;
+    PerfEventProbe _perf{_source, _options.warmupDelay};
+    ThermalProbe _thermal{_source, _options.warmupDelay};
+    MountProbe _mounts{_source, _options.mountTimeout};
+    SocketProbe _sockets{_source};
+    VMProbe _vm{_source, _options.warmupDelay};
+    CgroupProbe _cgroups{_source, _options.warmupDelay};
+    BootCache _bootCache;
+    SharedCache<utsname> _osinfo;
+    SharedCache<std::vector<DiscPartitionInfo>> _cached_DPInfo;
+    SharedCache<std::vector<PeripheryInfo>> _perInfo{
+        SharedCache<std::vector<PeripheryInfo>>::clock::duration::zero()};
+    SharedCache<std::vector<NetworkInterfaceInfo>> _netInfo{
+        SharedCache<std::vector<NetworkInterfaceInfo>>::clock::duration::zero()};
+
+    // Предыдущий снимок /proc/stat, от которого считаются приращения
+    std::mutex _statMutex;
+    std::string _statBuffer;
+    bool _hasPrevStat{false};
+    ProcStatSnapshot _prevStat, _curStat;
+    CPUTimesInfo _lastTimes;
+
+    // Предыдущие счетчики планировщика. Для разбора /proc/stat используется
+    // общий буфер и снимок _curStat, поэтому они защищены _statMutex
+    struct SchedSample
+    {
+        uint64_t ticks;
+        std::size_t cores;
+        uint64_t contextSwitches;
+        uint64_t processes;
+        std::vector<SchedstatCPU> cpus;
+    };
+    std::string _schedBuffer;
+    bool _hasPrevSched{false};
+    SchedSample _prevSched, _curSched;
+    SchedulerInfo _lastSched;
+
+    // Предыдущие таблицы прерываний. Пары prev/cur меняются местами после
+    // каждого замера, поэтому память матриц не выделяется заново
+    std::mutex _irqMutex;
+    std::string _irqBuffer;
+    bool _hasPrevIrq{false};
+    double _prevUptime{0};
+    InterruptMatrix _prevIrq, _curIrq, _prevSoftirq, _curSoftirq;
+
+    std::shared_ptr<const utsname> _uname();
+    CPUTimesInfo _sampleCPUTimes();
+    bool _readSchedSample(SchedSample &out);
+    double _readInterrupts(InterruptMatrix &irq, InterruptMatrix &softirq);
+    std::vector<PeripheryInfo> _readPeripheryInfo();
+    std::vector<NetworkInterfaceInfo> _readNetworkInterfaceInfo();
 
     void _getCPULoadness(CPUInfo &write);
     void _getCPUCache(CPUInfo &write);
@@ -10,24 +10,42 @@
 
 namespace info
 {
-class ProbeUtilities::ProbeUtilsImpl
+class ProbeUtilsImpl
 {
   public:
-    ProbeUtilsImpl();
+    ProbeUtilsImpl(const ProbeOptions &options);
     ~ProbeUtilsImpl();
-    OSInfo getOSInfo();
+    OSInfo getOSInfo(OSField fields);
 
     std::vector<UserInfo> getUserInfo();
 
     std::vector<DiscPartitionInfo> getDiscPartitionInfo();
 
+    std::vector<MountInfo> getMountInfo(const MountFilter &filter);
+
     std::vector<PeripheryInfo> getPeripheryInfo();
 
     std::vector<NetworkInterfaceInfo> getNetworkInterfaceInfo();
 
-    CPUInfo getCPUInfo();
+    SocketInfo getSocketInfo();
+
+    CPUInfo getCPUInfo(CPUField fields);
+
+    CPUTimesInfo getCPUTimes();
+
+    SchedulerInfo getSchedulerInfo();
+
+    void getInterruptInfo(InterruptInfo &output);
+
+    ThermalInfo getThermalInfo();
+
+    PerfCounterInfo getPerfCounterInfo();
+
+    MemoryInfo getMemoryInfo(MemoryField fields);
+
+    VMInfo getVMInfo();
 
-    MemoryInfo getMemoryInfo();
+    std::vector<CgroupInfo> getCgroupInfo(const CgroupFilter &filter);
 
   private:
     // Вызов Windows PowerShell для WMI commands
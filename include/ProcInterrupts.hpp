@@ -0,0 +1,36 @@
+#ifndef __PROC_INTERRUPTS
+#define __PROC_INTERRUPTS
+#include <ProbeUtilities.hpp>
+#include <string>
+
+/*
+ * Разбор /proc/interrupts и /proc/softirqs. Оба файла - таблица, в которой
+ * первая строка перечисляет процессоры, а остальные начинаются с метки и
+ * содержат по счетчику на каждый процессор
+ * */
+
+namespace info
+{
+/**
+ * @brief Разбирает таблицу счетчиков прерываний
+ *
+ * @details В out.counts записываются накопленные значения счетчиков.
+ * Недостающие в строке значения (например, у ERR и MIS) остаются нулями.
+ * Память out переиспользуется между вызовами
+ *
+ * @return false, если в файле нет заголовка с процессорами
+ */
+bool parseInterrupts(const std::string &raw, InterruptMatrix &out);
+
+/**
+ * @brief Приращения счетчиков между двумя разобранными таблицами
+ *
+ * @details Строки сопоставляются по меткам. Если набор процессоров
+ * изменился или строки нет в before, ее приращения равны нулю. Память out
+ * переиспользуется между вызовами
+ */
+void diffInterrupts(const InterruptMatrix &before, const InterruptMatrix &after,
+                    InterruptMatrix &out);
+} // namespace info
+
+#endif
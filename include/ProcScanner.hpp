@@ -0,0 +1,58 @@
+#ifndef __PROC_SCANNER
+#define __PROC_SCANNER
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Быстрый разбор десятичных счетчиков из файлов /proc (stat, interrupts,
+ * diskstats и т.п.). Границы чисел ищутся векторными инструкциями, сами числа
+ * переводятся из строки по 8 цифр за раз. Набор инструкций выбирается при
+ * первом вызове в зависимости от возможностей процессора
+ * */
+
+namespace info
+{
+/**
+ * @brief Набор инструкций, используемый для разбора
+ */
+enum class ScanLevel
+{
+    Scalar, ///< Побайтовый разбор
+    SSE,    ///< 16 байт за итерацию
+    AVX2    ///< 32 байта за итерацию
+};
+
+/**
+ * @brief Лучший набор инструкций, доступный на текущем процессоре
+ */
+ScanLevel bestScanLevel();
+
+/**
+ * @brief Разбирает подряд идущие десятичные числа
+ *
+ * @details Все символы, кроме цифр, считаются разделителями. Разбор
+ * останавливается после max чисел или по достижении end
+ *
+ * @param pos Начало разбираемого диапазона. После вызова указывает на первый
+ * символ после последнего разобранного числа
+ * @param end Конец диапазона
+ * @param out Массив для результатов, не меньше max элементов
+ * @param max Максимальное количество чисел
+ *
+ * @return Количество разобранных чисел
+ */
+std::size_t scanNumbers(const char *&pos, const char *end, uint64_t *out,
+                        std::size_t max);
+
+/**
+ * @brief То же, что scanNumbers, но с явно заданным набором инструкций
+ *
+ * @details Нужна для сравнения реализаций между собой. Если набор инструкций
+ * недоступен на процессоре, используется побайтовый разбор
+ */
+std::size_t scanNumbersWith(ScanLevel level, const char *&pos, const char *end,
+                            uint64_t *out, std::size_t max);
+} // namespace info
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef __PROC_STAT
+#define __PROC_STAT
+#include <ProbeUtilities.hpp>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * Разбор /proc/stat и связанных с ним файлов планировщика. /proc/stat
+ * читается один раз за замер, и из одного снимка строятся все производные
+ * показатели
+ * */
+
+namespace info
+{
+/**
+ * @brief Накопленные такты процессора в каждом состоянии
+ */
+using CPUStateTicks = std::array<uint64_t, CPUTimes::STATES>;
+
+/**
+ * @brief Разобранный снимок /proc/stat
+ */
+struct ProcStatSnapshot
+{
+    CPUStateTicks total{};            ///< Строка "cpu"
+    std::vector<CPUStateTicks> cores; ///< Строки "cpuN"
+    std::vector<uint32_t> coreIds;    ///< Номера N строк cores
+
+    uint64_t contextSwitches{0}; ///< Строка "ctxt"
+    uint64_t processes{0};       ///< Строка "processes"
+    uint64_t procsRunning{0};    ///< Строка "procs_running"
+    uint64_t procsBlocked{0};    ///< Строка "procs_blocked"
+};
+
+/**
+ * @brief Накопленные счетчики одного процессора из /proc/schedstat
+ */
+struct SchedstatCPU
+{
+    uint32_t cpu;        ///< Номер логического процессора
+    uint64_t runTime;    ///< Время выполнения задач, в наносекундах
+    uint64_t runDelay;   ///< Время ожидания задач в очереди, в наносекундах
+    uint64_t timeslices; ///< Количество выданных квантов времени
+};
+
+/**
+ * @brief Разбирает содержимое /proc/stat
+ *
+ * @details Память out.cores и out.coreIds переиспользуется между вызовами
+ *
+ * @return false, если в файле нет ни одной строки cpu
+ */
+bool parseProcStat(const std::string &raw, ProcStatSnapshot &out);
+
+/**
+ * @brief Разбирает содержимое /proc/schedstat
+ *
+ * @details Строки доменов планирования пропускаются. Память out
+ * переиспользуется между вызовами
+ *
+ * @return false, если в файле нет ни одной строки cpu
+ */
+bool parseSchedstat(const std::string &raw, std::vector<SchedstatCPU> &out);
+
+/**
+ * @brief Сумма тактов во всех состояниях, кроме Guest и GuestNice
+ */
+uint64_t sumTicks(const CPUStateTicks &ticks);
+
+/**
+ * @brief Приращения и доли состояний между двумя снимками одного процессора
+ */
+CPUTimes diffCPUTimes(const CPUStateTicks &before, const CPUStateTicks &after);
+} // namespace info
+
+#endif
@@ -0,0 +1,169 @@
+#ifndef __PROCESS_PROBE
+#define __PROCESS_PROBE
+#include <ProbeSource.hpp>
+#include <ProbeUtilities.hpp>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Подробный опрос одного процесса (Linux): загрузка каждого потока,
+ * количество дескрипторов, ввод-вывод из /proc/[pid]/io и память из
+ * /proc/[pid]/smaps_rollup. Файлы процесса и его потоков держатся открытыми
+ * между замерами и перечитываются через pread, поэтому замер процесса с
+ * тысячами потоков стоит по одному системному вызову на поток. Открытыми
+ * держатся не больше MAX_PINNED_THREADS файлов потоков (и не больше
+ * четверти RLIMIT_NOFILE), остальные открываются при каждом замере
+ * */
+
+namespace info
+{
+/**
+ * @brief Загрузка одного потока за интервал с предыдущего замера
+ */
+struct ThreadInfo
+{
+    uint32_t tid;
+    std::string name; ///< Имя потока (comm), не длиннее 15 символов
+    char state;       ///< Состояние: R, S, D, Z и т.д.
+    uint32_t processor; ///< Процессор, на котором поток выполнялся последним
+
+    double user{0};   ///< Время в пользовательском коде, в ядрах
+    double system{0}; ///< Время в коде ядра, в ядрах
+
+    double cpu() const { return user + system; }
+};
+
+/**
+ * @brief Состояние процесса
+ *
+ * @details Частоты считаются за интервал с предыдущего замера. Если у
+ * процесса нет прав на чтение /proc/[pid]/io или smaps_rollup (чужой
+ * процесс без CAP_SYS_PTRACE), соответствующие поля нулевые
+ */
+struct ProcessInfo
+{
+    uint32_t pid;
+    std::string name;
+    bool alive{false}; ///< false, если процесс завершился или не найден
+
+    std::chrono::duration<float> interval{0};
+
+    double user{0};   ///< Время процесса в пользовательском коде, в ядрах
+    double system{0}; ///< Время процесса в коде ядра, в ядрах
+
+    uint64_t fds{0}; ///< Открытых дескрипторов
+
+    uint64_t readBytes{0};  ///< Прочитано с устройств (read_bytes), всего
+    uint64_t writeBytes{0}; ///< Записано на устройства (write_bytes), всего
+    double readRate{0};     ///< Чтение с устройств, байт в секунду
+    double writeRate{0};    ///< Запись на устройства, байт в секунду
+    double readCalls{0};    ///< Вызовов read и подобных в секунду (syscr)
+    double writeCalls{0};   ///< Вызовов write и подобных в секунду (syscw)
+
+    uint64_t rss{0};     ///< Резидентная память, в байтах
+    uint64_t pss{0};     ///< Пропорциональная доля резидентной памяти
+    uint64_t pssAnon{0}; ///< Из нее анонимная память
+    uint64_t pssFile{0}; ///< Из нее отображенные файлы
+    uint64_t swap{0};    ///< Вытесненная в подкачку память
+    uint64_t swapPss{0}; ///< Пропорциональная доля вытесненной памяти
+
+    /**
+     * @brief Потоки по убыванию загрузки
+     */
+    std::vector<ThreadInfo> threads;
+
+    /**
+     * @brief Потоков, которые не вошли в threads из-за ошибки чтения, не
+     * связанной с завершением потока (например, EMFILE)
+     */
+    uint32_t failedThreads{0};
+};
+
+class ProcessProbe
+{
+  public:
+    /**
+     * @brief Наибольшее количество файлов потоков, открытых между замерами
+     */
+    static constexpr std::size_t MAX_PINNED_THREADS = 256;
+
+    /**
+     * @param pid Опрашиваемый процесс
+     * @param options Используются sysroot, запись, воспроизведение и
+     * warmupDelay
+     */
+    explicit ProcessProbe(uint32_t pid, ProbeOptions options = {});
+
+    ProcessProbe(const ProcessProbe &) = delete;
+    ProcessProbe &operator=(const ProcessProbe &) = delete;
+
+    /**
+     * @brief Замер процесса и его потоков
+     *
+     * @details Первый вызов делает начальный замер и ждет
+     * ProbeOptions::warmupDelay. Потоки, появившиеся между замерами,
+     * считаются созданными в течение интервала
+     */
+    ProcessInfo sample();
+
+    uint32_t pid() const { return _pid; }
+
+    /**
+     * @brief Разбирает /proc/[pid]/stat или /proc/[pid]/task/[tid]/stat
+     *
+     * @param user,system Накопленное время, в тиках часов
+     *
+     * @return false, если строка не разобрана
+     */
+    static bool parseStat(const std::string &raw, std::string &name,
+                          char &state, uint64_t &user, uint64_t &system,
+                          uint32_t &processor);
+
+    /**
+     * @brief Разбирает /proc/[pid]/smaps_rollup
+     */
+    static void parseSmapsRollup(const std::string &raw, ProcessInfo &out);
+
+  private:
+    struct Thread
+    {
+        PinnedFile stat;
+        uint64_t user{0};
+        uint64_t system{0};
+        bool seen{false};
+    };
+
+    // Накопленные значения /proc/[pid]/io
+    struct IOCounters
+    {
+        uint64_t syscr{0}, syscw{0}, readBytes{0}, writeBytes{0};
+    };
+
+    uint32_t _pid;
+    ProbeOptions _options;
+    ProbeSource _source;
+    std::string _root; ///< "/proc/<pid>"
+    std::mutex _mutex;
+    bool _opened{false};
+    double _ticks;
+    std::string _buffer;
+
+    PinnedFile _stat, _io, _smaps;
+    std::unordered_map<uint32_t, Thread> _threads;
+    std::size_t _pinBudget;  ///< Сколько файлов потоков можно держать открытыми
+    std::size_t _pinned{0};  ///< Сколько держится открытыми сейчас
+    std::chrono::nanoseconds _previousTime{0};
+    uint64_t _user{0}, _system{0};
+    IOCounters _ioCounters;
+
+    ProcessInfo _measure(bool baseline);
+    void _readThreads(ProcessInfo &output, double seconds);
+    IOCounters _readIO();
+};
+} // namespace info
+
+#endif
@@ -0,0 +1,162 @@
+#ifndef __RULE_ENGINE
+#define __RULE_ENGINE
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Правила оповещений над замерами: порог, длительность, гистерезис и
+ * скорость изменения. Правила проверяются по мере поступления значений,
+ * каждое значение обрабатывается за O(1) на правило своей метрики без
+ * хранения истории, а обработчики вызываются прямо из update()
+ * */
+
+namespace info
+{
+/**
+ * @brief Условие правила
+ */
+enum class RuleCondition
+{
+    Above,     ///< Значение больше порога
+    Below,     ///< Значение меньше порога
+    RateAbove, ///< Скорость изменения (в единицах в секунду) больше порога
+    RateBelow  ///< Скорость изменения меньше порога
+};
+
+/**
+ * @brief Состояние правила
+ */
+enum class AlertState
+{
+    Inactive, ///< Условие не выполняется
+    Pending,  ///< Условие выполняется меньше AlertRule::duration
+    Firing    ///< Оповещение сработало
+};
+
+/**
+ * @brief Правило оповещения
+ */
+struct AlertRule
+{
+    std::string name;   ///< Имя для вывода, например "cpu-hot"
+    std::string metric; ///< Имя метрики, значения которой передаются в update()
+    RuleCondition condition{RuleCondition::Above};
+    double threshold{0};
+
+    /**
+     * @brief Сработавшее оповещение снимается, только когда значение
+     * отойдет от порога больше чем на эту величину. Не дает оповещению
+     * мигать, пока значение колеблется около порога
+     */
+    double hysteresis{0};
+
+    /**
+     * @brief Сколько условие должно выполняться без перерыва, чтобы
+     * оповещение сработало. Ноль - срабатывает на первом же значении
+     */
+    std::chrono::milliseconds duration{0};
+
+    /**
+     * @brief Разбирает правило из строки
+     *
+     * @details Формат: "[имя=]метрика>порог[~гистерезис][@длительность]".
+     * Вместо '>' можно указать '<'; "rate(метрика)" задает условие на
+     * скорость изменения. Длительность - число с суффиксом ms, s или m.
+     * Если имя не указано, именем становится вся строка. Пример:
+     * "cpu-hot=cpu.load>90~5@30s"
+     *
+     * @return false, если строка не разобрана
+     */
+    static bool parse(const std::string &spec, AlertRule &out);
+};
+
+/**
+ * @brief Изменение состояния правила
+ */
+struct AlertEvent
+{
+    const AlertRule &rule;
+    bool firing; ///< true - оповещение сработало, false - снято
+    std::chrono::steady_clock::time_point time;
+
+    /**
+     * @brief Значение метрики или скорость ее изменения, на котором
+     * изменилось состояние
+     */
+    double value;
+};
+
+/**
+ * @brief Набор правил и их состояния
+ *
+ * @note Не потокобезопасен: значения должны передаваться из одного потока
+ * или под внешней блокировкой
+ */
+class RuleEngine
+{
+  public:
+    using Callback = std::function<void(const AlertEvent &)>;
+
+    /**
+     * @brief Добавляет правило
+     *
+     * @param callback Вызывается из update() при срабатывании и снятии
+     * оповещения
+     *
+     * @return Номер правила для state()
+     */
+    std::size_t addRule(AlertRule rule, Callback callback);
+
+    /**
+     * @brief Номер метрики для быстрой перегрузки update()
+     */
+    std::size_t metric(const std::string &name);
+
+    /**
+     * @brief Передает очередное значение метрики
+     *
+     * @details Время значений одной метрики не должно убывать. Значения
+     * метрик без правил отбрасываются
+     */
+    void update(std::size_t metric, std::chrono::steady_clock::time_point time,
+                double value);
+
+    void update(const std::string &metric,
+                std::chrono::steady_clock::time_point time, double value);
+
+    AlertState state(std::size_t rule) const;
+
+    std::size_t rules() const { return _rules.size(); }
+
+  private:
+    struct Rule
+    {
+        AlertRule rule;
+        Callback callback;
+        AlertState state{AlertState::Inactive};
+        std::chrono::steady_clock::time_point since;
+    };
+
+    struct Metric
+    {
+        std::vector<std::size_t> rules;
+        bool hasValue{false};
+        bool hasRate{false};
+        std::chrono::steady_clock::time_point time;
+        double value{0};
+    };
+
+    std::vector<Rule> _rules;
+    std::vector<Metric> _metrics;
+    std::unordered_map<std::string, std::size_t> _names;
+
+    void _evaluate(Rule &rule, std::chrono::steady_clock::time_point time,
+                   double value);
+};
+} // namespace info
+
+#endif
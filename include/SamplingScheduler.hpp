@@ -0,0 +1,146 @@
+#ifndef __SAMPLING_SCHEDULER
+#define __SAMPLING_SCHEDULER
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+
+/*
+ * Планировщик опроса с разными периодами в одном потоке (Linux). Поток спит
+ * в epoll_wait на одном timerfd, который взводится на абсолютное время
+ * ближайшего замера. Моменты замеров каждой задачи отсчитываются от общего
+ * начала с шагом ее периода, поэтому ошибка одного пробуждения не копится,
+ * а замеры задач с кратными периодами приходятся на одни и те же тики и
+ * выполняются за одно пробуждение
+ * */
+
+namespace info
+{
+/**
+ * @brief Пропуск замеров задачей
+ */
+struct OverrunEvent
+{
+    const std::string &name;
+    uint64_t missed; ///< Количество пропущенных моментов замера
+    std::chrono::nanoseconds lateness; ///< Задержка начала замера
+    std::chrono::nanoseconds duration; ///< Длительность замера
+};
+
+/**
+ * @brief Статистика задачи
+ */
+struct ScheduledTaskStats
+{
+    uint64_t runs{0};   ///< Выполненных замеров
+    uint64_t missed{0}; ///< Пропущенных моментов замера
+
+    /**
+     * @brief Наибольшая задержка начала замера относительно его момента.
+     * Задержку дают пробуждение потока и замеры других задач, выполнявшиеся
+     * в это время
+     */
+    std::chrono::nanoseconds maxLateness{0};
+    std::chrono::nanoseconds lastDuration{0};
+    std::chrono::nanoseconds maxDuration{0};
+};
+
+/**
+ * @brief Планировщик периодических замеров
+ *
+ * @details Задачи, моменты которых наступили, выполняются по возрастанию
+ * периода, а после каждого замера очередь пересматривается: если во время
+ * долгого замера подошел момент частой задачи, она выполняется раньше
+ * остальных редких. Задача, не успевшая к следующему своему моменту,
+ * пропускает прошедшие моменты вместо того, чтобы выполняться несколько раз
+ * подряд, и о пропуске сообщается через onOverrun().
+ *
+ * @note Задачи выполняются в потоке, вызвавшем run(). add() и remove()
+ * можно вызывать до run() и из самих задач, stop() - из любого потока
+ */
+class SamplingScheduler
+{
+  public:
+    using clock = std::chrono::steady_clock;
+    using Task = std::function<void()>;
+    using OverrunCallback = std::function<void(const OverrunEvent &)>;
+
+    /**
+     * @param tolerance Задачи, моменты которых наступят не позже чем через
+     * tolerance, выполняются в текущем пробуждении. Объединяет замеры с
+     * почти совпадающими моментами и уменьшает количество пробуждений ценой
+     * раннего начала не больше чем на tolerance
+     */
+    explicit SamplingScheduler(
+        std::chrono::microseconds tolerance = std::chrono::milliseconds(1));
+    ~SamplingScheduler();
+
+    SamplingScheduler(const SamplingScheduler &) = delete;
+    SamplingScheduler &operator=(const SamplingScheduler &) = delete;
+
+    /**
+     * @return false, если не удалось создать timerfd, eventfd или epoll
+     */
+    bool valid() const { return _epoll >= 0; }
+
+    /**
+     * @brief Добавляет задачу
+     *
+     * @param interval Период замеров. Ноль - задача выполняется один раз
+     *
+     * @details Первый замер выполняется сразу после запуска run() (или
+     * сразу, если планировщик уже работает), следующие - через interval
+     *
+     * @return Номер задачи для stats() и remove()
+     */
+    std::size_t add(std::string name, clock::duration interval, Task task);
+
+    void remove(std::size_t id);
+
+    /**
+     * @brief Обработчик пропуска замеров. Вызывается из потока run()
+     */
+    void onOverrun(OverrunCallback callback);
+
+    /**
+     * @brief Выполняет задачи до вызова stop()
+     */
+    void run();
+
+    void stop();
+
+    ScheduledTaskStats stats(std::size_t id) const;
+
+  private:
+    struct Entry
+    {
+        std::string name;
+        clock::duration interval;
+        Task task;
+        bool active{true};
+        bool started{false}; ///< Момент первого замера назначен
+        clock::time_point due;
+        ScheduledTaskStats stats;
+    };
+
+    clock::duration _tolerance;
+    int _epoll{-1};
+    int _timer{-1};
+    int _wake{-1};
+    std::atomic<bool> _stopped{false};
+    bool _running{false};
+    clock::time_point _epoch;
+
+    // deque: задача может добавить другую, не сдвигая выполняемую
+    std::deque<Entry> _entries;
+    OverrunCallback _onOverrun;
+
+    Entry *_nextDue(clock::time_point horizon);
+    void _wait(clock::time_point deadline);
+    void _execute(Entry &entry);
+};
+} // namespace info
+
+#endif
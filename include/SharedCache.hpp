@@ -0,0 +1,138 @@
+#ifndef __SHARED_CACHE
+#define __SHARED_CACHE
+#include <ProbeTelemetry.hpp>
+#include <chrono>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+/*
+ * Потокобезопасный кэш результата одного метода.
+ *
+ * Значение хранится как неизменяемый снимок (shared_ptr<const T>), который
+ * публикуется атомарно: читатели свежего значения не берут никаких
+ * блокировок. Если значение устарело, обновление выполняет только один поток,
+ * остальные потоки, пришедшие за тем же значением, дожидаются его результата
+ * (single-flight)
+ * */
+
+namespace info
+{
+template <typename T> class SharedCache
+{
+  public:
+    using clock = std::chrono::steady_clock;
+    using Snapshot = std::shared_ptr<const T>;
+
+    /**
+     * @param ttl Время, в течение которого значение считается свежим.
+     * clock::duration::max() - значение не устаревает никогда, 0 - кэш только
+     * объединяет одновременные вызовы
+     */
+    explicit SharedCache(clock::duration ttl = clock::duration::max())
+        : _ttl(ttl)
+    {
+    }
+
+    /**
+     * @brief Возвращает свежее значение, при необходимости обновляя его
+     *
+     * @param refresh Функция без аргументов, возвращающая T
+     */
+    template <typename Refresh> Snapshot get(Refresh &&refresh)
+    {
+        return get(std::forward<Refresh>(refresh),
+                   [](const T &) { return true; });
+    }
+
+    /**
+     * @brief То же, но значение, для которого keep вернул false (например,
+     * пустой результат неудавшейся утилиты), отдается вызывающим потокам и
+     * не сохраняется: следующий вызов снова выполнит refresh
+     *
+     * @param keep Функция, принимающая const T &
+     */
+    template <typename Refresh, typename Keep>
+    Snapshot get(Refresh &&refresh, Keep &&keep)
+    {
+        auto entry = std::atomic_load(&_entry);
+        if (entry && clock::now() < entry->expires)
+        {
+            ProbeTelemetry::cacheHit();
+            return entry->value;
+        }
+
+        std::unique_lock lock(_flightMutex);
+        // Пока ждали мьютекс, значение могли обновить
+        entry = std::atomic_load(&_entry);
+        if (entry && clock::now() < entry->expires)
+        {
+            ProbeTelemetry::cacheHit();
+            return entry->value;
+        }
+        if (_inFlight.valid())
+        {
+            auto pending = _inFlight;
+            lock.unlock();
+            // Не попадание: вызов ждет чужого обновления так же долго, как
+            // при промахе
+            ProbeTelemetry::cacheCoalesced();
+            return pending.get();
+        }
+
+        std::promise<Snapshot> promise;
+        _inFlight = promise.get_future().share();
+        lock.unlock();
+
+        ProbeTelemetry::cacheMiss();
+        try
+        {
+            auto fresh = std::make_shared<const Entry>(
+                Entry{std::make_shared<const T>(refresh()), _expiry()});
+            if (keep(*fresh->value))
+            {
+                std::atomic_store(&_entry, fresh);
+            }
+
+            lock.lock();
+            _inFlight = {};
+            lock.unlock();
+            promise.set_value(fresh->value);
+            return fresh->value;
+        }
+        catch (...)
+        {
+            lock.lock();
+            _inFlight = {};
+            lock.unlock();
+            promise.set_exception(std::current_exception());
+            throw;
+        }
+    }
+
+  private:
+    struct Entry
+    {
+        Snapshot value;
+        clock::time_point expires;
+    };
+
+    clock::duration _ttl;
+    std::shared_ptr<const Entry> _entry;
+    std::mutex _flightMutex;
+    std::shared_future<Snapshot> _inFlight;
+
+    clock::time_point _expiry() const
+    {
+        if (_ttl == clock::duration::max())
+        {
+            return clock::time_point::max();
+        }
+        return clock::now() + _ttl;
+    }
+};
+} // namespace info
+
+#endif
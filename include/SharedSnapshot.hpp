@@ -0,0 +1,160 @@
+#ifndef __SHARED_SNAPSHOT
+#define __SHARED_SNAPSHOT
+#include <ProbeUtilities.hpp>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/*
+ * Публикация снимков через разделяемую память POSIX. Один процесс на машине
+ * опрашивает систему и записывает снимки в сегмент /dev/shm фиксированного
+ * формата, остальные процессы отображают сегмент только для чтения и
+ * получают снимок без системных вызовов. Запись защищена seqlock: писатель
+ * делает счетчик нечетным на время записи, а читатель повторяет чтение,
+ * если счетчик был нечетным или изменился
+ * */
+
+namespace info
+{
+struct SnapshotSegment;
+
+/**
+ * @brief Снимок в разделяемой памяти. Содержит только типы фиксированного
+ * размера, поэтому копируется целиком
+ */
+struct SnapshotData
+{
+    /**
+     * @brief Максимальное количество ядер, загрузка которых публикуется
+     */
+    static constexpr std::size_t MAX_CORES = 1024;
+
+    int64_t timestamp;  ///< Время замера, в наносекундах от эпохи Unix
+    uint64_t published; ///< Номер снимка, начиная с 1
+    CPUField cpuFields;       ///< Заполненные поля CPUInfo
+    MemoryField memoryFields; ///< Заполненные поля MemoryInfo
+
+    char cpuName[128]; ///< CPUInfo::name, с завершающим нулем
+    char cpuArch[32];  ///< CPUInfo::arch, с завершающим нулем
+    uint32_t cores;
+    uint32_t loadCount; ///< Количество элементов load
+    uint64_t l1_cache, l2_cache, l3_cache, overall_cache;
+    uint64_t physid;
+    float clockFreq;
+    float load[MAX_CORES];
+
+    uint64_t memoryCapacity;
+    uint64_t memoryFree;
+
+    std::string_view name() const { return cpuName; }
+
+    std::chrono::system_clock::time_point time() const
+    {
+        return std::chrono::system_clock::time_point(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                std::chrono::nanoseconds(timestamp)));
+    }
+
+    /**
+     * @brief Снимок в виде структуры CPUInfo
+     */
+    CPUInfo cpuInfo() const;
+
+    /**
+     * @brief Снимок в виде структуры MemoryInfo
+     */
+    MemoryInfo memoryInfo() const;
+};
+
+/**
+ * @brief Процесс, публикующий снимки
+ *
+ * @details Сегмент создается в конструкторе (или перезаписывается, если
+ * остался от завершившегося издателя) и удаляется в деструкторе. Уже
+ * отобразившие его читатели продолжают видеть последний снимок, поэтому
+ * свежесть стоит проверять по SnapshotData::timestamp. Для одного имени
+ * должен работать только один издатель
+ */
+class SnapshotPublisher
+{
+  public:
+    /**
+     * @param name Имя сегмента, например "/sysprobe"
+     * @param options Параметры опроса системы
+     */
+    SnapshotPublisher(std::string name, ProbeOptions options = {});
+    ~SnapshotPublisher();
+
+    SnapshotPublisher(const SnapshotPublisher &) = delete;
+    SnapshotPublisher &operator=(const SnapshotPublisher &) = delete;
+
+    /**
+     * @brief Удалось ли создать сегмент
+     */
+    bool valid() const { return _segment != nullptr; }
+
+    /**
+     * @brief Опрашивает систему и публикует новый снимок
+     *
+     * @details Название процессора и кэши читаются один раз в
+     * конструкторе, при каждой публикации обновляются только загрузка
+     * ядер, частота и память
+     *
+     * @return false, если сегмент не создан
+     */
+    bool publish();
+
+    ProbeUtilities &probe() { return _probe; }
+
+  private:
+    std::string _name;
+    ProbeUtilities _probe;
+    CPUInfo _static;
+    SnapshotSegment *_segment{nullptr};
+};
+
+/**
+ * @brief Процесс, читающий опубликованные снимки
+ */
+class SnapshotReader
+{
+  public:
+    /**
+     * @param name Имя сегмента, под которым публикует SnapshotPublisher
+     */
+    explicit SnapshotReader(const std::string &name);
+    ~SnapshotReader();
+
+    SnapshotReader(const SnapshotReader &) = delete;
+    SnapshotReader &operator=(const SnapshotReader &) = delete;
+
+    /**
+     * @brief Удалось ли отобразить сегмент подходящего формата
+     */
+    bool valid() const { return _segment != nullptr; }
+
+    /**
+     * @brief Копирует последний снимок
+     *
+     * @details Системных вызовов не делает. Если издатель не успел
+     * опубликовать снимок или завершился посреди записи, возвращает false
+     */
+    bool read(SnapshotData &output) const;
+
+    /**
+     * @brief Последний снимок в виде CPUInfo. Пустой, если снимка нет
+     */
+    CPUInfo getCPUInfo() const;
+
+    /**
+     * @brief Последний снимок в виде MemoryInfo. Пустой, если снимка нет
+     */
+    MemoryInfo getMemoryInfo() const;
+
+  private:
+    const SnapshotSegment *_segment{nullptr};
+};
+} // namespace info
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef __SOCKET_PROBE
+#define __SOCKET_PROBE
+#include <ProbeSource.hpp>
+#include <ProbeUtilities.hpp>
+#include <array>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct nlmsghdr;
+
+/*
+ * Статистика сокетов через NETLINK_SOCK_DIAG. Ядро отдает дамп порциями по
+ * несколько десятков сокетов; каждая порция сразу разбирается и
+ * добавляется к счетчикам, после чего буфер используется для следующей.
+ * Память занимают только счетчики по портам (фиксированный массив) и по
+ * подсетям (по одной записи на подсеть)
+ * */
+
+namespace info
+{
+class SocketProbe
+{
+  public:
+    explicit SocketProbe(ProbeSource &source);
+
+    SocketProbe(const SocketProbe &) = delete;
+    SocketProbe &operator=(const SocketProbe &) = delete;
+
+    SocketInfo sample();
+
+  private:
+    struct Subnet
+    {
+        std::array<uint8_t, 16> address;
+        bool ipv6;
+
+        bool operator==(const Subnet &other) const
+        {
+            return ipv6 == other.ipv6 && address == other.address;
+        }
+    };
+
+    struct SubnetHash
+    {
+        std::size_t operator()(const Subnet &subnet) const;
+    };
+
+    ProbeSource &_source;
+    std::mutex _mutex;
+    std::string _buffer;
+    std::vector<uint32_t> _tcpPorts; ///< Индексируется номером порта
+    std::vector<uint32_t> _udpPorts; ///< Индексируется номером порта
+    std::unordered_map<Subnet, uint64_t, SubnetHash> _subnets;
+
+    /**
+     * @brief Выполняет дамп и передает каждое сообщение в handle
+     *
+     * @param key Ключ для записи и воспроизведения ответов
+     */
+    template <typename Handler>
+    bool _dump(const void *request, std::size_t size, const std::string &key,
+               Handler &&handle);
+
+    void _dumpInet(uint8_t family, uint8_t protocol, SocketInfo &output);
+    void _dumpUnix(SocketInfo &output);
+    void _countRemote(uint8_t family, const uint32_t *address);
+};
+} // namespace info
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef __THERMAL_PROBE
+#define __THERMAL_PROBE
+#include <ProbeSource.hpp>
+#include <ProbeUtilities.hpp>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+/*
+ * Датчики температуры, вентиляторов и счетчики энергии из sysfs. Датчики
+ * перечисляются один раз при первом замере, после этого их файлы остаются
+ * открытыми, и каждый замер - один pread на датчик
+ * */
+
+namespace info
+{
+class ThermalProbe
+{
+  public:
+    ThermalProbe(ProbeSource &source, std::chrono::milliseconds warmup);
+
+    ThermalProbe(const ThermalProbe &) = delete;
+    ThermalProbe &operator=(const ThermalProbe &) = delete;
+
+    /**
+     * @brief Текущие показания датчиков и мощность с предыдущего замера
+     *
+     * @details Первый вызов находит датчики, делает начальный замер энергии
+     * и ждет ProbeOptions::warmupDelay
+     */
+    ThermalInfo sample();
+
+  private:
+    struct ThermalZone
+    {
+        ThermalZoneInfo info;
+        PinnedFile temp;
+    };
+
+    struct HwmonSensor
+    {
+        HwmonSensorInfo info;
+        PinnedFile input;
+        float scale; ///< Множитель значения из файла
+    };
+
+    struct PowerZone
+    {
+        PowerZoneInfo info;
+        PinnedFile energy;
+        uint64_t maxRange; ///< Значение, после которого счетчик обнуляется
+        uint64_t previous; ///< Предыдущее значение счетчика, в мкДж
+    };
+
+    ProbeSource &_source;
+    std::chrono::milliseconds _warmup;
+    std::mutex _mutex;
+    bool _opened{false};
+    std::string _buffer;
+    std::chrono::nanoseconds _previousTime{0};
+
+    std::vector<ThermalZone> _zones;
+    std::vector<HwmonSensor> _temperatures;
+    std::vector<HwmonSensor> _fans;
+    std::vector<PowerZone> _power;
+
+    void _open();
+    void _openHwmon(const std::string &dir);
+    std::string _readLine(const std::string &path);
+    bool _readNumber(PinnedFile &file, int64_t &out);
+};
+} // namespace info
+
+#endif
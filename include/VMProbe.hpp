@@ -0,0 +1,90 @@
+#ifndef __VM_PROBE
+#define __VM_PROBE
+#include <ProbeSource.hpp>
+#include <ProbeUtilities.hpp>
+#include <array>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+ * Подсистема управления памятью ядра: счетчики /proc/vmstat, свободные
+ * блоки /proc/buddyinfo, пороги /proc/zoneinfo и пулы огромных страниц.
+ * Нужные строки vmstat находятся по таблице ключей, известной во время
+ * компиляции, и разбираются сразу в массив, индексируемый VMCounter
+ * */
+
+namespace info
+{
+/**
+ * @brief Накопленные значения счетчиков /proc/vmstat
+ */
+using VMCounters = std::array<uint64_t, VMInfo::COUNTERS>;
+
+class VMProbe
+{
+  public:
+    VMProbe(ProbeSource &source, std::chrono::milliseconds warmup);
+
+    VMProbe(const VMProbe &) = delete;
+    VMProbe &operator=(const VMProbe &) = delete;
+
+    /**
+     * @brief Состояние памяти и частоты счетчиков с предыдущего замера
+     *
+     * @details Первый вызов находит пулы огромных страниц, делает начальный
+     * замер счетчиков и ждет ProbeOptions::warmupDelay
+     */
+    VMInfo sample();
+
+    /**
+     * @brief Разбирает содержимое /proc/vmstat
+     *
+     * @details Счетчики, которых нет в файле, остаются нулевыми. Счетчики
+     * allocstall разных зон суммируются
+     */
+    static void parseVmstat(const std::string &raw, VMCounters &out);
+
+    /**
+     * @brief Разбирает содержимое /proc/buddyinfo
+     *
+     * @details Память out переиспользуется между вызовами
+     */
+    static void parseBuddyinfo(const std::string &raw,
+                               std::vector<BuddyZoneInfo> &out);
+
+    /**
+     * @brief Дополняет зоны из /proc/buddyinfo свободными страницами и
+     * порогами из /proc/zoneinfo
+     *
+     * @details Зоны, которых нет в zones (пустые), пропускаются
+     */
+    static void parseZoneinfo(const std::string &raw,
+                              std::vector<BuddyZoneInfo> &zones);
+
+  private:
+    struct HugePagePool
+    {
+        HugePagePoolInfo info;
+        PinnedFile total;
+        PinnedFile free;
+        PinnedFile surplus;
+    };
+
+    ProbeSource &_source;
+    std::chrono::milliseconds _warmup;
+    std::mutex _mutex;
+    bool _opened{false};
+    std::string _buffer;
+    std::chrono::nanoseconds _previousTime{0};
+    VMCounters _previous{};
+    std::vector<HugePagePool> _hugepages;
+
+    void _open();
+    void _openHugepages(const std::string &dir, uint32_t node);
+    uint64_t _readNumber(PinnedFile &file);
+};
+} // namespace info
+
+#endif
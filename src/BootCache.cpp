@@ -0,0 +1,379 @@
+#include <BootCache.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+constexpr char MAGIC[8] = {'S', 'P', 'B', 'O', 'O', 'T', 0, 0};
+constexpr uint32_t VERSION = 2;
+
+// Поля CPUInfo, которые хранятся в разделе CPUBasic
+constexpr info::CPUField BASIC_FIELDS =
+    info::CPUField::Name | info::CPUField::Cores | info::CPUField::PhysId |
+    info::CPUField::OverallCache;
+
+// Кэш занимает единицы килобайт, файл большего размера считается чужим
+constexpr std::size_t MAX_SIZE = 16 << 20;
+
+bool readSmallFile(const char *path, std::string &out)
+{
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+    out.clear();
+    char chunk[4096];
+    ssize_t got;
+    while ((got = read(fd, chunk, sizeof(chunk))) > 0 &&
+           out.size() < MAX_SIZE)
+    {
+        out.append(chunk, got);
+    }
+    close(fd);
+    return got == 0;
+}
+
+void put(std::string &out, const void *data, std::size_t size)
+{
+    out.append(static_cast<const char *>(data), size);
+}
+
+void putU32(std::string &out, uint32_t value) { put(out, &value, 4); }
+
+void putU64(std::string &out, uint64_t value) { put(out, &value, 8); }
+
+void putString(std::string &out, const std::string &value)
+{
+    putU32(out, value.size());
+    out += value;
+}
+
+// Последовательное чтение с проверкой границ: после первой ошибки все
+// последующие чтения тоже неудачны
+class Reader
+{
+  public:
+    explicit Reader(const std::string &data) : _data(data) {}
+
+    bool ok() const { return _ok; }
+
+    bool take(void *out, std::size_t size)
+    {
+        _ok = _ok && size <= _data.size() - _pos;
+        if (_ok)
+        {
+            std::memcpy(out, _data.data() + _pos, size);
+            _pos += size;
+        }
+        return _ok;
+    }
+
+    uint32_t u32()
+    {
+        uint32_t value = 0;
+        take(&value, 4);
+        return value;
+    }
+
+    uint64_t u64()
+    {
+        uint64_t value = 0;
+        take(&value, 8);
+        return value;
+    }
+
+    std::string string()
+    {
+        const uint32_t size = u32();
+        _ok = _ok && size <= _data.size() - _pos;
+        if (!_ok)
+        {
+            return {};
+        }
+        std::string value(_data, _pos, size);
+        _pos += size;
+        return value;
+    }
+
+  private:
+    const std::string &_data;
+    std::size_t _pos{0};
+    bool _ok{true};
+};
+} // namespace
+
+info::BootCache::BootCache(std::string path) : _path(std::move(path)) {}
+
+std::string info::BootCache::bootId()
+{
+    std::string raw;
+    if (!readSmallFile("/proc/sys/kernel/random/boot_id", raw))
+    {
+        return {};
+    }
+    while (!raw.empty() && raw.back() == '\n')
+    {
+        raw.pop_back();
+    }
+    return raw;
+}
+
+uint64_t info::BootCache::generation() const
+{
+    std::string raw;
+    if (!enabled() || !readSmallFile("/sys/kernel/uevent_seqnum", raw))
+    {
+        return 0;
+    }
+    return std::strtoull(raw.c_str(), nullptr, 10);
+}
+
+void info::BootCache::_load()
+{
+    if (_loaded)
+    {
+        return;
+    }
+    _loaded = true;
+    _bootId = bootId();
+
+    std::string raw;
+    if (_bootId.empty() || !readSmallFile(_path.c_str(), raw))
+    {
+        return;
+    }
+
+    Reader in(raw);
+    char magic[sizeof(MAGIC)];
+    if (!in.take(magic, sizeof(magic)) ||
+        std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || in.u32() != VERSION)
+    {
+        return;
+    }
+    const uint32_t sections = in.u32();
+    // Файл, записанный до перезагрузки, целиком устарел
+    if (in.string() != _bootId || !in.ok())
+    {
+        return;
+    }
+
+    if (sections & CPUBasic)
+    {
+        _cpuName = in.string();
+        _cores = in.u32();
+        _physid = in.u64();
+        _overallCache = in.u64();
+        _cpuFields = static_cast<CPUField>(in.u32()) & BASIC_FIELDS;
+    }
+    if (sections & CPUCache)
+    {
+        _l1 = in.u64();
+        _l2 = in.u64();
+        _l3 = in.u64();
+    }
+    if (sections & Periphery)
+    {
+        _generation = in.u64();
+        const uint32_t count = in.u32();
+        for (uint32_t i = 0; i < count && in.ok(); ++i)
+        {
+            PeripheryInfo device;
+            device.name = in.string();
+            device.type = in.string();
+            _periphery.push_back(std::move(device));
+        }
+    }
+    if (in.ok())
+    {
+        _sections = sections & (CPUBasic | CPUCache | Periphery);
+    }
+    else
+    {
+        _periphery.clear();
+    }
+}
+
+void info::BootCache::_save()
+{
+    if (_bootId.empty())
+    {
+        return;
+    }
+
+    std::string out;
+    put(out, MAGIC, sizeof(MAGIC));
+    putU32(out, VERSION);
+    putU32(out, _sections);
+    putString(out, _bootId);
+    if (_sections & CPUBasic)
+    {
+        putString(out, _cpuName);
+        putU32(out, _cores);
+        putU64(out, _physid);
+        putU64(out, _overallCache);
+        putU32(out, static_cast<uint32_t>(_cpuFields));
+    }
+    if (_sections & CPUCache)
+    {
+        putU64(out, _l1);
+        putU64(out, _l2);
+        putU64(out, _l3);
+    }
+    if (_sections & Periphery)
+    {
+        putU64(out, _generation);
+        putU32(out, _periphery.size());
+        for (const auto &device : _periphery)
+        {
+            putString(out, device.name);
+            putString(out, device.type);
+        }
+    }
+
+    // Файл заменяется атомарно, поэтому параллельно запущенные процессы
+    // никогда не читают недописанный кэш. Временный файл создается со
+    // случайным именем и O_EXCL: в общем каталоге заранее подложенная по
+    // предсказуемому имени ссылка иначе направила бы запись в чужой файл
+    std::string temporary = _path + ".XXXXXX";
+    const int fd = mkostemp(temporary.data(), O_CLOEXEC);
+    if (fd < 0)
+    {
+        return;
+    }
+    fchmod(fd, 0644);
+    std::size_t written = 0;
+    while (written < out.size())
+    {
+        const ssize_t result =
+            write(fd, out.data() + written, out.size() - written);
+        if (result <= 0)
+        {
+            break;
+        }
+        written += result;
+    }
+    const bool complete = close(fd) == 0 && written == out.size();
+    if (!complete || std::rename(temporary.c_str(), _path.c_str()) != 0)
+    {
+        unlink(temporary.c_str());
+    }
+}
+
+bool info::BootCache::cpuBasic(CPUInfo &out)
+{
+    if (!enabled())
+    {
+        return false;
+    }
+    std::lock_guard lock(_mutex);
+    _load();
+    if (!(_sections & CPUBasic))
+    {
+        return false;
+    }
+    out.name = _cpuName;
+    out.cores = _cores;
+    out.physid = _physid;
+    out.overall_cache = _overallCache;
+    out.fields = out.fields | _cpuFields;
+    return true;
+}
+
+void info::BootCache::storeCPUBasic(const CPUInfo &info)
+{
+    const CPUField fields = info.fields & BASIC_FIELDS;
+    if (!enabled() || fields == CPUField{})
+    {
+        return;
+    }
+    std::lock_guard lock(_mutex);
+    _load();
+    // При запросе частоты /proc/cpuinfo читается на каждом вызове, а файл
+    // переписывается, только если данные изменились
+    if ((_sections & CPUBasic) && _cpuName == info.name &&
+        _cores == info.cores && _physid == info.physid &&
+        _overallCache == info.overall_cache && _cpuFields == fields)
+    {
+        return;
+    }
+    _cpuName = info.name;
+    _cores = info.cores;
+    _physid = info.physid;
+    _overallCache = info.overall_cache;
+    _cpuFields = fields;
+    _sections |= CPUBasic;
+    _save();
+}
+
+bool info::BootCache::cpuCache(CPUInfo &out)
+{
+    if (!enabled())
+    {
+        return false;
+    }
+    std::lock_guard lock(_mutex);
+    _load();
+    if (!(_sections & CPUCache))
+    {
+        return false;
+    }
+    out.l1_cache = _l1;
+    out.l2_cache = _l2;
+    out.l3_cache = _l3;
+    return true;
+}
+
+void info::BootCache::storeCPUCache(const CPUInfo &info)
+{
+    // Нулевые емкости означают, что lscpu не отработал
+    if (!enabled() || (info.l1_cache == 0 && info.l2_cache == 0 &&
+                       info.l3_cache == 0))
+    {
+        return;
+    }
+    std::lock_guard lock(_mutex);
+    _load();
+    _l1 = info.l1_cache;
+    _l2 = info.l2_cache;
+    _l3 = info.l3_cache;
+    _sections |= CPUCache;
+    _save();
+}
+
+bool info::BootCache::periphery(uint64_t generation,
+                                std::vector<PeripheryInfo> &out)
+{
+    if (!enabled())
+    {
+        return false;
+    }
+    std::lock_guard lock(_mutex);
+    _load();
+    if (!(_sections & Periphery) || _generation != generation)
+    {
+        return false;
+    }
+    out = _periphery;
+    return true;
+}
+
+void info::BootCache::storePeriphery(uint64_t generation,
+                                     const std::vector<PeripheryInfo> &devices)
+{
+    // Пустой список обычно означает, что lshw не установлен
+    if (!enabled() || devices.empty())
+    {
+        return;
+    }
+    std::lock_guard lock(_mutex);
+    _load();
+    _generation = generation;
+    _periphery = devices;
+    _sections |= Periphery;
+    _save();
+}
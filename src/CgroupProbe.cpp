@@ -0,0 +1,361 @@
+#include <CgroupProbe.hpp>
+#include <ProbeTelemetry.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <string_view>
+#include <thread>
+
+namespace
+{
+// Больше потоков не ускоряет обход: упирается в блокировки kernfs
+constexpr unsigned MAX_THREADS = 8;
+
+struct Task
+{
+    std::string path;
+    uint32_t depth;
+};
+
+// Префикс без завершающего '/'. Корень иерархии - пустая строка
+std::string normalizePrefix(std::string prefix)
+{
+    while (!prefix.empty() && prefix.back() == '/')
+    {
+        prefix.pop_back();
+    }
+    if (!prefix.empty() && prefix.front() != '/')
+    {
+        prefix.insert(prefix.begin(), '/');
+    }
+    return prefix;
+}
+
+// Группа совпадает с префиксом или вложена в него
+bool inScope(const std::string &path, const std::string &prefix)
+{
+    return prefix.empty() || path == prefix ||
+           (path.size() > prefix.size() &&
+            path.compare(0, prefix.size(), prefix) == 0 &&
+            path[prefix.size()] == '/');
+}
+
+// Группа лежит на пути от корня к префиксу
+bool onPath(const std::string &path, const std::string &prefix)
+{
+    return path == "/" || (prefix.size() > path.size() &&
+                           prefix.compare(0, path.size(), path) == 0 &&
+                           prefix[path.size()] == '/');
+}
+
+std::string childPath(const std::string &parent, const std::string &name)
+{
+    return parent == "/" ? "/" + name : parent + "/" + name;
+}
+
+uint64_t parseNumber(const std::string &raw)
+{
+    return std::strtoull(raw.c_str(), nullptr, 10);
+}
+
+uint64_t delta(uint64_t current, uint64_t previous)
+{
+    // Счетчики группы сбрасываются, если она пересоздана под тем же именем
+    return current >= previous ? current - previous : 0;
+}
+} // namespace
+
+info::CgroupProbe::CgroupProbe(ProbeSource &source,
+                               std::chrono::milliseconds warmup)
+    : _source(source), _warmup(warmup),
+      _threads(std::clamp(std::thread::hardware_concurrency(), 1u,
+                          MAX_THREADS))
+{
+}
+
+void info::CgroupProbe::parseCpuStat(const std::string &raw,
+                                     CgroupCounters &out)
+{
+    const char *pos = raw.data(), *end = raw.data() + raw.size();
+    while (pos < end)
+    {
+        const char *eol =
+            static_cast<const char *>(std::memchr(pos, '\n', end - pos));
+        eol = eol ? eol : end;
+        const char *space =
+            static_cast<const char *>(std::memchr(pos, ' ', eol - pos));
+        if (space)
+        {
+            std::string_view key(pos, space - pos);
+            uint64_t *target = key == "usage_usec"       ? &out.usage
+                               : key == "user_usec"      ? &out.user
+                               : key == "system_usec"    ? &out.system
+                               : key == "throttled_usec" ? &out.throttled
+                                                         : nullptr;
+            if (target)
+            {
+                *target = std::strtoull(space + 1, nullptr, 10);
+            }
+        }
+        pos = eol + 1;
+    }
+}
+
+void info::CgroupProbe::parseIoStat(const std::string &raw,
+                                    CgroupCounters &out)
+{
+    // Строки вида "8:0 rbytes=1 wbytes=2 rios=3 wios=4 dbytes=0 dios=0"
+    const char *pos = raw.data(), *end = raw.data() + raw.size();
+    while (pos < end)
+    {
+        const char *eol =
+            static_cast<const char *>(std::memchr(pos, '\n', end - pos));
+        eol = eol ? eol : end;
+        const char *token =
+            static_cast<const char *>(std::memchr(pos, ' ', eol - pos));
+        while (token && token < eol)
+        {
+            ++token;
+            const char *equals = static_cast<const char *>(
+                std::memchr(token, '=', eol - token));
+            if (!equals)
+            {
+                break;
+            }
+            std::string_view key(token, equals - token);
+            char *next;
+            uint64_t value = std::strtoull(equals + 1, &next, 10);
+            uint64_t *target = key == "rbytes"   ? &out.readBytes
+                               : key == "wbytes" ? &out.writeBytes
+                               : key == "rios"   ? &out.readOps
+                               : key == "wios"   ? &out.writeOps
+                                                 : nullptr;
+            if (target)
+            {
+                *target += value;
+            }
+            token = next;
+        }
+        pos = eol + 1;
+    }
+}
+
+void info::CgroupProbe::_readGroup(Group &group, std::string &buffer)
+{
+    const std::string dir = _root + (group.path == "/" ? "" : group.path);
+
+    group.counters = {};
+    if (_source.readFile(dir + "/cpu.stat", buffer))
+    {
+        parseCpuStat(buffer, group.counters);
+    }
+    if (_source.readFile(dir + "/io.stat", buffer))
+    {
+        parseIoStat(buffer, group.counters);
+    }
+    group.memory = _source.readFile(dir + "/memory.current", buffer)
+                       ? parseNumber(buffer)
+                       : 0;
+    group.pids =
+        _source.readFile(dir + "/pids.current", buffer) ? parseNumber(buffer) : 0;
+}
+
+std::vector<info::CgroupProbe::Group>
+info::CgroupProbe::_walk(const CgroupFilter &filter)
+{
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        std::vector<Group> found;
+        std::string buffer;
+    };
+
+    const std::string prefix = normalizePrefix(filter.prefix);
+    std::vector<Worker> workers(_threads);
+    // Задачи, которые лежат в очередях или обрабатываются. Потомки
+    // учитываются до того, как обработка родителя закончится, поэтому ноль
+    // означает, что обход завершен
+    std::atomic<std::size_t> pending{1};
+    workers[0].tasks.push_back({"/", 0});
+
+    auto take = [&](std::size_t self, Task &task)
+    {
+        {
+            std::lock_guard lock(workers[self].mutex);
+            if (!workers[self].tasks.empty())
+            {
+                task = std::move(workers[self].tasks.back());
+                workers[self].tasks.pop_back();
+                return true;
+            }
+        }
+        for (std::size_t i = 1; i < workers.size(); ++i)
+        {
+            Worker &victim = workers[(self + i) % workers.size()];
+            std::lock_guard lock(victim.mutex);
+            if (!victim.tasks.empty())
+            {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    };
+
+    auto run = [&](std::size_t self)
+    {
+        Worker &worker = workers[self];
+        Task task;
+        while (pending.load(std::memory_order_acquire) != 0)
+        {
+            if (!take(self, task))
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            const bool scoped = inScope(task.path, prefix);
+            if (scoped)
+            {
+                worker.found.push_back({task.path, task.depth, 0, 0, {}});
+                _readGroup(worker.found.back(), worker.buffer);
+            }
+            if (task.depth < filter.maxDepth)
+            {
+                std::vector<Task> children;
+                for (const auto &name : _source.listSubdirectories(
+                         _root + (task.path == "/" ? "" : task.path)))
+                {
+                    std::string path = childPath(task.path, name);
+                    if (scoped || inScope(path, prefix) || onPath(path, prefix))
+                    {
+                        children.push_back({std::move(path), task.depth + 1});
+                    }
+                }
+                if (!children.empty())
+                {
+                    pending.fetch_add(children.size(),
+                                      std::memory_order_relaxed);
+                    std::lock_guard lock(worker.mutex);
+                    for (auto &child : children)
+                    {
+                        worker.tasks.push_back(std::move(child));
+                    }
+                }
+            }
+            pending.fetch_sub(1, std::memory_order_release);
+        }
+    };
+
+    // Чтения рабочих потоков относятся к тому же вызову getCgroupInfo()
+    auto *const counters = ProbeTelemetry::current();
+    std::vector<std::thread> threads;
+    for (std::size_t i = 1; i < workers.size(); ++i)
+    {
+        threads.emplace_back(
+            [&run, counters, i]
+            {
+                ProbeTelemetry::Attach attach(counters);
+                run(i);
+            });
+    }
+    run(0);
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    std::vector<Group> output;
+    for (auto &worker : workers)
+    {
+        std::move(worker.found.begin(), worker.found.end(),
+                  std::back_inserter(output));
+    }
+    std::sort(output.begin(), output.end(),
+              [](const Group &a, const Group &b) { return a.path < b.path; });
+    return output;
+}
+
+std::vector<info::CgroupInfo>
+info::CgroupProbe::_collect(const CgroupFilter &filter)
+{
+    const auto now = _source.monotonic();
+    std::vector<Group> groups = _walk(filter);
+
+    std::vector<CgroupInfo> output;
+    output.reserve(groups.size());
+    for (auto &group : groups)
+    {
+        CgroupInfo info{group.path, group.depth};
+        info.memoryCurrent = group.memory;
+        info.pids = group.pids;
+
+        auto [entry, inserted] = _previous.try_emplace(
+            group.path, Previous{group.counters, now, group.depth, true});
+        Previous &previous = entry->second;
+        const double seconds =
+            std::chrono::duration<double>(now - previous.time).count();
+        if (!inserted && seconds > 0)
+        {
+            const CgroupCounters &was = previous.counters;
+            const CgroupCounters &is = group.counters;
+            // Время в cpu.stat в микросекундах
+            const double cpuScale = 1e-6 / seconds;
+            info.interval = std::chrono::duration<float>(seconds);
+            info.cpuUsage = delta(is.usage, was.usage) * cpuScale;
+            info.cpuUser = delta(is.user, was.user) * cpuScale;
+            info.cpuSystem = delta(is.system, was.system) * cpuScale;
+            info.throttled = delta(is.throttled, was.throttled) * cpuScale;
+            info.readBytes = delta(is.readBytes, was.readBytes) / seconds;
+            info.writeBytes = delta(is.writeBytes, was.writeBytes) / seconds;
+            info.readOps = delta(is.readOps, was.readOps) / seconds;
+            info.writeOps = delta(is.writeOps, was.writeOps) / seconds;
+        }
+        previous = {group.counters, now, group.depth, true};
+        output.push_back(std::move(info));
+    }
+
+    // Группы из обойденной части иерархии, которых больше нет, удалены.
+    // Остальные ждут вызова со своим фильтром
+    const std::string prefix = normalizePrefix(filter.prefix);
+    for (auto it = _previous.begin(); it != _previous.end();)
+    {
+        if (!it->second.seen && it->second.depth <= filter.maxDepth &&
+            inScope(it->first, prefix))
+        {
+            it = _previous.erase(it);
+        }
+        else
+        {
+            it->second.seen = false;
+            ++it;
+        }
+    }
+    return output;
+}
+
+std::vector<info::CgroupInfo>
+info::CgroupProbe::sample(const CgroupFilter &filter)
+{
+    std::lock_guard lock(_mutex);
+
+    if (!_opened)
+    {
+        _opened = true;
+        // В смешанном режиме иерархия v2 смонтирована отдельно
+        std::string probe;
+        _root = _source.readFile("/sys/fs/cgroup/cgroup.controllers", probe)
+                    ? "/sys/fs/cgroup"
+                    : "/sys/fs/cgroup/unified";
+        _collect(filter);
+        if (!_source.replaying())
+        {
+            std::this_thread::sleep_for(_warmup);
+        }
+    }
+    return _collect(filter);
+}
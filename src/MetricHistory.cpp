@@ -0,0 +1,720 @@
+#include <MetricHistory.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+using info::MetricHistory;
+
+constexpr std::size_t BLOCK = MetricHistory::BLOCK;
+constexpr float INF = std::numeric_limits<float>::infinity();
+
+constexpr std::size_t CODES = 1 << 16;
+
+// Код значения: старшие 16 бит float, преобразованные так, чтобы порядок
+// кодов совпадал с порядком значений
+uint16_t encode(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    bits = (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+    return static_cast<uint16_t>(bits >> 16);
+}
+
+// Середина интервала значений, имеющих данный код
+float decode(uint16_t code)
+{
+    // Интервалы около +0 и -0 целиком состоят из денормализованных чисел
+    if (code == 0x8000 || code == 0x7fff)
+    {
+        return 0;
+    }
+    uint32_t bits = (static_cast<uint32_t>(code) << 16) | 0x8000u;
+    bits = (bits & 0x80000000u) ? (bits & 0x7fffffffu) : ~bits;
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Сортирует коды и сжимает их в пары (код << 16 | количество кодов не
+// больше этого). Возвращает количество пар
+std::size_t compress(uint16_t *codes, std::size_t count, uint32_t *runs)
+{
+    std::sort(codes, codes + count);
+    std::size_t pairs = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        if (i + 1 == count || codes[i + 1] != codes[i])
+        {
+            runs[pairs++] = (static_cast<uint32_t>(codes[i]) << 16) | (i + 1);
+        }
+    }
+    return pairs;
+}
+
+// Количество значений куска гистограммы с кодом не больше code. В паре
+// старшая половина - код, младшая - накопленное количество
+template <typename Pair>
+uint64_t countUpTo(const Pair *runs, std::size_t count, uint16_t code)
+{
+    constexpr int SHIFT = sizeof(Pair) * 4;
+    constexpr Pair MASK = (Pair(1) << SHIFT) - 1;
+    const Pair key = (Pair(code) << SHIFT) | MASK;
+    const Pair *found = std::upper_bound(runs, runs + count, key);
+    return found == runs ? 0 : found[-1] & MASK;
+}
+
+// Наименьший код из [low, high], до которого включительно больше target
+// значений. below(code) должна возвращать количество значений с кодом не
+// больше code
+template <typename Below>
+uint16_t bisect(uint16_t low, uint16_t high, uint64_t target, Below below)
+{
+    while (low < high)
+    {
+        const uint16_t middle = low + (high - low) / 2;
+        if (below(middle) > target)
+        {
+            high = middle;
+        }
+        else
+        {
+            low = middle + 1;
+        }
+    }
+    return low;
+}
+
+// Минимум, максимум и сумма подряд идущих значений. Независимые
+// аккумуляторы позволяют компилятору векторизовать цикл
+void reduce(const float *values, std::size_t count, float &min, float &max,
+            double &sum)
+{
+    float mins[4] = {min, INF, INF, INF};
+    float maxs[4] = {max, -INF, -INF, -INF};
+    double sums[4] = {sum, 0, 0, 0};
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            const float value = values[i + lane];
+            mins[lane] = value < mins[lane] ? value : mins[lane];
+            maxs[lane] = value > maxs[lane] ? value : maxs[lane];
+            sums[lane] += value;
+        }
+    }
+    for (; i < count; ++i)
+    {
+        mins[0] = values[i] < mins[0] ? values[i] : mins[0];
+        maxs[0] = values[i] > maxs[0] ? values[i] : maxs[0];
+        sums[0] += values[i];
+    }
+    min = std::min(std::min(mins[0], mins[1]), std::min(mins[2], mins[3]));
+    max = std::max(std::max(maxs[0], maxs[1]), std::max(maxs[2], maxs[3]));
+    sum = (sums[0] + sums[1]) + (sums[2] + sums[3]);
+}
+
+float reduceMin(const float *values, std::size_t count, float min)
+{
+    float mins[4] = {min, INF, INF, INF};
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            mins[lane] =
+                values[i + lane] < mins[lane] ? values[i + lane] : mins[lane];
+        }
+    }
+    for (; i < count; ++i)
+    {
+        mins[0] = values[i] < mins[0] ? values[i] : mins[0];
+    }
+    return std::min(std::min(mins[0], mins[1]), std::min(mins[2], mins[3]));
+}
+
+float reduceMax(const float *values, std::size_t count, float max)
+{
+    float maxs[4] = {max, -INF, -INF, -INF};
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            maxs[lane] =
+                values[i + lane] > maxs[lane] ? values[i + lane] : maxs[lane];
+        }
+    }
+    for (; i < count; ++i)
+    {
+        maxs[0] = values[i] > maxs[0] ? values[i] : maxs[0];
+    }
+    return std::max(std::max(maxs[0], maxs[1]), std::max(maxs[2], maxs[3]));
+}
+
+double reduceSum(const double *values, std::size_t count, double sum)
+{
+    double sums[4] = {sum, 0, 0, 0};
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            sums[lane] += values[i + lane];
+        }
+    }
+    for (; i < count; ++i)
+    {
+        sums[0] += values[i];
+    }
+    return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+}
+
+// Вызывает handle(offset, length) для непрерывных кусков диапазона
+// логических номеров [begin, end) в кольце длины period
+template <typename Handler>
+void forSpans(uint64_t begin, uint64_t end, std::size_t period, Handler handle)
+{
+    while (begin < end)
+    {
+        const std::size_t offset = begin % period;
+        const std::size_t length =
+            static_cast<std::size_t>(std::min<uint64_t>(end - begin,
+                                                        period - offset));
+        handle(offset, length);
+        begin += length;
+    }
+}
+
+// Номер элемента в отсортированном окне для уровня q
+uint64_t rank(uint64_t count, double q)
+{
+    q = std::clamp(std::isnan(q) ? 0.0 : q, 0.0, 1.0);
+    return static_cast<uint64_t>(std::llround(q * (count - 1)));
+}
+} // namespace
+
+info::MetricHistory::MetricHistory(std::size_t series, std::size_t capacity,
+                                   std::chrono::milliseconds halfLife)
+    : _series(series),
+      _capacity(std::max<std::size_t>((capacity + BLOCK - 1) / BLOCK, 1) *
+                BLOCK),
+      _blocks(_capacity / BLOCK),
+      _halfLife(static_cast<double>(
+          std::chrono::duration_cast<clock::duration>(halfLife).count())),
+      _times(_capacity), _values(_series * _capacity),
+      _blockMin(_series * _blocks), _blockMax(_series * _blocks),
+      _blockSum(_series * _blocks), _runs(_series * _blocks * BLOCK),
+      _runCount(_series * _blocks), _pooledRuns(_blocks),
+      _blockCounts(CODES), _last(_series), _curMin(_series), _curMax(_series),
+      _curSum(_series), _ewma(_series)
+{
+}
+
+std::size_t info::MetricHistory::size() const
+{
+    return static_cast<std::size_t>(std::min<uint64_t>(_total, _capacity));
+}
+
+bool info::MetricHistory::append(clock::time_point time,
+                                 const std::vector<float> &values)
+{
+    if (values.size() != _series)
+    {
+        return false;
+    }
+    for (std::size_t s = 0; s < _series; ++s)
+    {
+        if (std::isfinite(values[s]))
+        {
+            _last[s] = values[s];
+        }
+    }
+    return _append(time);
+}
+
+bool info::MetricHistory::append(clock::time_point time,
+                                 const std::vector<double> &values)
+{
+    if (values.size() != _series)
+    {
+        return false;
+    }
+    for (std::size_t s = 0; s < _series; ++s)
+    {
+        const float value = static_cast<float>(values[s]);
+        if (std::isfinite(value))
+        {
+            _last[s] = value;
+        }
+    }
+    return _append(time);
+}
+
+bool info::MetricHistory::_append(clock::time_point time)
+{
+    const std::size_t slot = _total % _capacity;
+    const int64_t now = time.time_since_epoch().count();
+
+    if (_total % BLOCK == 0)
+    {
+        std::fill(_curMin.begin(), _curMin.end(), INF);
+        std::fill(_curMax.begin(), _curMax.end(), -INF);
+        std::fill(_curSum.begin(), _curSum.end(), 0.0);
+    }
+
+    for (std::size_t s = 0; s < _series; ++s)
+    {
+        _values[s * _capacity + slot] = _last[s];
+    }
+    for (std::size_t s = 0; s < _series; ++s)
+    {
+        const float value = _last[s];
+        _curMin[s] = value < _curMin[s] ? value : _curMin[s];
+        _curMax[s] = value > _curMax[s] ? value : _curMax[s];
+        _curSum[s] += value;
+    }
+
+    // Вес нового значения зависит от времени с предыдущего замера:
+    // через halfLife вклад старых значений уменьшается вдвое
+    if (_total == 0)
+    {
+        std::copy(_last.begin(), _last.end(), _ewma.begin());
+    }
+    else
+    {
+        const double elapsed = static_cast<double>(
+            now - _times[(_total - 1) % _capacity]);
+        const double alpha =
+            _halfLife > 0 ? 1 - std::exp2(-std::max(elapsed, 0.0) / _halfLife)
+                          : 1;
+        for (std::size_t s = 0; s < _series; ++s)
+        {
+            _ewma[s] += alpha * (_last[s] - _ewma[s]);
+        }
+    }
+
+    _times[slot] = now;
+    ++_total;
+    if (_total % BLOCK == 0)
+    {
+        _closeBlock(_total / BLOCK - 1);
+    }
+    return true;
+}
+
+void info::MetricHistory::_closeBlock(uint64_t block)
+{
+    const std::size_t slot = block % _blocks;
+    const std::size_t offset = slot * BLOCK;
+    uint16_t codes[BLOCK];
+    uint32_t low = CODES - 1, high = 0;
+
+    for (std::size_t s = 0; s < _series; ++s)
+    {
+        const std::size_t index = s * _blocks + slot;
+        _blockMin[index] = _curMin[s];
+        _blockMax[index] = _curMax[s];
+        _blockSum[index] = _curSum[s];
+
+        // Гистограмма блока. У медленно меняющихся рядов пар намного
+        // меньше, чем значений
+        const float *values = &_values[s * _capacity + offset];
+        for (std::size_t i = 0; i < BLOCK; ++i)
+        {
+            codes[i] = encode(values[i]);
+        }
+        uint32_t *runs = &_runs[index * BLOCK];
+        const std::size_t count = compress(codes, BLOCK, runs);
+        _runCount[index] = static_cast<uint8_t>(count);
+
+        uint32_t previous = 0;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            _blockCounts[runs[i] >> 16] += (runs[i] & 0xffff) - previous;
+            previous = runs[i] & 0xffff;
+        }
+        low = std::min<uint32_t>(low, runs[0] >> 16);
+        high = std::max<uint32_t>(high, runs[count - 1] >> 16);
+    }
+
+    // Общая гистограмма всех рядов: запрос по всем рядам обходит по одному
+    // куску на блок, а не по куску на каждый ряд
+    std::vector<uint64_t> &pooled = _pooledRuns[slot];
+    pooled.clear();
+    uint64_t total = 0;
+    for (uint32_t code = low; code <= high; ++code)
+    {
+        if (_blockCounts[code] != 0)
+        {
+            total += _blockCounts[code];
+            pooled.push_back((uint64_t(code) << 32) | total);
+            _blockCounts[code] = 0;
+        }
+    }
+}
+
+info::MetricHistory::Range
+info::MetricHistory::_window(clock::duration window) const
+{
+    const uint64_t oldest = _total - size();
+    if (_total == 0)
+    {
+        return {0, 0};
+    }
+    const int64_t newest = _times[(_total - 1) % _capacity];
+    const int64_t span = newest - _times[oldest % _capacity];
+    if (window.count() > span)
+    {
+        return {oldest, _total};
+    }
+    if (window.count() <= 0)
+    {
+        return {_total, _total};
+    }
+    const int64_t threshold = newest - window.count();
+
+    // Первый замер, сделанный позже threshold
+    uint64_t low = oldest, high = _total;
+    while (low < high)
+    {
+        const uint64_t middle = low + (high - low) / 2;
+        if (_times[middle % _capacity] > threshold)
+        {
+            high = middle;
+        }
+        else
+        {
+            low = middle + 1;
+        }
+    }
+    return {low, _total};
+}
+
+info::SeriesStats info::MetricHistory::_stats(std::size_t series,
+                                              Range range) const
+{
+    SeriesStats output;
+    if (range.begin >= range.end)
+    {
+        return output;
+    }
+
+    float min = INF, max = -INF;
+    double sum = 0;
+    const float *values = &_values[series * _capacity];
+
+    // Окно всегда заканчивается последним замером, поэтому незавершенный
+    // блок в конце окна берется из итогов текущего блока целиком, если окно
+    // его покрывает
+    const uint64_t current = _total / BLOCK * BLOCK;
+    uint64_t end = range.end;
+    if (range.begin <= current && current < range.end)
+    {
+        min = _curMin[series];
+        max = _curMax[series];
+        sum = _curSum[series];
+        end = current;
+    }
+
+    // Завершенные блоки внутри окна
+    const uint64_t first = (range.begin + BLOCK - 1) / BLOCK;
+    const uint64_t last = end / BLOCK;
+    if (first < last)
+    {
+        const float *blockMin = &_blockMin[series * _blocks];
+        const float *blockMax = &_blockMax[series * _blocks];
+        const double *blockSum = &_blockSum[series * _blocks];
+        forSpans(first, last, _blocks,
+                 [&](std::size_t offset, std::size_t length)
+                 {
+                     min = reduceMin(blockMin + offset, length, min);
+                     max = reduceMax(blockMax + offset, length, max);
+                     sum = reduceSum(blockSum + offset, length, sum);
+                 });
+        // Значения до первого завершенного блока и после последнего
+        forSpans(range.begin, first * BLOCK, _capacity,
+                 [&](std::size_t offset, std::size_t length)
+                 { reduce(values + offset, length, min, max, sum); });
+        forSpans(last * BLOCK, end, _capacity,
+                 [&](std::size_t offset, std::size_t length)
+                 { reduce(values + offset, length, min, max, sum); });
+    }
+    else
+    {
+        forSpans(range.begin, end, _capacity,
+                 [&](std::size_t offset, std::size_t length)
+                 { reduce(values + offset, length, min, max, sum); });
+    }
+
+    output.count = range.end - range.begin;
+    output.min = min;
+    output.max = max;
+    output.mean = sum / output.count;
+    return output;
+}
+
+void info::MetricHistory::_merge(SeriesStats &into,
+                                 const SeriesStats &part) const
+{
+    if (part.count == 0)
+    {
+        return;
+    }
+    if (into.count == 0)
+    {
+        into = part;
+        return;
+    }
+    const std::size_t count = into.count + part.count;
+    into.mean = (into.mean * into.count + part.mean * part.count) / count;
+    into.min = std::min(into.min, part.min);
+    into.max = std::max(into.max, part.max);
+    into.count = count;
+}
+
+info::SeriesStats info::MetricHistory::stats(std::size_t series,
+                                             clock::duration window) const
+{
+    return series < _series ? _stats(series, _window(window)) : SeriesStats{};
+}
+
+std::vector<info::SeriesStats>
+info::MetricHistory::stats(clock::duration window) const
+{
+    const Range range = _window(window);
+    std::vector<SeriesStats> output(_series);
+    for (std::size_t s = 0; s < _series; ++s)
+    {
+        output[s] = _stats(s, range);
+    }
+    return output;
+}
+
+info::SeriesStats
+info::MetricHistory::pooledStats(clock::duration window) const
+{
+    const Range range = _window(window);
+    SeriesStats output;
+    for (std::size_t s = 0; s < _series; ++s)
+    {
+        _merge(output, _stats(s, range));
+    }
+    return output;
+}
+
+void info::MetricHistory::_addEdge(const float *values,
+                                   std::size_t count) const
+{
+    // Буфер зарезервирован заранее, поэтому указатели в _spans остаются
+    // действительными
+    uint16_t codes[BLOCK];
+    uint32_t runs[BLOCK];
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        codes[i] = encode(values[i]);
+    }
+    const std::size_t pairs = compress(codes, count, runs);
+    const std::size_t offset = _edges.size();
+    _edges.insert(_edges.end(), runs, runs + pairs);
+    _spans.push_back({_edges.data() + offset, pairs});
+}
+
+void info::MetricHistory::_gather(std::size_t series, Range range) const
+{
+    // Значения вне завершенных блоков лежат внутри одного блока, поэтому
+    // непрерывны в кольце
+    const float *values = &_values[series * _capacity];
+    const auto edge = [&](uint64_t begin, uint64_t end)
+    {
+        if (begin < end)
+        {
+            _addEdge(values + begin % _capacity, end - begin);
+        }
+    };
+
+    const uint64_t first = (range.begin + BLOCK - 1) / BLOCK;
+    const uint64_t last = range.end / BLOCK;
+    if (first >= last)
+    {
+        // Окно внутри одного блока или захватывает конец одного и начало
+        // следующего
+        const uint64_t middle =
+            std::clamp(first * BLOCK, range.begin, range.end);
+        edge(range.begin, middle);
+        edge(middle, range.end);
+        return;
+    }
+    edge(range.begin, first * BLOCK);
+    for (uint64_t block = first; block < last; ++block)
+    {
+        const std::size_t index = series * _blocks + block % _blocks;
+        _spans.push_back({&_runs[index * BLOCK], _runCount[index]});
+    }
+    edge(last * BLOCK, range.end);
+}
+
+double info::MetricHistory::_select(uint64_t count, double q,
+                                    const SeriesStats &bounds) const
+{
+    // Куски отсортированы, поэтому количество значений до кода в каждом
+    // считается двоичным поиском
+    const uint16_t code =
+        bisect(encode(static_cast<float>(bounds.min)),
+               encode(static_cast<float>(bounds.max)), rank(count, q),
+               [this](uint16_t middle)
+               {
+                   uint64_t below = 0;
+                   for (const Span &span : _spans)
+                   {
+                       below += countUpTo(span.runs, span.count, middle);
+                   }
+                   return below;
+               });
+
+    // Середина интервала может выйти за крайние значения окна
+    return std::clamp<double>(decode(code), bounds.min, bounds.max);
+}
+
+double info::MetricHistory::quantile(std::size_t series,
+                                     clock::duration window, double q) const
+{
+    const Range range = _window(window);
+    const uint64_t count = range.end - range.begin;
+    if (series >= _series || count == 0)
+    {
+        return 0;
+    }
+
+    if (count <= EXACT_LIMIT)
+    {
+        const float *values = &_values[series * _capacity];
+        _scratch.clear();
+        forSpans(range.begin, range.end, _capacity,
+                 [&](std::size_t offset, std::size_t length)
+                 {
+                     _scratch.insert(_scratch.end(), values + offset,
+                                     values + offset + length);
+                 });
+        auto nth = _scratch.begin() + rank(count, q);
+        std::nth_element(_scratch.begin(), nth, _scratch.end());
+        return *nth;
+    }
+
+    _spans.clear();
+    _edges.clear();
+    _edges.reserve(2 * BLOCK);
+    _gather(series, range);
+    return _select(count, q, _stats(series, range));
+}
+
+std::vector<double> info::MetricHistory::quantiles(clock::duration window,
+                                                   double q) const
+{
+    std::vector<double> output(_series);
+    for (std::size_t s = 0; s < _series; ++s)
+    {
+        output[s] = quantile(s, window, q);
+    }
+    return output;
+}
+
+double info::MetricHistory::pooledQuantile(clock::duration window,
+                                           double q) const
+{
+    const Range range = _window(window);
+    const uint64_t count = (range.end - range.begin) * _series;
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    if (count <= EXACT_LIMIT)
+    {
+        _scratch.clear();
+        for (std::size_t s = 0; s < _series; ++s)
+        {
+            const float *values = &_values[s * _capacity];
+            forSpans(range.begin, range.end, _capacity,
+                     [&](std::size_t offset, std::size_t length)
+                     {
+                         _scratch.insert(_scratch.end(), values + offset,
+                                         values + offset + length);
+                     });
+        }
+        auto nth = _scratch.begin() + rank(count, q);
+        std::nth_element(_scratch.begin(), nth, _scratch.end());
+        return *nth;
+    }
+
+    SeriesStats bounds;
+    for (std::size_t s = 0; s < _series; ++s)
+    {
+        _merge(bounds, _stats(s, range));
+    }
+    const uint16_t low = encode(static_cast<float>(bounds.min));
+    const uint16_t high = encode(static_cast<float>(bounds.max));
+
+    // Значения вне завершенных блоков собираются в таблицу накопленных
+    // количеств по кодам. Таблица обнуляется только в диапазоне кодов окна
+    uint64_t first = (range.begin + BLOCK - 1) / BLOCK;
+    uint64_t last = range.end / BLOCK;
+    if (first >= last)
+    {
+        first = last = 0;
+    }
+    _histogram.resize(CODES);
+    const auto edge = [this](const float *values, uint64_t begin, uint64_t end)
+    {
+        forSpans(begin, end, _capacity,
+                 [&](std::size_t offset, std::size_t length)
+                 {
+                     for (std::size_t i = 0; i < length; ++i)
+                     {
+                         ++_histogram[encode(values[offset + i])];
+                     }
+                 });
+    };
+    for (std::size_t s = 0; s < _series; ++s)
+    {
+        const float *values = &_values[s * _capacity];
+        if (first < last)
+        {
+            edge(values, range.begin, first * BLOCK);
+            edge(values, last * BLOCK, range.end);
+        }
+        else
+        {
+            edge(values, range.begin, range.end);
+        }
+    }
+    for (uint32_t code = low + 1; code <= high; ++code)
+    {
+        _histogram[code] += _histogram[code - 1];
+    }
+
+    const uint16_t code = bisect(
+        low, high, rank(count, q),
+        [&](uint16_t middle)
+        {
+            uint64_t below = _histogram[middle];
+            for (uint64_t block = first; block < last; ++block)
+            {
+                const auto &runs = _pooledRuns[block % _blocks];
+                below += countUpTo(runs.data(), runs.size(), middle);
+            }
+            return below;
+        });
+    std::fill(_histogram.begin() + low, _histogram.begin() + high + 1, 0);
+
+    // Середина интервала может выйти за крайние значения окна
+    return std::clamp<double>(decode(code), bounds.min, bounds.max);
+}
+
+double info::MetricHistory::ewma(std::size_t series) const
+{
+    return series < _series ? _ewma[series] : 0;
+}
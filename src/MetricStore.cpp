@@ -0,0 +1,799 @@
+#include <MetricStore.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace info
+{
+/**
+ * @brief Заголовок файла-сегмента
+ *
+ * @details За заголовком лежат таблица рядов (байт SeriesKind, имя и
+ * завершающий ноль для каждого ряда), индекс блоков и сжатые данные.
+ * Смещения отсчитываются от начала файла
+ */
+struct MetricSegment
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t seriesCount;
+    uint64_t size; ///< Размер файла
+    uint32_t tableOffset;
+    uint32_t indexOffset;
+    uint32_t indexCapacity; ///< Максимальное количество блоков
+    uint32_t dataOffset;
+
+    /**
+     * @brief Количество начатых блоков
+     */
+    std::atomic<uint32_t> blocks;
+    uint32_t reserved;
+
+    /**
+     * @brief Время последнего записанного замера, в мс от эпохи Unix
+     */
+    std::atomic<int64_t> lastTime;
+};
+} // namespace info
+
+namespace
+{
+constexpr char MAGIC[8] = {'S', 'P', 'T', 'S', 'D', 'B', 0, 0};
+constexpr uint32_t VERSION = 1;
+constexpr uint8_t NO_WINDOW = 0xff;
+
+// Наибольший размер замера: время и по 80 бит на значение (varint из
+// десяти групп)
+constexpr uint64_t TIME_MAX_BITS = 68;
+constexpr uint64_t VALUE_MAX_BITS = 80;
+
+/**
+ * @brief Запись индекса блоков
+ */
+struct BlockEntry
+{
+    int64_t firstTime; ///< Время первого замера, в мс от эпохи Unix
+    uint32_t offset;   ///< Начало сжатых данных блока
+    uint32_t reserved;
+
+    /**
+     * @brief Количество записанных замеров (старшие 32 бита) и длина их
+     * сжатых данных в битах (младшие 32 бита). Обновляется одной атомарной
+     * записью после каждого замера, поэтому читатель видит только целые
+     * замеры
+     */
+    std::atomic<uint64_t> committed;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "индекс в отображенном файле требует атомиков без блокировок");
+
+using info::MetricSegment;
+using info::SeriesKind;
+
+uint64_t align8(uint64_t value) { return (value + 7) & ~uint64_t{7}; }
+
+BlockEntry *blockIndex(const MetricSegment *segment)
+{
+    return reinterpret_cast<BlockEntry *>(
+        const_cast<char *>(reinterpret_cast<const char *>(segment)) +
+        segment->indexOffset);
+}
+
+uint64_t zigzag(int64_t value)
+{
+    return (static_cast<uint64_t>(value) << 1) ^
+           static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value)
+{
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+// Биты пишутся начиная со старшего. Файл создается заполненным нулями,
+// поэтому запись выполняется через ИЛИ
+class BitWriter
+{
+  public:
+    BitWriter(uint8_t *data, uint64_t bits) : _data(data), _bits(bits) {}
+
+    void write(uint64_t value, unsigned count)
+    {
+        while (count)
+        {
+            const unsigned space = 8 - (_bits & 7);
+            const unsigned take = std::min(space, count);
+            const uint8_t chunk =
+                (value >> (count - take)) & ((1u << take) - 1);
+            _data[_bits >> 3] |= chunk << (space - take);
+            _bits += take;
+            count -= take;
+        }
+    }
+
+    void writeVarint(uint64_t value)
+    {
+        do
+        {
+            const uint64_t group = value & 0x7f;
+            value >>= 7;
+            write(group | (value ? 0x80 : 0), 8);
+        } while (value);
+    }
+
+    uint64_t bits() const { return _bits; }
+
+  private:
+    uint8_t *_data;
+    uint64_t _bits;
+};
+
+class BitReader
+{
+  public:
+    BitReader(const uint8_t *data, uint64_t limit) : _data(data), _limit(limit)
+    {
+    }
+
+    uint64_t read(unsigned count)
+    {
+        if (_bits + count > _limit)
+        {
+            _overrun = true;
+            _bits = _limit;
+            return 0;
+        }
+        uint64_t value = 0;
+        while (count)
+        {
+            const unsigned space = 8 - (_bits & 7);
+            const unsigned take = std::min(space, count);
+            const uint8_t chunk =
+                (_data[_bits >> 3] >> (space - take)) & ((1u << take) - 1);
+            value = (value << take) | chunk;
+            _bits += take;
+            count -= take;
+        }
+        return value;
+    }
+
+    uint64_t readVarint()
+    {
+        uint64_t value = 0;
+        for (unsigned shift = 0; shift < 70 && !_overrun; shift += 7)
+        {
+            const uint64_t group = read(8);
+            value |= (group & 0x7f) << shift;
+            if (!(group & 0x80))
+            {
+                break;
+            }
+        }
+        return value;
+    }
+
+    bool overrun() const { return _overrun; }
+
+  private:
+    const uint8_t *_data;
+    uint64_t _limit;
+    uint64_t _bits{0};
+    bool _overrun{false};
+};
+
+// Разность второго порядка: при равномерном опросе почти всегда ноль
+void writeTimeDelta(BitWriter &writer, int64_t dod)
+{
+    const uint64_t value = zigzag(dod);
+    if (value == 0)
+    {
+        writer.write(0, 1);
+    }
+    else if (value < (1u << 7))
+    {
+        writer.write(0b10, 2);
+        writer.write(value, 7);
+    }
+    else if (value < (1u << 12))
+    {
+        writer.write(0b110, 3);
+        writer.write(value, 12);
+    }
+    else if (value < (1u << 20))
+    {
+        writer.write(0b1110, 4);
+        writer.write(value, 20);
+    }
+    else
+    {
+        writer.write(0b1111, 4);
+        writer.write(value, 64);
+    }
+}
+
+int64_t readTimeDelta(BitReader &reader)
+{
+    unsigned prefix = 0;
+    while (prefix < 4 && reader.read(1))
+    {
+        ++prefix;
+    }
+    static constexpr unsigned WIDTHS[] = {0, 7, 12, 20, 64};
+    return prefix ? unzigzag(reader.read(WIDTHS[prefix])) : 0;
+}
+
+// Значение-уровень: XOR с предыдущим. Если значащие биты помещаются в окно
+// предыдущего значения, окно не записывается заново
+void writeGauge(BitWriter &writer, uint64_t bits, uint64_t previous,
+                uint8_t &leading, uint8_t &trailing)
+{
+    const uint64_t xored = bits ^ previous;
+    if (xored == 0)
+    {
+        writer.write(0, 1);
+        return;
+    }
+    const unsigned lead = std::min(__builtin_clzll(xored), 31);
+    const unsigned trail = __builtin_ctzll(xored);
+    if (leading != NO_WINDOW && lead >= leading && trail >= trailing)
+    {
+        writer.write(0b10, 2);
+        writer.write(xored >> trailing, 64 - leading - trailing);
+        return;
+    }
+    leading = lead;
+    trailing = trail;
+    const unsigned meaningful = 64 - lead - trail;
+    writer.write(0b11, 2);
+    writer.write(lead, 5);
+    writer.write(meaningful - 1, 6);
+    writer.write(xored >> trail, meaningful);
+}
+
+uint64_t readGauge(BitReader &reader, uint64_t previous, uint8_t &leading,
+                   uint8_t &trailing)
+{
+    if (!reader.read(1))
+    {
+        return previous;
+    }
+    if (reader.read(1))
+    {
+        leading = reader.read(5);
+        const unsigned meaningful = reader.read(6) + 1;
+        trailing = 64 - leading - std::min(meaningful, 64u - leading);
+    }
+    if (leading == NO_WINDOW)
+    {
+        // Поврежденные данные: окно не было задано
+        return previous;
+    }
+    const unsigned width = 64 - leading - trailing;
+    return previous ^ (reader.read(width) << trailing);
+}
+
+uint64_t gaugeBits(double value)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double gaugeValue(uint64_t bits)
+{
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+int64_t counterValue(double value)
+{
+    if (!std::isfinite(value) || std::fabs(value) >= 9.2e18)
+    {
+        return 0;
+    }
+    return std::llround(value);
+}
+
+int64_t toMilliseconds(std::chrono::system_clock::time_point time)
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               time.time_since_epoch())
+        .count();
+}
+
+// Номера сегментов директории по возрастанию. Имя сегмента - 16 цифр
+// номера и расширение .seg
+std::vector<uint64_t> listSegments(const std::string &directory)
+{
+    std::vector<uint64_t> output;
+    DIR *dir = opendir(directory.c_str());
+    if (!dir)
+    {
+        return output;
+    }
+    while (dirent *entry = readdir(dir))
+    {
+        const char *name = entry->d_name;
+        if (std::strlen(name) == 20 && std::strcmp(name + 16, ".seg") == 0 &&
+            std::all_of(name, name + 16,
+                        [](char c) { return c >= '0' && c <= '9'; }))
+        {
+            output.push_back(std::strtoull(name, nullptr, 10));
+        }
+    }
+    closedir(dir);
+    std::sort(output.begin(), output.end());
+    return output;
+}
+
+std::string segmentPath(const std::string &directory, uint64_t number)
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "/%016llu.seg",
+                  static_cast<unsigned long long>(number));
+    return directory + name;
+}
+
+// Таблица рядов сегмента. Пустая, если таблица выходит за границы файла
+std::vector<info::SeriesSpec> readTable(const MetricSegment *segment)
+{
+    std::vector<info::SeriesSpec> output;
+    const char *base = reinterpret_cast<const char *>(segment);
+    const char *pos = base + segment->tableOffset;
+    const char *end = base + segment->indexOffset;
+    for (uint32_t i = 0; i < segment->seriesCount; ++i)
+    {
+        const char *nul =
+            pos < end ? static_cast<const char *>(
+                            std::memchr(pos + 1, '\0', end - pos - 1))
+                      : nullptr;
+        if (!nul)
+        {
+            return {};
+        }
+        output.push_back({std::string(pos + 1, nul),
+                          static_cast<SeriesKind>(*pos & 1)});
+        pos = nul + 1;
+    }
+    return output;
+}
+
+// Отображение сегмента только для чтения
+class MappedSegment
+{
+  public:
+    explicit MappedSegment(const std::string &path)
+    {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            return;
+        }
+        struct stat status;
+        if (fstat(fd, &status) != 0 ||
+            static_cast<std::size_t>(status.st_size) < sizeof(MetricSegment))
+        {
+            close(fd);
+            return;
+        }
+        void *memory =
+            mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (memory == MAP_FAILED)
+        {
+            return;
+        }
+        _size = status.st_size;
+        auto segment = static_cast<const MetricSegment *>(memory);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (std::memcmp(segment->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+            segment->version != VERSION || segment->size != _size ||
+            segment->tableOffset > segment->indexOffset ||
+            segment->indexOffset +
+                    uint64_t{segment->indexCapacity} * sizeof(BlockEntry) >
+                segment->dataOffset ||
+            segment->dataOffset > _size)
+        {
+            munmap(memory, _size);
+            return;
+        }
+        _segment = segment;
+    }
+
+    ~MappedSegment()
+    {
+        if (_segment)
+        {
+            munmap(const_cast<MetricSegment *>(_segment), _size);
+        }
+    }
+
+    MappedSegment(const MappedSegment &) = delete;
+    MappedSegment &operator=(const MappedSegment &) = delete;
+
+    const MetricSegment *get() const { return _segment; }
+    std::size_t size() const { return _size; }
+
+  private:
+    const MetricSegment *_segment{nullptr};
+    std::size_t _size{0};
+};
+
+// Распаковывает блок и добавляет значения ряда target из [from, to)
+void decodeBlock(const MappedSegment &mapped, const BlockEntry &block,
+                 const std::vector<info::SeriesSpec> &table,
+                 std::size_t target, int64_t from, int64_t to,
+                 std::vector<info::MetricPoint> &out)
+{
+    const uint64_t committed = block.committed.load(std::memory_order_acquire);
+    const uint32_t samples = committed >> 32;
+    const uint64_t bits = committed & 0xffffffff;
+    if (block.offset < mapped.get()->dataOffset ||
+        block.offset + (bits + 7) / 8 > mapped.size())
+    {
+        return;
+    }
+
+    BitReader reader(
+        reinterpret_cast<const uint8_t *>(mapped.get()) + block.offset, bits);
+    std::vector<uint64_t> previous(table.size(), 0);
+    std::vector<uint8_t> leading(table.size(), NO_WINDOW);
+    std::vector<uint8_t> trailing(table.size(), 0);
+    int64_t time = 0, delta = 0;
+
+    for (uint32_t sample = 0; sample < samples && !reader.overrun(); ++sample)
+    {
+        if (sample == 0)
+        {
+            time = static_cast<int64_t>(reader.read(64));
+        }
+        else
+        {
+            delta += readTimeDelta(reader);
+            time += delta;
+        }
+        for (std::size_t i = 0; i < table.size(); ++i)
+        {
+            if (table[i].kind == SeriesKind::Counter)
+            {
+                // Приращение в дополнительном коде, переполнение ожидаемо
+                const uint64_t value = static_cast<uint64_t>(
+                    unzigzag(reader.readVarint()));
+                previous[i] = sample == 0 ? value : previous[i] + value;
+            }
+            else
+            {
+                previous[i] =
+                    sample == 0 ? reader.read(64)
+                                : readGauge(reader, previous[i], leading[i],
+                                            trailing[i]);
+            }
+        }
+        if (time >= to)
+        {
+            break;
+        }
+        if (time >= from && !reader.overrun())
+        {
+            const double value =
+                table[target].kind == SeriesKind::Counter
+                    ? static_cast<double>(
+                          static_cast<int64_t>(previous[target]))
+                    : gaugeValue(previous[target]);
+            out.push_back({std::chrono::system_clock::time_point(
+                               std::chrono::duration_cast<
+                                   std::chrono::system_clock::duration>(
+                                   std::chrono::milliseconds(time))),
+                           value});
+        }
+    }
+}
+} // namespace
+
+info::MetricStore::MetricStore(std::string directory,
+                               std::vector<SeriesSpec> series,
+                               MetricStoreOptions options)
+    : _directory(std::move(directory)), _series(std::move(series)),
+      _options(options), _previous(_series.size()),
+      _leading(_series.size()), _trailing(_series.size())
+{
+    _options.maxSegments = std::max<std::size_t>(_options.maxSegments, 1);
+    if (mkdir(_directory.c_str(), 0755) != 0 && errno != EEXIST)
+    {
+        return;
+    }
+    auto existing = listSegments(_directory);
+    _number = existing.empty() ? 0 : existing.back();
+    _openSegment();
+}
+
+info::MetricStore::~MetricStore() { _closeSegment(); }
+
+bool info::MetricStore::_openSegment()
+{
+    ++_number;
+    _samples = 0;
+
+    // Таблица рядов, индекс (1/16 от остатка файла) и данные
+    uint64_t table = 0;
+    for (const auto &spec : _series)
+    {
+        table += spec.name.size() + 2;
+    }
+    const uint64_t size = _options.segmentSize;
+    const uint64_t indexOffset = align8(sizeof(MetricSegment) + table);
+    if (indexOffset >= size || size > UINT32_MAX)
+    {
+        return false;
+    }
+    const uint64_t capacity =
+        std::max<uint64_t>((size - indexOffset) / (16 * sizeof(BlockEntry)), 1);
+    const uint64_t dataOffset =
+        align8(indexOffset + capacity * sizeof(BlockEntry));
+    if (dataOffset + (TIME_MAX_BITS + VALUE_MAX_BITS * _series.size()) / 8 + 1 >
+        size)
+    {
+        return false;
+    }
+
+    const std::string path = segmentPath(_directory, _number);
+    int fd = open(path.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        return false;
+    }
+    if (ftruncate(fd, size) != 0)
+    {
+        close(fd);
+        unlink(path.c_str());
+        return false;
+    }
+    void *memory =
+        mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED)
+    {
+        unlink(path.c_str());
+        return false;
+    }
+
+    _segment = static_cast<MetricSegment *>(memory);
+    _segment->version = VERSION;
+    _segment->seriesCount = _series.size();
+    _segment->size = size;
+    _segment->tableOffset = sizeof(MetricSegment);
+    _segment->indexOffset = indexOffset;
+    _segment->indexCapacity = capacity;
+    _segment->dataOffset = dataOffset;
+    _segment->blocks.store(0, std::memory_order_relaxed);
+    _segment->lastTime.store(0, std::memory_order_relaxed);
+    char *pos = static_cast<char *>(memory) + _segment->tableOffset;
+    for (const auto &spec : _series)
+    {
+        *pos++ = static_cast<char>(spec.kind);
+        std::memcpy(pos, spec.name.c_str(), spec.name.size() + 1);
+        pos += spec.name.size() + 1;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(_segment->magic, MAGIC, sizeof(MAGIC));
+
+    _removeOld();
+    return true;
+}
+
+void info::MetricStore::_closeSegment()
+{
+    if (_segment)
+    {
+        // Данные и так попадут в файл, даже если процесс завершится
+        // аварийно. msync лишь ускоряет запись на диск
+        msync(_segment, _options.segmentSize, MS_ASYNC);
+        munmap(_segment, _options.segmentSize);
+        _segment = nullptr;
+    }
+}
+
+void info::MetricStore::_removeOld()
+{
+    auto existing = listSegments(_directory);
+    for (std::size_t i = 0; i + _options.maxSegments < existing.size(); ++i)
+    {
+        unlink(segmentPath(_directory, existing[i]).c_str());
+    }
+}
+
+bool info::MetricStore::append(std::chrono::system_clock::time_point time,
+                               const std::vector<double> &values)
+{
+    if (!_segment || values.size() != _series.size())
+    {
+        return false;
+    }
+
+    int64_t ms = toMilliseconds(time);
+    if (_samples > 0)
+    {
+        ms = std::max(ms, _lastTime);
+    }
+
+    const uint64_t worst = TIME_MAX_BITS + VALUE_MAX_BITS * _series.size();
+    BlockEntry *index = blockIndex(_segment);
+
+    // Новый блок начинается, если текущий заполнен или в сегменте не
+    // осталось места под замер наихудшего размера
+    bool fresh = _samples == 0 || _samples == BLOCK_SAMPLES;
+    uint64_t offset = _samples ? index[_block].offset + (_bits + 7) / 8
+                               : _segment->dataOffset;
+    if (!fresh && index[_block].offset + (_bits + worst + 7) / 8 >
+                      _options.segmentSize)
+    {
+        fresh = true;
+    }
+    if (fresh)
+    {
+        const uint32_t blocks = _segment->blocks.load(std::memory_order_relaxed);
+        if (blocks == _segment->indexCapacity ||
+            offset + (worst + 7) / 8 > _options.segmentSize)
+        {
+            _closeSegment();
+            if (!_openSegment())
+            {
+                return false;
+            }
+            offset = _segment->dataOffset;
+            index = blockIndex(_segment);
+        }
+        _block = _segment->blocks.load(std::memory_order_relaxed);
+        index[_block].firstTime = ms;
+        index[_block].offset = offset;
+        index[_block].committed.store(0, std::memory_order_relaxed);
+        _segment->blocks.store(_block + 1, std::memory_order_release);
+        _samples = 0;
+        _bits = 0;
+    }
+
+    BitWriter writer(reinterpret_cast<uint8_t *>(_segment) +
+                         index[_block].offset,
+                     _bits);
+    if (_samples == 0)
+    {
+        writer.write(static_cast<uint64_t>(ms), 64);
+        _lastDelta = 0;
+    }
+    else
+    {
+        const int64_t delta = ms - _lastTime;
+        writeTimeDelta(writer, delta - _lastDelta);
+        _lastDelta = delta;
+    }
+    _lastTime = ms;
+
+    for (std::size_t i = 0; i < _series.size(); ++i)
+    {
+        if (_series[i].kind == SeriesKind::Counter)
+        {
+            const uint64_t value =
+                static_cast<uint64_t>(counterValue(values[i]));
+            writer.writeVarint(zigzag(static_cast<int64_t>(
+                _samples == 0 ? value : value - _previous[i])));
+            _previous[i] = value;
+        }
+        else
+        {
+            const uint64_t bits = gaugeBits(values[i]);
+            if (_samples == 0)
+            {
+                writer.write(bits, 64);
+                _leading[i] = NO_WINDOW;
+            }
+            else
+            {
+                writeGauge(writer, bits, _previous[i], _leading[i],
+                           _trailing[i]);
+            }
+            _previous[i] = bits;
+        }
+    }
+
+    _bits = writer.bits();
+    ++_samples;
+    index[_block].committed.store((uint64_t{_samples} << 32) | _bits,
+                                  std::memory_order_release);
+    _segment->lastTime.store(ms, std::memory_order_release);
+    return true;
+}
+
+info::MetricStoreReader::MetricStoreReader(std::string directory)
+    : _directory(std::move(directory))
+{
+}
+
+std::vector<std::string> info::MetricStoreReader::series() const
+{
+    std::vector<std::string> output;
+    for (uint64_t number : listSegments(_directory))
+    {
+        MappedSegment mapped(segmentPath(_directory, number));
+        if (!mapped.get())
+        {
+            continue;
+        }
+        for (const auto &spec : readTable(mapped.get()))
+        {
+            if (std::find(output.begin(), output.end(), spec.name) ==
+                output.end())
+            {
+                output.push_back(spec.name);
+            }
+        }
+    }
+    return output;
+}
+
+std::vector<info::MetricPoint>
+info::MetricStoreReader::query(const std::string &series,
+                               std::chrono::system_clock::time_point from,
+                               std::chrono::system_clock::time_point to) const
+{
+    std::vector<MetricPoint> output;
+    const int64_t fromMs = toMilliseconds(from), toMs = toMilliseconds(to);
+
+    for (uint64_t number : listSegments(_directory))
+    {
+        // Писатель мог удалить сегмент между чтением директории и open
+        MappedSegment mapped(segmentPath(_directory, number));
+        const MetricSegment *segment = mapped.get();
+        if (!segment)
+        {
+            continue;
+        }
+        const uint32_t blocks = std::min(
+            segment->blocks.load(std::memory_order_acquire),
+            segment->indexCapacity);
+        const BlockEntry *index = blockIndex(segment);
+        if (blocks == 0 ||
+            segment->lastTime.load(std::memory_order_acquire) < fromMs ||
+            index[0].firstTime >= toMs)
+        {
+            continue;
+        }
+
+        const auto table = readTable(segment);
+        auto found = std::find_if(table.begin(), table.end(),
+                                  [&](const SeriesSpec &spec)
+                                  { return spec.name == series; });
+        if (found == table.end())
+        {
+            continue;
+        }
+
+        // Последний блок, начавшийся не позже from: в нем могут быть
+        // замеры из интервала
+        const BlockEntry *first = std::upper_bound(
+            index, index + blocks, fromMs,
+            [](int64_t value, const BlockEntry &block)
+            { return value < block.firstTime; });
+        if (first != index)
+        {
+            --first;
+        }
+        for (const BlockEntry *block = first;
+             block != index + blocks && block->firstTime < toMs; ++block)
+        {
+            decodeBlock(mapped, *block, table, found - table.begin(), fromMs,
+                        toMs, output);
+        }
+    }
+    return output;
+}
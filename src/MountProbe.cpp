@@ -0,0 +1,350 @@
+#include <MountProbe.hpp>
+#include <ProbeTelemetry.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <condition_variable>
+#include <cstring>
+#include <sys/statvfs.h>
+#include <thread>
+
+namespace
+{
+// Больше потоков не ускоряет опрос локальных файловых систем, а зависшие
+// потоки заменяются новыми
+constexpr std::size_t MAX_WORKERS = 8;
+
+// Весь опрос длится не дольше стольких mountTimeout: иначе десятки точек
+// одного зависшего сервера задержали бы вызов на их количество, деленное на
+// MAX_WORKERS, таймаутов
+constexpr int CALL_TIMEOUTS = 2;
+
+// Формат записи statvfs: байт MountStatus, затем struct statvfs для Ok
+std::string captureKey(const std::string &mountPoint)
+{
+    return "statvfs:" + mountPoint;
+}
+
+// В mountinfo пробелы, табуляции, переводы строк и обратная косая черта
+// записываются восьмеричными последовательностями (\040)
+std::string unescape(const char *begin, const char *end)
+{
+    std::string output;
+    output.reserve(end - begin);
+    for (const char *pos = begin; pos < end; ++pos)
+    {
+        if (*pos == '\\' && end - pos >= 4 && pos[1] >= '0' && pos[1] <= '3')
+        {
+            output += static_cast<char>((pos[1] - '0') * 64 +
+                                        (pos[2] - '0') * 8 + (pos[3] - '0'));
+            pos += 3;
+        }
+        else
+        {
+            output += *pos;
+        }
+    }
+    return output;
+}
+
+void fillSizes(info::MountInfo &mount, const struct statvfs &st)
+{
+    mount.capacity = static_cast<uint64_t>(st.f_blocks) * st.f_frsize;
+    mount.freeSpace = static_cast<uint64_t>(st.f_bfree) * st.f_frsize;
+    mount.available = static_cast<uint64_t>(st.f_bavail) * st.f_frsize;
+    mount.inodes = st.f_files;
+    mount.freeInodes = st.f_ffree;
+}
+
+bool matches(const info::MountFilter &filter, const std::string &fstype)
+{
+    auto contains = [&fstype](const std::vector<std::string> &list)
+    { return std::find(list.begin(), list.end(), fstype) != list.end(); };
+    return (filter.fstypes.empty() || contains(filter.fstypes)) &&
+           !contains(filter.excludeFstypes);
+}
+} // namespace
+
+/**
+ * @brief Общее состояние одного опроса, разделяемое с рабочими потоками
+ *
+ * @details Живет, пока его держит хотя бы один поток, поэтому зависший
+ * поток может вернуться и после того, как вызывающий перестал ждать
+ */
+struct info::MountProbe::Batch
+{
+    enum State
+    {
+        Pending,
+        Running,
+        Done,
+        Failed
+    };
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<std::string> paths;
+    std::vector<State> states;
+    std::vector<struct statvfs> results;
+    std::vector<std::chrono::steady_clock::time_point> started;
+    std::vector<std::shared_ptr<std::atomic<bool>>> returned;
+    std::size_t next{0};
+    bool abandoned{false};
+
+    static void work(std::shared_ptr<Batch> batch)
+    {
+        std::unique_lock lock(batch->mutex);
+        while (!batch->abandoned && batch->next < batch->paths.size())
+        {
+            const std::size_t i = batch->next++;
+            batch->states[i] = Running;
+            batch->started[i] = std::chrono::steady_clock::now();
+            const std::string path = batch->paths[i];
+            lock.unlock();
+
+            struct statvfs st;
+            const bool ok = statvfs(path.c_str(), &st) == 0;
+
+            lock.lock();
+            batch->results[i] = st;
+            batch->states[i] = ok ? Done : Failed;
+            batch->returned[i]->store(true);
+            batch->changed.notify_all();
+        }
+    }
+};
+
+info::MountProbe::MountProbe(ProbeSource &source,
+                             std::chrono::milliseconds timeout)
+    : _source(source), _timeout(timeout)
+{
+}
+
+std::vector<info::MountInfo>
+info::MountProbe::parseMountInfo(const std::string &raw)
+{
+    std::vector<MountInfo> output;
+    std::unordered_map<std::string, std::size_t> byMountPoint;
+    std::vector<std::pair<const char *, const char *>> fields;
+
+    const char *pos = raw.data(), *end = raw.data() + raw.size();
+    while (pos < end)
+    {
+        const char *eol =
+            static_cast<const char *>(std::memchr(pos, '\n', end - pos));
+        eol = eol ? eol : end;
+
+        // 36 35 98:0 /mnt1 /mnt2 rw,noatime master:1 - ext3 /dev/root rw
+        // Поля до "-" фиксированы, кроме необязательных тегов после опций
+        fields.clear();
+        for (const char *field = pos; field < eol;)
+        {
+            const char *space = static_cast<const char *>(
+                std::memchr(field, ' ', eol - field));
+            space = space ? space : eol;
+            fields.emplace_back(field, space);
+            field = space + 1;
+        }
+
+        std::size_t separator = 6;
+        while (separator < fields.size() &&
+               !(fields[separator].second - fields[separator].first == 1 &&
+                 *fields[separator].first == '-'))
+        {
+            ++separator;
+        }
+        if (separator + 2 < fields.size())
+        {
+            MountInfo mount{};
+            mount.mountPoint = unescape(fields[4].first, fields[4].second);
+            mount.readOnly = std::strncmp(fields[5].first, "ro", 2) == 0 &&
+                             (fields[5].second - fields[5].first == 2 ||
+                              fields[5].first[2] == ',');
+            mount.filesystem.assign(fields[separator + 1].first,
+                                    fields[separator + 1].second);
+            mount.source = unescape(fields[separator + 2].first,
+                                    fields[separator + 2].second);
+            mount.status = MountStatus::Failed;
+
+            // Перемонтированная поверх точка скрывает предыдущую
+            auto [it, inserted] =
+                byMountPoint.emplace(mount.mountPoint, output.size());
+            if (!inserted)
+            {
+                output[it->second].mountPoint.clear();
+                it->second = output.size();
+            }
+            output.push_back(std::move(mount));
+        }
+
+        pos = eol + 1;
+    }
+
+    output.erase(std::remove_if(output.begin(), output.end(),
+                                [](const MountInfo &mount)
+                                { return mount.mountPoint.empty(); }),
+                 output.end());
+    return output;
+}
+
+std::vector<info::MountInfo> info::MountProbe::sample(const MountFilter &filter)
+{
+    std::lock_guard lock(_mutex);
+
+    if (!_source.readFile("/proc/self/mountinfo", _buffer))
+    {
+        return {};
+    }
+    auto mounts = parseMountInfo(_buffer);
+    mounts.erase(std::remove_if(mounts.begin(), mounts.end(),
+                                [&filter](const MountInfo &mount)
+                                { return !matches(filter, mount.filesystem); }),
+                 mounts.end());
+
+    if (_source.replaying())
+    {
+        _replay(mounts);
+    }
+    else
+    {
+        _stat(mounts);
+    }
+    return mounts;
+}
+
+void info::MountProbe::_replay(std::vector<MountInfo> &mounts)
+{
+    std::string raw;
+    for (auto &mount : mounts)
+    {
+        if (!_source.replay(CaptureKind::Syscall, captureKey(mount.mountPoint),
+                            raw) ||
+            raw.empty())
+        {
+            continue;
+        }
+        mount.status = static_cast<MountStatus>(raw[0]);
+        if (mount.status == MountStatus::Ok &&
+            raw.size() == 1 + sizeof(struct statvfs))
+        {
+            struct statvfs st;
+            std::memcpy(&st, raw.data() + 1, sizeof(st));
+            fillSizes(mount, st);
+        }
+    }
+}
+
+void info::MountProbe::_stat(std::vector<MountInfo> &mounts)
+{
+    using clock = std::chrono::steady_clock;
+
+    // Точки, для которых еще висит statvfs с прошлых вызовов, не опрашиваем
+    auto batch = std::make_shared<Batch>();
+    std::vector<std::size_t> slots(mounts.size(), SIZE_MAX);
+    for (std::size_t i = 0; i < mounts.size(); ++i)
+    {
+        auto hung = _hung.find(mounts[i].mountPoint);
+        if (hung != _hung.end())
+        {
+            if (!hung->second->load())
+            {
+                continue;
+            }
+            _hung.erase(hung);
+        }
+        slots[i] = batch->paths.size();
+        batch->paths.push_back(_source.path(mounts[i].mountPoint));
+    }
+
+    const std::size_t count = batch->paths.size();
+    batch->states.assign(count, Batch::Pending);
+    batch->results.resize(count);
+    batch->started.resize(count);
+    batch->returned.resize(count);
+    for (auto &flag : batch->returned)
+    {
+        flag = std::make_shared<std::atomic<bool>>(false);
+    }
+
+    std::size_t workers = 0;
+    const auto callDeadline = clock::now() + CALL_TIMEOUTS * _timeout;
+    std::unique_lock lock(batch->mutex);
+    while (count != 0)
+    {
+        const auto now = clock::now();
+        if (now >= callDeadline)
+        {
+            // Оставшиеся точки не опрашиваются и помечаются TimedOut
+            break;
+        }
+        auto deadline = callDeadline;
+        std::size_t pending = 0, active = 0, stuck = 0;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (batch->states[i] == Batch::Pending)
+            {
+                ++pending;
+            }
+            else if (batch->states[i] == Batch::Running)
+            {
+                if (now - batch->started[i] >= _timeout)
+                {
+                    ++stuck;
+                }
+                else
+                {
+                    ++active;
+                    deadline = std::min(deadline, batch->started[i] + _timeout);
+                }
+            }
+        }
+        if (pending == 0 && active == 0)
+        {
+            break;
+        }
+
+        // Поток, чей statvfs превысил время ожидания, считается потерянным,
+        // вместо него запускается новый
+        while (workers - stuck < std::min(MAX_WORKERS, pending + active))
+        {
+            std::thread(Batch::work, batch).detach();
+            ++workers;
+        }
+        batch->changed.wait_until(lock, deadline);
+    }
+    batch->abandoned = true;
+
+    ProbeTelemetry::addSyscalls(count);
+    std::string raw;
+    for (std::size_t i = 0; i < mounts.size(); ++i)
+    {
+        auto &mount = mounts[i];
+        const std::size_t j = slots[i];
+        if (j == SIZE_MAX || batch->states[j] == Batch::Pending ||
+            batch->states[j] == Batch::Running)
+        {
+            mount.status = MountStatus::TimedOut;
+            if (j != SIZE_MAX && batch->states[j] == Batch::Running)
+            {
+                _hung[mount.mountPoint] = batch->returned[j];
+            }
+        }
+        else if (batch->states[j] == Batch::Done)
+        {
+            mount.status = MountStatus::Ok;
+            fillSizes(mount, batch->results[j]);
+        }
+        else
+        {
+            mount.status = MountStatus::Failed;
+        }
+
+        raw.assign(1, static_cast<char>(mount.status));
+        if (mount.status == MountStatus::Ok)
+        {
+            raw.append(reinterpret_cast<const char *>(&batch->results[j]),
+                       sizeof(struct statvfs));
+        }
+        _source.record(CaptureKind::Syscall, captureKey(mount.mountPoint),
+                       raw.data(), raw.size());
+    }
+}
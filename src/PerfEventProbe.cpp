@@ -0,0 +1,295 @@
+#include <PerfEventProbe.hpp>
+#include <ProbeTelemetry.hpp>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <linux/perf_event.h>
+#include <sstream>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+
+namespace
+{
+// Порядок событий внутри группы. Лидер группы идет первым
+struct EventSpec
+{
+    uint32_t type;
+    uint64_t config;
+};
+
+const EventSpec HARDWARE_EVENTS[] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS}};
+
+const EventSpec SOFTWARE_EVENTS[] = {
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_CLOCK},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS}};
+
+// Ответ read() для PERF_FORMAT_GROUP | TOTAL_TIME_ENABLED | TOTAL_TIME_RUNNING
+struct GroupHeader
+{
+    uint64_t nr;
+    uint64_t timeEnabled;
+    uint64_t timeRunning;
+};
+
+int perfEventOpen(const EventSpec &spec, uint32_t cpu, int groupFd)
+{
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = spec.type;
+    attr.config = spec.config;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                       PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    // pid = -1, cpu = N: все процессы на данном процессоре
+    int fd = syscall(__NR_perf_event_open, &attr, -1, static_cast<int>(cpu),
+                     groupFd, PERF_FLAG_FD_CLOEXEC);
+    info::ProbeTelemetry::addSyscalls(1);
+    return fd;
+}
+
+std::string captureKey(uint32_t cpu)
+{
+    return "perf:cpu" + std::to_string(cpu);
+}
+} // namespace
+
+info::PerfEventProbe::PerfEventProbe(ProbeSource &source,
+                                     std::chrono::milliseconds warmup)
+    : _source(source), _warmup(warmup)
+{
+}
+
+info::PerfEventProbe::~PerfEventProbe()
+{
+    for (auto &group : _groups)
+    {
+        for (int fd : group.fds)
+        {
+            close(fd);
+        }
+    }
+}
+
+std::vector<uint32_t> info::PerfEventProbe::parseCPUList(const std::string &list)
+{
+    std::vector<uint32_t> output;
+    std::stringstream ranges(list);
+    for (std::string range; std::getline(ranges, range, ',');)
+    {
+        unsigned first, last;
+        int matched = std::sscanf(range.c_str(), "%u-%u", &first, &last);
+        if (matched == 1)
+        {
+            last = first;
+        }
+        else if (matched != 2)
+        {
+            continue;
+        }
+        for (unsigned cpu = first; cpu <= last; ++cpu)
+        {
+            output.push_back(cpu);
+        }
+    }
+    return output;
+}
+
+bool info::PerfEventProbe::_openGroup(Group &group, bool hardware)
+{
+    const EventSpec *events = hardware ? HARDWARE_EVENTS : SOFTWARE_EVENTS;
+    const std::size_t count =
+        hardware ? std::size(HARDWARE_EVENTS) : std::size(SOFTWARE_EVENTS);
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        int fd = perfEventOpen(events[i], group.cpu,
+                               group.fds.empty() ? -1 : group.fds.front());
+        if (fd < 0)
+        {
+            for (int opened : group.fds)
+            {
+                close(opened);
+            }
+            group.fds.clear();
+            return false;
+        }
+        group.fds.push_back(fd);
+    }
+    return true;
+}
+
+void info::PerfEventProbe::_open()
+{
+    _opened = true;
+
+    std::string online;
+    _source.readFile("/sys/devices/system/cpu/online", online);
+    const auto cpus = parseCPUList(online);
+
+    if (_source.replaying())
+    {
+        // Состав группы восстанавливается по количеству событий в записи
+        for (uint32_t cpu : cpus)
+        {
+            _groups.push_back({cpu, {}, {}});
+        }
+        return;
+    }
+
+    // Сначала пробуем аппаратные события; если PMU недоступен, на всех
+    // процессорах используются только программные
+    for (bool hardware : {true, false})
+    {
+        for (uint32_t cpu : cpus)
+        {
+            Group group{cpu, {}, {}};
+            if (!_openGroup(group, hardware))
+            {
+                break;
+            }
+            _groups.push_back(std::move(group));
+        }
+
+        if (!cpus.empty() && _groups.size() == cpus.size())
+        {
+            return;
+        }
+        for (auto &group : _groups)
+        {
+            for (int fd : group.fds)
+            {
+                close(fd);
+            }
+        }
+        _groups.clear();
+    }
+}
+
+bool info::PerfEventProbe::_read(Group &group, std::string &out)
+{
+    if (_source.replaying())
+    {
+        return _source.replay(CaptureKind::Syscall, captureKey(group.cpu), out);
+    }
+
+    out.resize(sizeof(GroupHeader) +
+               sizeof(uint64_t) * std::size(HARDWARE_EVENTS));
+    ssize_t n = ::read(group.fds.front(), out.data(), out.size());
+    ProbeTelemetry::addSyscalls(1);
+    if (n < static_cast<ssize_t>(sizeof(GroupHeader)))
+    {
+        return false;
+    }
+    out.resize(n);
+    ProbeTelemetry::addBytes(n);
+    _source.record(CaptureKind::Syscall, captureKey(group.cpu), out.data(),
+                   out.size());
+    return true;
+}
+
+info::PerfCounterInfo info::PerfEventProbe::sample()
+{
+    std::lock_guard lock(_mutex);
+
+    std::string current;
+    if (!_opened)
+    {
+        _open();
+        for (auto &group : _groups)
+        {
+            _read(group, group.previous);
+        }
+        if (!_source.replaying())
+        {
+            std::this_thread::sleep_for(_warmup);
+        }
+    }
+
+    PerfCounterInfo output;
+    double intervalSum = 0;
+    for (auto &group : _groups)
+    {
+        if (!_read(group, current) ||
+            current.size() != group.previous.size())
+        {
+            group.previous = current;
+            continue;
+        }
+
+        GroupHeader now, before;
+        std::memcpy(&now, current.data(), sizeof(now));
+        std::memcpy(&before, group.previous.data(), sizeof(before));
+        auto value = [](const std::string &raw, std::size_t i)
+        {
+            uint64_t v;
+            std::memcpy(&v, raw.data() + sizeof(GroupHeader) + i * sizeof(v),
+                        sizeof(v));
+            return v;
+        };
+
+        const bool hardware = now.nr == std::size(HARDWARE_EVENTS);
+        const uint64_t enabled = now.timeEnabled - before.timeEnabled;
+        const uint64_t running = now.timeRunning - before.timeRunning;
+        if (enabled == 0 || running == 0 ||
+            sizeof(GroupHeader) + now.nr * sizeof(uint64_t) > current.size())
+        {
+            group.previous = current;
+            continue;
+        }
+
+        // Если счетчиков больше, чем регистров PMU, ядро мультиплексирует
+        // группы: масштабируем значения на долю времени, когда группа
+        // действительно считала
+        const double seconds = enabled / 1e9;
+        const double scale = static_cast<double>(enabled) / running;
+        auto rate = [&](std::size_t i)
+        {
+            return (value(current, i) - value(group.previous, i)) * scale /
+                   seconds;
+        };
+
+        PerfCoreCounters core{};
+        core.cpu = group.cpu;
+        if (hardware)
+        {
+            core.cycles = rate(0);
+            core.instructions = rate(1);
+            core.cacheMisses = rate(2);
+            core.branchMisses = rate(3);
+            if (core.cycles > 0)
+            {
+                core.ipc = core.instructions / core.cycles;
+            }
+            if (core.instructions > 0)
+            {
+                core.cacheMissesPerKI =
+                    core.cacheMisses * 1000 / core.instructions;
+                core.branchMissesPerKI =
+                    core.branchMisses * 1000 / core.instructions;
+            }
+        }
+        core.contextSwitches = rate(now.nr - 2);
+        core.pageFaults = rate(now.nr - 1);
+
+        output.hardware = hardware;
+        output.cores.push_back(core);
+        intervalSum += seconds;
+        group.previous = std::move(current);
+    }
+
+    if (!output.cores.empty())
+    {
+        output.interval =
+            std::chrono::duration<float>(intervalSum / output.cores.size());
+    }
+    return output;
+}
@@ -0,0 +1,157 @@
+#include <ProbeCapture.hpp>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+namespace
+{
+const char CAPTURE_MAGIC[8] = {'S', 'P', 'C', 'A', 'P', 0, 0, 1};
+
+// Читает varint из буфера, сдвигая позицию. При выходе за границу
+// возвращает false
+bool readVarint(const std::string &buf, std::size_t &pos, uint64_t &value)
+{
+    value = 0;
+    for (int shift = 0; pos < buf.size() && shift < 64; shift += 7)
+    {
+        uint8_t byte = buf[pos++];
+        value |= uint64_t(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+} // namespace
+
+info::CaptureWriter::CaptureWriter(const std::string &path)
+    : _out(path, std::ios_base::out | std::ios_base::trunc |
+                     std::ios_base::binary),
+      _last(std::chrono::steady_clock::now())
+{
+    _out.write(CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+}
+
+bool info::CaptureWriter::isOpen() const { return _out.good(); }
+
+void info::CaptureWriter::write(CaptureKind kind, const std::string &key,
+                                const void *data, std::size_t size)
+{
+    std::lock_guard lock(_mutex);
+    auto now = std::chrono::steady_clock::now();
+    uint64_t delta =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(now - _last)
+            .count();
+    _last = now;
+
+    _out.put(static_cast<char>(kind));
+    _writeVarint(delta);
+
+    // Ключи повторяются постоянно, поэтому пишем их один раз
+    auto [it, inserted] = _keys.emplace(key, _keys.size());
+    _writeVarint(it->second);
+    if (inserted)
+    {
+        _writeVarint(key.size());
+        _out.write(key.data(), key.size());
+    }
+
+    _writeVarint(size);
+    _out.write(static_cast<const char *>(data), size);
+    _out.flush();
+}
+
+void info::CaptureWriter::_writeVarint(uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        _out.put(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    _out.put(static_cast<char>(value));
+}
+
+info::CaptureReader::CaptureReader(const std::string &path, double speed)
+    : _speed(speed), _start(std::chrono::steady_clock::now())
+{
+    std::ifstream in(path, std::ios_base::in | std::ios_base::binary);
+    std::string buf(std::istreambuf_iterator<char>(in), {});
+
+    if (buf.size() < sizeof(CAPTURE_MAGIC) ||
+        buf.compare(0, sizeof(CAPTURE_MAGIC), CAPTURE_MAGIC,
+                    sizeof(CAPTURE_MAGIC)) != 0)
+    {
+        return;
+    }
+
+    // Обрезанный хвост (например, после падения записывающего процесса)
+    // просто отбрасывается
+    _loaded = true;
+
+    std::vector<std::string> keys;
+    uint64_t timestamp = 0;
+    std::size_t pos = sizeof(CAPTURE_MAGIC);
+    while (pos < buf.size())
+    {
+        auto kind = static_cast<CaptureKind>(buf[pos++]);
+        uint64_t delta, keyId, size;
+        if (!readVarint(buf, pos, delta) || !readVarint(buf, pos, keyId))
+        {
+            return;
+        }
+        timestamp += delta;
+
+        if (keyId == keys.size())
+        {
+            uint64_t keySize;
+            if (!readVarint(buf, pos, keySize) || keySize > buf.size() - pos)
+            {
+                return;
+            }
+            keys.emplace_back(buf, pos, keySize);
+            pos += keySize;
+        }
+        else if (keyId > keys.size())
+        {
+            return;
+        }
+
+        if (!readVarint(buf, pos, size) || size > buf.size() - pos)
+        {
+            return;
+        }
+        _entries[{kind, keys[keyId]}].push_back(
+            {timestamp, std::string(buf, pos, size)});
+        pos += size;
+    }
+}
+
+bool info::CaptureReader::isOpen() const { return _loaded; }
+
+bool info::CaptureReader::next(CaptureKind kind, const std::string &key,
+                               std::string &out)
+{
+    Entry entry;
+    {
+        std::lock_guard lock(_mutex);
+        auto it = _entries.find({kind, key});
+        if (it == _entries.end() || it->second.empty())
+        {
+            return false;
+        }
+        entry = std::move(it->second.front());
+        it->second.pop_front();
+    }
+
+    // Ждем вне блокировки, чтобы не задерживать другие потоки
+    if (_speed > 0)
+    {
+        std::this_thread::sleep_until(
+            _start + std::chrono::nanoseconds(
+                         static_cast<uint64_t>(entry.timestamp / _speed)));
+    }
+
+    out = std::move(entry.data);
+    return true;
+}
@@ -0,0 +1,439 @@
+#include <ProbeSource.hpp>
+#include <ProbeTelemetry.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <dirent.h>
+#include <fcntl.h>
+#include <streambuf>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+// Поток над выводом утилиты. Читает pipe блоками и при необходимости
+// сохраняет прочитанное для записи
+class PipeBuffer : public std::streambuf
+{
+  public:
+    PipeBuffer(FILE *pipe, std::string *tee) : _pipe(pipe), _tee(tee) {}
+
+    void drain()
+    {
+        while (underflow() != traits_type::eof())
+        {
+            setg(_chunk, _chunk + sizeof(_chunk), _chunk + sizeof(_chunk));
+        }
+    }
+
+    std::size_t total() const { return _total; }
+
+  protected:
+    int_type underflow() override
+    {
+        if (gptr() < egptr())
+        {
+            return traits_type::to_int_type(*gptr());
+        }
+        std::size_t n = std::fread(_chunk, 1, sizeof(_chunk), _pipe);
+        if (n == 0)
+        {
+            return traits_type::eof();
+        }
+        _total += n;
+        if (_tee)
+        {
+            _tee->append(_chunk, n);
+        }
+        setg(_chunk, _chunk, _chunk + n);
+        return traits_type::to_int_type(*gptr());
+    }
+
+  private:
+    FILE *_pipe;
+    std::string *_tee;
+    std::size_t _total{0};
+    char _chunk[65536];
+};
+
+// Поток над записанным выводом при воспроизведении
+class MemoryBuffer : public std::streambuf
+{
+  public:
+    explicit MemoryBuffer(const std::string &data)
+    {
+        char *begin = const_cast<char *>(data.data());
+        setg(begin, begin, begin + data.size());
+    }
+};
+} // namespace
+
+info::ProbeSource::ProbeSource(const ProbeOptions &options)
+    : _sysroot(options.sysroot)
+{
+    // Исключения библиотека не использует, а молча работать без записи или
+    // с пустым воспроизведением хуже, чем сообщить об ошибке
+    if (!options.replayPath.empty())
+    {
+        _replayer = std::make_unique<CaptureReader>(options.replayPath,
+                                                    options.replaySpeed);
+        if (!_replayer->isOpen())
+        {
+            std::fprintf(stderr,
+                         "ProbeSource: не удалось прочитать запись %s\n",
+                         options.replayPath.c_str());
+        }
+    }
+    else if (!options.recordPath.empty())
+    {
+        _recorder = std::make_unique<CaptureWriter>(options.recordPath);
+        if (!_recorder->isOpen())
+        {
+            std::fprintf(stderr,
+                         "ProbeSource: не удалось открыть %s для записи\n",
+                         options.recordPath.c_str());
+            _recorder.reset();
+        }
+    }
+}
+
+std::string info::ProbeSource::path(const std::string &path) const
+{
+    return _sysroot + path;
+}
+
+bool info::ProbeSource::readFile(const std::string &path, std::string &out)
+{
+    out.clear();
+    if (_replayer)
+    {
+        bool found = _replayer->next(CaptureKind::File, path, out);
+        ProbeTelemetry::addBytes(out.size());
+        return found;
+    }
+
+    int fd = open(this->path(path).c_str(), O_RDONLY | O_CLOEXEC);
+    ProbeTelemetry::addSyscalls(1);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    // Файлы в /proc сообщают нулевой размер, поэтому читаем до конца
+    std::size_t used = 0;
+    for (;;)
+    {
+        if (out.size() - used < 4096)
+        {
+            out.resize(used + (used < 4096 ? 4096 : used));
+        }
+        ssize_t n = ::read(fd, &out[used], out.size() - used);
+        ProbeTelemetry::addSyscalls(1);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            break;
+        }
+        used += n;
+    }
+    close(fd);
+    ProbeTelemetry::addSyscalls(1);
+    ProbeTelemetry::addBytes(used);
+    out.resize(used);
+
+    if (_recorder)
+    {
+        _recorder->write(CaptureKind::File, path, out.data(), out.size());
+    }
+    return true;
+}
+
+std::vector<std::string>
+info::ProbeSource::listDirectory(const std::string &path)
+{
+    return _list(CaptureKind::Directory, path);
+}
+
+std::vector<std::string>
+info::ProbeSource::listSubdirectories(const std::string &path)
+{
+    return _list(CaptureKind::Subdirectories, path);
+}
+
+std::vector<std::string> info::ProbeSource::_list(CaptureKind kind,
+                                                  const std::string &path)
+{
+    std::vector<std::string> output;
+    std::string joined;
+    if (_replayer)
+    {
+        _replayer->next(kind, path, joined);
+        ProbeTelemetry::addBytes(joined.size());
+        for (std::size_t pos = 0, eol; pos < joined.size(); pos = eol + 1)
+        {
+            eol = joined.find('\n', pos);
+            eol = eol == std::string::npos ? joined.size() : eol;
+            output.emplace_back(joined, pos, eol - pos);
+        }
+        return output;
+    }
+
+    const std::string full = this->path(path);
+    DIR *dir = opendir(full.c_str());
+    ProbeTelemetry::addSyscalls(1);
+    if (dir)
+    {
+        while (dirent *entry = readdir(dir))
+        {
+            if (std::strcmp(entry->d_name, ".") == 0 ||
+                std::strcmp(entry->d_name, "..") == 0)
+            {
+                continue;
+            }
+            if (kind == CaptureKind::Subdirectories &&
+                entry->d_type != DT_DIR)
+            {
+                // Не все файловые системы заполняют d_type
+                struct stat status;
+                if (entry->d_type != DT_UNKNOWN ||
+                    fstatat(dirfd(dir), entry->d_name, &status, 0) != 0 ||
+                    !S_ISDIR(status.st_mode))
+                {
+                    continue;
+                }
+            }
+            output.emplace_back(entry->d_name);
+        }
+        closedir(dir);
+        ProbeTelemetry::addSyscalls(2);
+    }
+    // Порядок readdir не определен, а при воспроизведении он должен совпадать
+    std::sort(output.begin(), output.end());
+
+    if (_recorder)
+    {
+        for (const auto &name : output)
+        {
+            joined += name;
+            joined += '\n';
+        }
+        if (!joined.empty())
+        {
+            joined.pop_back();
+        }
+        _recorder->write(kind, path, joined.data(), joined.size());
+    }
+    return output;
+}
+
+std::chrono::nanoseconds info::ProbeSource::monotonic()
+{
+    int64_t ns = 0;
+    if (_replayer)
+    {
+        std::string raw;
+        if (_replayer->next(CaptureKind::Syscall, "clock_monotonic", raw) &&
+            raw.size() == sizeof(ns))
+        {
+            std::memcpy(&ns, raw.data(), sizeof(ns));
+        }
+        return std::chrono::nanoseconds(ns);
+    }
+
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    ns = static_cast<int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+    if (_recorder)
+    {
+        _recorder->write(CaptureKind::Syscall, "clock_monotonic", &ns,
+                         sizeof(ns));
+    }
+    return std::chrono::nanoseconds(ns);
+}
+
+std::string info::ProbeSource::runCommand(const std::string &command)
+{
+    std::string output;
+    if (_replayer)
+    {
+        _replayer->next(CaptureKind::Command, command, output);
+        ProbeTelemetry::addBytes(output.size());
+        return output;
+    }
+
+    FILE *pipe = popen(command.c_str(), "r");
+    ProbeTelemetry::addSubprocess();
+    if (pipe)
+    {
+        char chunk[4096];
+        for (std::size_t n; (n = std::fread(chunk, 1, sizeof(chunk), pipe));)
+        {
+            output.append(chunk, n);
+        }
+        pclose(pipe);
+    }
+    ProbeTelemetry::addBytes(output.size());
+
+    if (_recorder)
+    {
+        _recorder->write(CaptureKind::Command, command, output.data(),
+                         output.size());
+    }
+    return output;
+}
+
+void info::ProbeSource::runCommand(
+    const std::string &command,
+    const std::function<void(std::istream &)> &consume)
+{
+    if (_replayer)
+    {
+        std::string output;
+        _replayer->next(CaptureKind::Command, command, output);
+        ProbeTelemetry::addBytes(output.size());
+        MemoryBuffer buffer(output);
+        std::istream stream(&buffer);
+        consume(stream);
+        return;
+    }
+
+    FILE *pipe = popen(command.c_str(), "r");
+    ProbeTelemetry::addSubprocess();
+    if (!pipe)
+    {
+        const std::string empty;
+        MemoryBuffer buffer(empty);
+        std::istream stream(&buffer);
+        consume(stream);
+        return;
+    }
+
+    // При записи вывод все же накапливается: в файл записи он попадает
+    // одним куском
+    std::string recorded;
+    PipeBuffer buffer(pipe, _recorder ? &recorded : nullptr);
+    std::istream stream(&buffer);
+    consume(stream);
+    buffer.drain();
+    pclose(pipe);
+    ProbeTelemetry::addBytes(buffer.total());
+
+    if (_recorder)
+    {
+        _recorder->write(CaptureKind::Command, command, recorded.data(),
+                         recorded.size());
+    }
+}
+
+void info::ProbeSource::record(CaptureKind kind, const std::string &key,
+                               const void *data, std::size_t size)
+{
+    if (_recorder)
+    {
+        _recorder->write(kind, key, data, size);
+    }
+}
+
+bool info::ProbeSource::replay(CaptureKind kind, const std::string &key,
+                               std::string &out)
+{
+    if (!_replayer || !_replayer->next(kind, key, out))
+    {
+        return false;
+    }
+    ProbeTelemetry::addBytes(out.size());
+    return true;
+}
+
+info::PinnedFile::PinnedFile(ProbeSource &source, std::string path, bool pin)
+    : _source(&source), _path(std::move(path)), _pin(pin)
+{
+}
+
+info::PinnedFile::~PinnedFile()
+{
+    if (_fd >= 0)
+    {
+        close(_fd);
+    }
+}
+
+info::PinnedFile::PinnedFile(PinnedFile &&other) noexcept
+    : _source(other._source), _path(std::move(other._path)), _fd(other._fd),
+      _error(other._error), _pin(other._pin)
+{
+    other._fd = -1;
+}
+
+info::PinnedFile &info::PinnedFile::operator=(PinnedFile &&other) noexcept
+{
+    std::swap(_source, other._source);
+    std::swap(_path, other._path);
+    std::swap(_fd, other._fd);
+    std::swap(_error, other._error);
+    std::swap(_pin, other._pin);
+    return *this;
+}
+
+void info::PinnedFile::unpin()
+{
+    _pin = false;
+    if (_fd >= 0)
+    {
+        close(_fd);
+        _fd = -1;
+    }
+}
+
+bool info::PinnedFile::read(std::string &out)
+{
+    out.clear();
+    if (_source->replaying())
+    {
+        const bool found = _source->replay(CaptureKind::File, _path, out);
+        _error = found ? 0 : ENOENT;
+        return found;
+    }
+
+    if (_fd < 0)
+    {
+        _fd = open(_source->path(_path).c_str(), O_RDONLY | O_CLOEXEC);
+        ProbeTelemetry::addSyscalls(1);
+        if (_fd < 0)
+        {
+            _error = errno;
+            return false;
+        }
+    }
+
+    // Атрибуты sysfs не длиннее страницы и отдаются одним чтением
+    out.resize(4096);
+    ssize_t n;
+    do
+    {
+        n = pread(_fd, out.data(), out.size(), 0);
+        ProbeTelemetry::addSyscalls(1);
+    } while (n < 0 && errno == EINTR);
+    _error = n < 0 ? errno : 0;
+    if (!_pin)
+    {
+        close(_fd);
+        _fd = -1;
+        ProbeTelemetry::addSyscalls(1);
+    }
+    if (n < 0)
+    {
+        out.clear();
+        return false;
+    }
+    out.resize(n);
+    ProbeTelemetry::addBytes(n);
+
+    _source->record(CaptureKind::File, _path, out.data(), out.size());
+    return true;
+}
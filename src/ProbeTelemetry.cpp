@@ -0,0 +1,166 @@
+#include <ProbeTelemetry.hpp>
+#include <iterator>
+
+namespace
+{
+// Счетчики метода, выполняющегося в текущем потоке
+thread_local info::ProbeTelemetry::Counters *currentCounters = nullptr;
+
+constexpr unsigned SUB_BITS = 3;
+constexpr uint64_t SUB_COUNT = 1 << SUB_BITS;
+
+const char *const PROBE_NAMES[] = {"getOSInfo",
+                                   "getUserInfo",
+                                   "getDiscPartitionInfo",
+                                   "getPeripheryInfo",
+                                   "getNetworkInterfaceInfo",
+                                   "getMemoryInfo",
+                                   "getCPUInfo",
+                                   "getPerfCounterInfo",
+                                   "getCPUTimes",
+                                   "getSchedulerInfo",
+                                   "getInterruptInfo",
+                                   "getThermalInfo",
+                                   "getMountInfo",
+                                   "getSocketInfo",
+                                   "getVMInfo",
+                                   "getCgroupInfo"};
+static_assert(std::size(PROBE_NAMES) ==
+                  static_cast<std::size_t>(info::ProbeKind::Count),
+              "Every ProbeKind needs a name");
+
+inline void add(std::atomic<uint64_t> info::ProbeTelemetry::Counters::*field,
+                uint64_t value)
+{
+    if (currentCounters)
+    {
+        (currentCounters->*field).fetch_add(value, std::memory_order_relaxed);
+    }
+}
+} // namespace
+
+std::size_t info::ProbeStats::bucketOf(std::chrono::nanoseconds duration)
+{
+    const uint64_t v = duration.count() > 0 ? duration.count() : 0;
+    if (v < SUB_COUNT)
+    {
+        return v;
+    }
+
+    const unsigned exponent = 63 - __builtin_clzll(v);
+    const std::size_t bucket =
+        (exponent - SUB_BITS + 1) * SUB_COUNT +
+        ((v >> (exponent - SUB_BITS)) & (SUB_COUNT - 1));
+    return bucket < LATENCY_BUCKETS ? bucket : LATENCY_BUCKETS - 1;
+}
+
+std::chrono::nanoseconds info::ProbeStats::bucketLowerBound(std::size_t bucket)
+{
+    if (bucket < SUB_COUNT)
+    {
+        return std::chrono::nanoseconds(bucket);
+    }
+
+    const unsigned exponent = bucket / SUB_COUNT + SUB_BITS - 1;
+    const uint64_t mantissa = SUB_COUNT + bucket % SUB_COUNT;
+    return std::chrono::nanoseconds(mantissa << (exponent - SUB_BITS));
+}
+
+std::chrono::nanoseconds info::ProbeStats::percentile(double q) const
+{
+    uint64_t total = 0;
+    for (auto count : latency)
+    {
+        total += count;
+    }
+    if (total == 0)
+    {
+        return std::chrono::nanoseconds(0);
+    }
+
+    const uint64_t rank = static_cast<uint64_t>(q * (total - 1));
+    uint64_t seen = 0;
+    for (std::size_t i = 0; i < LATENCY_BUCKETS; ++i)
+    {
+        seen += latency[i];
+        if (seen > rank)
+        {
+            return bucketLowerBound(i);
+        }
+    }
+    return bucketLowerBound(LATENCY_BUCKETS - 1);
+}
+
+info::ProbeTelemetry::Scope::Scope(ProbeTelemetry &telemetry, ProbeKind probe)
+    : _counters(telemetry._counters[static_cast<std::size_t>(probe)]),
+      _previous(currentCounters), _start(std::chrono::steady_clock::now())
+{
+    currentCounters = &_counters;
+}
+
+info::ProbeTelemetry::Scope::~Scope()
+{
+    auto elapsed = std::chrono::steady_clock::now() - _start;
+    _counters.calls.fetch_add(1, std::memory_order_relaxed);
+    _counters.latency[ProbeStats::bucketOf(elapsed)].fetch_add(
+        1, std::memory_order_relaxed);
+    currentCounters = _previous;
+}
+
+info::ProbeTelemetry::Attach::Attach(Counters *counters)
+    : _previous(currentCounters)
+{
+    currentCounters = counters;
+}
+
+info::ProbeTelemetry::Attach::~Attach() { currentCounters = _previous; }
+
+info::ProbeTelemetry::Counters *info::ProbeTelemetry::current()
+{
+    return currentCounters;
+}
+
+info::SelfStats info::ProbeTelemetry::snapshot() const
+{
+    SelfStats output;
+    for (std::size_t i = 0; i < _counters.size(); ++i)
+    {
+        const auto &src = _counters[i];
+        auto &dst = output.probes[i];
+        dst.name = PROBE_NAMES[i];
+        dst.calls = src.calls.load(std::memory_order_relaxed);
+        dst.bytesRead = src.bytesRead.load(std::memory_order_relaxed);
+        dst.syscalls = src.syscalls.load(std::memory_order_relaxed);
+        dst.subprocesses = src.subprocesses.load(std::memory_order_relaxed);
+        dst.cacheHits = src.cacheHits.load(std::memory_order_relaxed);
+        dst.cacheMisses = src.cacheMisses.load(std::memory_order_relaxed);
+        dst.cacheCoalesced =
+            src.cacheCoalesced.load(std::memory_order_relaxed);
+        for (std::size_t b = 0; b < ProbeStats::LATENCY_BUCKETS; ++b)
+        {
+            dst.latency[b] = src.latency[b].load(std::memory_order_relaxed);
+        }
+    }
+    return output;
+}
+
+void info::ProbeTelemetry::addBytes(uint64_t bytes)
+{
+    add(&Counters::bytesRead, bytes);
+}
+
+void info::ProbeTelemetry::addSyscalls(uint64_t count)
+{
+    add(&Counters::syscalls, count);
+}
+
+void info::ProbeTelemetry::addSubprocess() { add(&Counters::subprocesses, 1); }
+
+void info::ProbeTelemetry::cacheHit() { add(&Counters::cacheHits, 1); }
+
+void info::ProbeTelemetry::cacheMiss() { add(&Counters::cacheMisses, 1); }
+
+void info::ProbeTelemetry::cacheCoalesced()
+{
+    add(&Counters::cacheCoalesced, 1);
+}
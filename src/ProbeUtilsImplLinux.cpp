@@ -1,81 +1,372 @@
 #include <ProbeUtilities.hpp>
+#include <ProbeTelemetry.hpp>
 #include <ProbeUtilsImplLinux.hpp>
+#include <ProcInterrupts.hpp>
+#include <ProcStat.hpp>
+#include <algorithm>
 #include <arpa/inet.h>
 #include <chrono>
 #include <cstdint>
+#include <cstdio>
 #include <cstdlib>
-#include <fstream>
+#include <cstring>
 #include <functional>
 #include <iostream>
 #include <netinet/in.h>
 #include <nlohmann/json.hpp>
+#include <sstream>
 #include <sys/utsname.h>
 #include <thread>
 #include <unistd.h>
 #include <utmp.h>
 
-/**
- * @brief RAII-based обертка над ifstream
- */
-class ifstreamWrapper
+using namespace nlohmann;
+
+namespace
+{
+// Уровень вложенности при SAX-разборе
+struct SaxFrame
+{
+    bool array;
+
+    /**
+     * @brief У объекта - последний прочитанный ключ, у массива - ключ, под
+     * которым массив лежит в родительском объекте
+     */
+    std::string key;
+};
+
+// Разбор lshw -json без построения дерева. Устройства - корневой объект
+// (или элементы корневого массива в новых версиях lshw) и объекты в
+// массивах "children". Нужные поля собираются, пока объект открыт, и
+// устройство сохраняется при его закрытии
+class LshwSax
 {
-    std::ifstream _s;  ///< Файл
-    std::string _name; ///< Название файла
   public:
-    ifstreamWrapper(std::string name) : _s(name), _name(name) {}
+    explicit LshwSax(const std::unordered_set<std::string> &classes)
+        : _classes(classes)
+    {
+    }
+
+    bool null() { return true; }
+    bool boolean(bool) { return true; }
+    bool number_integer(json::number_integer_t) { return true; }
+    bool number_unsigned(json::number_unsigned_t) { return true; }
+    bool number_float(json::number_float_t, const json::string_t &)
+    {
+        return true;
+    }
+    bool binary(json::binary_t &) { return true; }
+
+    bool string(json::string_t &value)
+    {
+        if (_frames.empty() || _frames.back().array || !_nodes.back().device)
+        {
+            return true;
+        }
+        Node &node = _nodes.back();
+        const std::string &key = _frames.back().key;
+        std::string *target = key == "class"         ? &node.cls
+                              : key == "vendor"      ? &node.vendor
+                              : key == "product"     ? &node.product
+                              : key == "description" ? &node.description
+                              : key == "id"          ? &node.id
+                                                     : nullptr;
+        if (target)
+        {
+            *target = std::move(value);
+        }
+        return true;
+    }
+
+    bool key(json::string_t &value)
+    {
+        _frames.back().key = std::move(value);
+        return true;
+    }
+
+    bool start_object(std::size_t)
+    {
+        const bool device =
+            _frames.empty() ||
+            (_frames.back().array &&
+             (_frames.back().key == "children" || _frames.size() == 1));
+        _frames.push_back({false, {}});
+        // generic используется в lshw, когда не указано класса
+        _nodes.push_back({device, _order++, "generic", {}, {}, {}, {}});
+        return true;
+    }
+
+    bool end_object()
+    {
+        Node &node = _nodes.back();
+        if (node.device && _classes.count(node.cls) != 0)
+        {
+            _found.emplace_back(
+                node.order,
+                info::PeripheryInfo{node.vendor + " " + node.product + " | " +
+                                        node.description + " " + node.id,
+                                    std::move(node.cls)});
+        }
+        _nodes.pop_back();
+        _frames.pop_back();
+        return true;
+    }
+
+    bool start_array(std::size_t)
+    {
+        std::string key = _frames.empty() || _frames.back().array
+                              ? std::string()
+                              : _frames.back().key;
+        _frames.push_back({true, std::move(key)});
+        return true;
+    }
 
-    std::ifstream &getStream() { return _s; }
+    bool end_array()
+    {
+        _frames.pop_back();
+        return true;
+    }
 
-    ~ifstreamWrapper()
+    bool parse_error(std::size_t, const std::string &, const json::exception &)
     {
-        std::string rmstr = "rm " + _name;
-        std::system(rmstr.c_str());
+        _found.clear();
+        return false;
+    }
+
+    // Устройства в порядке обхода в глубину: родитель раньше потомков
+    std::vector<info::PeripheryInfo> result()
+    {
+        std::sort(_found.begin(), _found.end(),
+                  [](const auto &a, const auto &b) { return a.first < b.first; });
+        std::vector<info::PeripheryInfo> output;
+        output.reserve(_found.size());
+        for (auto &entry : _found)
+        {
+            output.push_back(std::move(entry.second));
+        }
+        return output;
     }
+
+  private:
+    struct Node
+    {
+        bool device;
+        std::size_t order;
+        std::string cls, vendor, product, description, id;
+    };
+
+    const std::unordered_set<std::string> &_classes;
+    std::vector<SaxFrame> _frames;
+    std::vector<Node> _nodes;
+    std::size_t _order{0};
+    std::vector<std::pair<std::size_t, info::PeripheryInfo>> _found;
 };
 
-using putils = info::ProbeUtilities;
-using namespace nlohmann;
-using namespace std::chrono_literals;
+// Разбор lsblk --json. Разделы - объекты в массивах "children" дисков из
+// "blockdevices"; вложенные в разделы устройства (LVM, dm-crypt) не
+// возвращаются
+class LsblkSax
+{
+  public:
+    bool null() { return true; }
+    bool boolean(bool) { return true; }
+    bool number_integer(json::number_integer_t value)
+    {
+        return number(value >= 0 ? static_cast<uint64_t>(value) : 0);
+    }
+    bool number_unsigned(json::number_unsigned_t value)
+    {
+        return number(value);
+    }
+    bool number_float(json::number_float_t value, const json::string_t &)
+    {
+        return number(value >= 0 ? static_cast<uint64_t>(value) : 0);
+    }
+    bool binary(json::binary_t &) { return true; }
 
-const std::unordered_set<std::string> putils::ProbeUtilsImpl::_DESIRED_CLASSES =
+    bool string(json::string_t &value)
+    {
+        if (!_inPartition())
+        {
+            return true;
+        }
+        const std::string &key = _frames.back().key;
+        if (key == "name")
+        {
+            _partition.name = std::move(value);
+        }
+        else if (key == "mountpoint")
+        {
+            _partition.mountPoint = std::move(value);
+        }
+        else if (key == "fstype")
+        {
+            _partition.filesystem = std::move(value);
+        }
+        else
+        {
+            // Старые версии lsblk выводят размеры строками
+            number(std::strtoull(value.c_str(), nullptr, 10));
+        }
+        return true;
+    }
+
+    bool key(json::string_t &value)
+    {
+        _frames.back().key = std::move(value);
+        return true;
+    }
+
+    bool start_object(std::size_t)
+    {
+        _frames.push_back({false, {}});
+        if (_frames.size() == PARTITION_DEPTH && _frames[1].array &&
+            _frames[1].key == "blockdevices" && _frames[3].array &&
+            _frames[3].key == "children")
+        {
+            _partition = {"null", "null", "null", 0, 0};
+        }
+        return true;
+    }
+
+    bool end_object()
+    {
+        if (_inPartition())
+        {
+            _output.push_back(std::move(_partition));
+        }
+        _frames.pop_back();
+        return true;
+    }
+
+    bool start_array(std::size_t)
+    {
+        std::string key = _frames.empty() || _frames.back().array
+                              ? std::string()
+                              : _frames.back().key;
+        _frames.push_back({true, std::move(key)});
+        return true;
+    }
+
+    bool end_array()
+    {
+        _frames.pop_back();
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string &, const json::exception &)
+    {
+        _output.clear();
+        return false;
+    }
+
+    std::vector<info::DiscPartitionInfo> result() { return std::move(_output); }
+
+  private:
+    // Корневой объект, "blockdevices", диск, "children", раздел
+    static constexpr std::size_t PARTITION_DEPTH = 5;
+
+    std::vector<SaxFrame> _frames;
+    info::DiscPartitionInfo _partition;
+    std::vector<info::DiscPartitionInfo> _output;
+
+    bool _inPartition() const
+    {
+        return _frames.size() == PARTITION_DEPTH && !_frames.back().array &&
+               _frames[1].key == "blockdevices" && _frames[3].key == "children";
+    }
+
+    bool number(uint64_t value)
+    {
+        if (_inPartition())
+        {
+            const std::string &key = _frames.back().key;
+            if (key == "size")
+            {
+                _partition.capacity = value;
+            }
+            else if (key == "fsavail")
+            {
+                _partition.freeSpace = value;
+            }
+        }
+        return true;
+    }
+};
+} // namespace
+
+const std::unordered_set<std::string> info::ProbeUtilsImpl::_DESIRED_CLASSES =
     {"multimedia", "communication", "printer", "input", "display"};
 
-putils::ProbeUtilsImpl::ProbeUtilsImpl() {}
+info::ProbeUtilsImpl::ProbeUtilsImpl(const ProbeOptions &options)
+    : _options(options), _source(options),
+      // Кэш между запусками хранит данные только живой системы
+      _bootCache(options.sysroot.empty() && options.recordPath.empty() &&
+                         options.replayPath.empty()
+                     ? options.bootCachePath
+                     : std::string()),
+      _cached_DPInfo(options.cacheTtl)
+{
+}
+
+info::ProbeUtilsImpl::~ProbeUtilsImpl() {}
 
-putils::ProbeUtilsImpl::~ProbeUtilsImpl() {}
+std::shared_ptr<const utsname> info::ProbeUtilsImpl::_uname()
+{
+    return _osinfo.get(
+        [this]()
+        {
+            utsname result;
+            std::string raw;
+            if (_source.replay(CaptureKind::Syscall, "uname", raw) &&
+                raw.size() == sizeof(utsname))
+            {
+                std::memcpy(&result, raw.data(), sizeof(utsname));
+            }
+            else
+            {
+                uname(&result);
+                ProbeTelemetry::addSyscalls(1);
+                _source.record(CaptureKind::Syscall, "uname", &result,
+                               sizeof(utsname));
+            }
+            return result;
+        });
+}
 
-info::OSInfo putils::ProbeUtilsImpl::getOSInfo()
+info::OSInfo info::ProbeUtilsImpl::getOSInfo(OSField fields)
 {
-    if (!_osinfo.has_value())
+    auto osinfo = _uname();
+    OSInfo output = {osinfo->sysname, osinfo->nodename, osinfo->release, 0};
+    if (hasFields(fields, OSField::Arch))
     {
-        _osinfo.emplace();
-        uname(&_osinfo.value());
+        output.arch = sysconf(_SC_LONG_BIT);
     }
-
-    // Для того, чтобы не писать везде .value();
-    auto &osinfo = _osinfo.value();
-    OSInfo output = {osinfo.sysname, osinfo.nodename, osinfo.release, 0};
-    output.arch = sysconf(_SC_LONG_BIT);
+    // uname кэшируется, поэтому строки заполняются всегда
+    output.fields = OSField::Name | OSField::Hostname | OSField::Kernel |
+                    (fields & OSField::Arch);
 
     return output;
 }
 
-std::vector<info::UserInfo> putils::ProbeUtilsImpl::getUserInfo()
+std::vector<info::UserInfo> info::ProbeUtilsImpl::getUserInfo()
 {
     // Не кэшируется, потому что пользователи могут добавится в
     // рантайме
 
-    std::fstream utmpFile("/var/run/utmp",
-                          std::ios_base::in | std::ios_base::binary);
-    if (!utmpFile)
+    std::string utmpFile;
+    if (!_source.readFile("/var/run/utmp", utmpFile))
     {
         return {};
     }
 
     std::vector<UserInfo> output;
-    for (utmp userEntryRaw;
-         utmpFile.read(reinterpret_cast<char *>(&userEntryRaw), sizeof(utmp));)
+    for (std::size_t pos = 0; pos + sizeof(utmp) <= utmpFile.size();
+         pos += sizeof(utmp))
     {
+        utmp userEntryRaw;
+        std::memcpy(&userEntryRaw, utmpFile.data() + pos, sizeof(utmp));
         UserInfo userEntry;
         if (userEntryRaw.ut_type == USER_PROCESS)
         {
@@ -93,95 +384,81 @@ std::vector<info::UserInfo> putils::ProbeUtilsImpl::getUserInfo()
 }
 
 std::vector<info::DiscPartitionInfo>
-putils::ProbeUtilsImpl::getDiscPartitionInfo()
+info::ProbeUtilsImpl::getDiscPartitionInfo()
 {
-    if (!_cached_DPInfo.has_value())
-    {
-        _cached_DPInfo.emplace();
-
-        std::system(
-            "lsblk --output NAME,MOUNTPOINT,FSTYPE,SIZE,FSAVAIL,FSUSED,TYPE "
-            "--json --bytes > dpinfo.json");
-
-        ifstreamWrapper dpinfo("dpinfo.json");
-        json dpinfoParsed = json::parse(dpinfo.getStream());
-
-        auto &output = _cached_DPInfo.value();
-
-        // Generic lambda для удобного извлечения значения, которое
-        // может быть null
-        auto extract = [](const json &couple, const auto defval)
-        { return !couple.is_null() ? couple.get<decltype(defval)>() : defval; };
-
-        for (const auto &disc :
-             dpinfoParsed.value("blockdevices", nlohmann::basic_json<>{}))
+    return *_cached_DPInfo.get(
+        [this]()
         {
-            for (const auto &part :
-                 disc.value("children", nlohmann::basic_json<>{}))
-            {
-                DiscPartitionInfo infoToPush{
-                    extract(part["name"], std::string{"null"}),
-                    extract(part["mountpoint"], std::string{"null"}),
-                    extract(part["fstype"], std::string{"null"}),
-                    extract(part["size"], uint64_t{0}),
-                    extract(part["fsavail"], uint64_t{0})};
-                output.push_back(infoToPush);
-            }
-        }
-    }
+            // Вывод разбирается по мере чтения из pipe, дерево JSON не
+            // строится
+            LsblkSax handler;
+            _source.runCommand("lsblk --output "
+                               "NAME,MOUNTPOINT,FSTYPE,SIZE,FSAVAIL,"
+                               "FSUSED,TYPE --json --bytes",
+                               [&handler](std::istream &stream)
+                               { json::sax_parse(stream, &handler); });
+            return handler.result();
+        },
+        // Пустой список означает, что lsblk не запустился или его вывод не
+        // разобран: такой результат не кэшируется, иначе он остался бы
+        // навсегда при бесконечном cacheTtl
+        [](const std::vector<DiscPartitionInfo> &partitions)
+        { return !partitions.empty(); });
+}
 
-    return _cached_DPInfo.value();
+std::vector<info::MountInfo>
+info::ProbeUtilsImpl::getMountInfo(const MountFilter &filter)
+{
+    return _mounts.sample(filter);
 }
 
-std::vector<info::PeripheryInfo> putils::ProbeUtilsImpl::getPeripheryInfo()
+std::vector<info::PeripheryInfo> info::ProbeUtilsImpl::getPeripheryInfo()
 {
     // Не кэшируется, потому что периферийные устройства могут быть подключены
-    // в рантаймe
-
-    std::system("lshw -json > perinfo.json");
-    ifstreamWrapper rawPerInfo("perinfo.json");
-
-    // Реализуем DFS для мощного обхода json'a
-    std::vector<PeripheryInfo> output;
-
-    std::function<void(const json &)> traverse =
-        [&traverse, &output](const json &entry)
-    {
-        // generic используется в lshw, когда не указано класса
-        auto cls = entry.value("class", std::string("generic"));
-        if (_DESIRED_CLASSES.count(cls) != 0)
+    // в рантаймe. Одновременные вызовы из разных потоков дожидаются одного
+    // запуска lshw
+    return *_perInfo.get(
+        [this]()
         {
-            std::string name;
-
-            name += entry.value("vendor", std::string()) + " ";
-            name += entry.value("product", std::string()) + " ";
-            name += "| " + entry.value("description", std::string()) + " ";
-            name += entry.value("id", std::string()) + " ";
-
-            name.pop_back();
-
-            output.push_back({name, cls});
-        }
+            std::vector<PeripheryInfo> output;
+            const uint64_t generation = _bootCache.generation();
+            if (!_bootCache.periphery(generation, output))
+            {
+                output = _readPeripheryInfo();
+                _bootCache.storePeriphery(generation, output);
+            }
+            return output;
+        });
+}
 
-        for (const auto &child :
-             entry.value("children", nlohmann::basic_json<>{}))
-        {
-            traverse(child);
-        }
-    };
+std::vector<info::PeripheryInfo> info::ProbeUtilsImpl::_readPeripheryInfo()
+{
+    // Вывод lshw на больших серверах занимает мегабайты, поэтому он
+    // разбирается по мере чтения из pipe, а дерево JSON не строится
+    LshwSax handler(_DESIRED_CLASSES);
+    _source.runCommand("lshw -json", [&handler](std::istream &stream)
+                       { json::sax_parse(stream, &handler); });
+    return handler.result();
+}
 
-    traverse(json::parse(rawPerInfo.getStream()));
-    return output;
+std::vector<info::NetworkInterfaceInfo>
+info::ProbeUtilsImpl::getNetworkInterfaceInfo()
+{
+    return *_netInfo.get([this]() { return _readNetworkInterfaceInfo(); });
 }
 
 std::vector<info::NetworkInterfaceInfo>
-putils::ProbeUtilsImpl::getNetworkInterfaceInfo()
+info::ProbeUtilsImpl::_readNetworkInterfaceInfo()
 {
-    std::system("ip -j addr show > netinfo.json");
-    ifstreamWrapper rawNInfo("netinfo.json");
+    auto rawNInfo =
+        json::parse(_source.runCommand("ip -j addr show"), nullptr, false);
+    if (rawNInfo.is_discarded())
+    {
+        return {};
+    }
 
     std::vector<NetworkInterfaceInfo> output;
-    for (const auto &interface : json::parse(rawNInfo.getStream()))
+    for (const auto &interface : rawNInfo)
     {
         NetworkInterfaceInfo curIF;
         // Такое се, нужно поменять интерфейс
@@ -242,70 +519,312 @@ putils::ProbeUtilsImpl::getNetworkInterfaceInfo()
     return output;
 }
 
-info::CPUInfo putils::ProbeUtilsImpl::getCPUInfo()
+info::CPUInfo info::ProbeUtilsImpl::getCPUInfo(CPUField fields)
 {
-    CPUInfo output;
+    CPUInfo output{};
 
-    output.l1_cache = 0;
-    output.l2_cache = 0;
-    output.l3_cache = 0;
+    // Поля, которые берутся из /proc/cpuinfo
+    constexpr CPUField basic = CPUField::Name | CPUField::Cores |
+                               CPUField::OverallCache | CPUField::PhysId |
+                               CPUField::ClockFreq;
 
-    _getCPUBasicInfo(output);
-    _getCPUCache(output);
-    _getCPULoadness(output);
+    if (hasFields(fields, CPUField::Arch))
+    {
+        output.arch = _uname()->machine;
+        output.fields = output.fields | CPUField::Arch;
+    }
+    // Частота меняется, поэтому с ней /proc/cpuinfo читается всегда
+    if ((fields & basic) != CPUField{} &&
+        (hasFields(fields, CPUField::ClockFreq) ||
+         !_bootCache.cpuBasic(output)))
+    {
+        _getCPUBasicInfo(output);
+        _bootCache.storeCPUBasic(output);
+    }
+    if (hasFields(fields, CPUField::Cache) && !_bootCache.cpuCache(output))
+    {
+        _getCPUCache(output);
+        _bootCache.storeCPUCache(output);
+    }
+    // Нулевые емкости означают, что lscpu не отработал
+    if (output.l1_cache != 0 || output.l2_cache != 0 || output.l3_cache != 0)
+    {
+        output.fields = output.fields | CPUField::Cache;
+    }
+    if (hasFields(fields, CPUField::Load))
+    {
+        _getCPULoadness(output);
+        if (!output.load.empty())
+        {
+            output.fields = output.fields | CPUField::Load;
+        }
+    }
+    // Отмечены только поля, найденные в источниках: например, на ARM в
+    // /proc/cpuinfo нет model name
+    output.fields = output.fields & fields;
 
     return output;
 }
 
-void putils::ProbeUtilsImpl::_getCPULoadness(CPUInfo &output)
+info::PerfCounterInfo info::ProbeUtilsImpl::getPerfCounterInfo()
 {
-    // Получаем загруженность процессора
-    auto getTicks = []()
+    return _perf.sample();
+}
+
+info::ThermalInfo info::ProbeUtilsImpl::getThermalInfo()
+{
+    return _thermal.sample();
+}
+
+void info::ProbeUtilsImpl::_getCPULoadness(CPUInfo &output)
+{
+    // Загруженность - доля тактов не в простое (idle и iowait)
+    for (const auto &core : _sampleCPUTimes().cores)
     {
-        std::vector<std::pair<uint64_t, uint64_t>> output;
-        std::system("cat /proc/stat | grep \"cpu\" > loadinfo.txt");
-        ifstreamWrapper st("loadinfo.txt");
+        const uint64_t all = sumTicks(core.ticks);
+        const uint64_t idle = core[CPUState::Idle] + core[CPUState::IOWait];
+        output.load.push_back(all ? static_cast<double>(all - idle) / all : 0);
+    }
+}
 
-        for (std::string line, stub; getline(st.getStream(), line);)
+info::CPUTimesInfo info::ProbeUtilsImpl::getCPUTimes()
+{
+    return _sampleCPUTimes();
+}
+
+info::CPUTimesInfo info::ProbeUtilsImpl::_sampleCPUTimes()
+{
+    std::lock_guard lock(_statMutex);
+
+    if (!_hasPrevStat)
+    {
+        _source.readFile("/proc/stat", _statBuffer);
+        _hasPrevStat = parseProcStat(_statBuffer, _prevStat);
+        // При воспроизведении паузу между чтениями задает сама запись
+        if (!_source.replaying())
         {
-            std::stringstream parsedLine(line);
-            parsedLine >> stub;
-            if (stub == "cpu")
-                continue;
+            std::this_thread::sleep_for(_options.warmupDelay);
+        }
+    }
+
+    _source.readFile("/proc/stat", _statBuffer);
+    if (!parseProcStat(_statBuffer, _curStat))
+    {
+        return _lastTimes;
+    }
+
+    CPUTimesInfo output;
+    output.total = diffCPUTimes(_prevStat.total, _curStat.total);
+
+    const uint64_t elapsed = sumTicks(output.total.ticks);
+    // Вызовы чаще такта таймера ничего нового не покажут
+    if (elapsed == 0 && !_lastTimes.cores.empty())
+    {
+        return _lastTimes;
+    }
+
+    // Процессоры сопоставляются по номеру, а не по позиции: при горячем
+    // отключении или подключении позиции остальных сдвигаются. Ядро выводит
+    // строки по возрастанию номера, поэтому списки обходятся слиянием
+    output.cores.reserve(_curStat.cores.size());
+    for (std::size_t i = 0, j = 0;
+         i < _prevStat.cores.size() && j < _curStat.cores.size();)
+    {
+        const uint32_t before = _prevStat.coreIds[i];
+        const uint32_t after = _curStat.coreIds[j];
+        if (before == after)
+        {
+            output.cores.push_back(
+                diffCPUTimes(_prevStat.cores[i], _curStat.cores[j]));
+            output.cores.back().cpu = after;
+        }
+        i += before <= after;
+        j += after <= before;
+    }
+    const std::size_t cores = output.cores.size();
+    if (cores != 0)
+    {
+        output.interval = std::chrono::duration<float>(
+            static_cast<float>(elapsed) / cores / sysconf(_SC_CLK_TCK));
+    }
+
+    std::swap(_prevStat, _curStat);
+    _lastTimes = output;
+    return output;
+}
+
+info::SchedulerInfo info::ProbeUtilsImpl::getSchedulerInfo()
+{
+    SchedulerInfo output;
+
+    // Формат: "0.38 0.60 0.40 2/72 4573"
+    std::string loadavg;
+    if (_source.readFile("/proc/loadavg", loadavg))
+    {
+        std::sscanf(loadavg.c_str(), "%f %f %f %u/%u", &output.loadAverage[0],
+                    &output.loadAverage[1], &output.loadAverage[2],
+                    &output.runnable, &output.threads);
+    }
+
+    std::lock_guard lock(_statMutex);
+
+    if (!_hasPrevSched)
+    {
+        _hasPrevSched = _readSchedSample(_prevSched);
+        if (!_source.replaying())
+        {
+            std::this_thread::sleep_for(_options.warmupDelay);
+        }
+    }
+
+    if (!_readSchedSample(_curSched))
+    {
+        return output;
+    }
+    output.procsRunning = _curStat.procsRunning;
+    output.procsBlocked = _curStat.procsBlocked;
 
-            // Числа под номерами 4,5 - такты в простое
-            uint64_t all = 0, useful = 0;
-            for (uint64_t i = 1, cur; parsedLine; ++i)
+    auto delta = [](uint64_t before, uint64_t after)
+    { return after >= before ? after - before : 0; };
+
+    // Интервал меряем тактами из /proc/stat, а не часами: так частоты
+    // остаются верными и при воспроизведении записи с любой скоростью.
+    // Вызовы чаще такта таймера возвращают предыдущие частоты
+    const uint64_t elapsed = delta(_prevSched.ticks, _curSched.ticks);
+    if (elapsed != 0 && _curSched.cores != 0)
+    {
+        const double seconds = static_cast<double>(elapsed) / _curSched.cores /
+                               sysconf(_SC_CLK_TCK);
+        _lastSched.interval = std::chrono::duration<float>(seconds);
+        _lastSched.contextSwitches =
+            delta(_prevSched.contextSwitches, _curSched.contextSwitches) /
+            seconds;
+        _lastSched.forks =
+            delta(_prevSched.processes, _curSched.processes) / seconds;
+
+        _lastSched.cores.clear();
+        const std::size_t cpus =
+            std::min(_prevSched.cpus.size(), _curSched.cpus.size());
+        for (std::size_t i = 0; i < cpus; ++i)
+        {
+            const auto &before = _prevSched.cpus[i], &after = _curSched.cpus[i];
+            if (before.cpu != after.cpu)
             {
-                parsedLine >> cur;
-                if (!(i == 4 || i == 5))
-                    useful += cur;
-                all += cur;
+                continue;
             }
-            output.emplace_back(useful, all);
+
+            const double runTime = delta(before.runTime, after.runTime) / 1e9;
+            const double runDelay =
+                delta(before.runDelay, after.runDelay) / 1e9;
+            const uint64_t slices = delta(before.timeslices, after.timeslices);
+
+            SchedCoreInfo core{};
+            core.cpu = after.cpu;
+            core.busy = runTime / seconds;
+            core.runDelay = runDelay / seconds;
+            core.timeslices = slices / seconds;
+            core.waitPerTimeslice = slices ? runDelay / slices : 0;
+            _lastSched.cores.push_back(core);
         }
 
-        return output;
-    };
+        std::swap(_prevSched, _curSched);
+    }
 
-    auto f1 = getTicks();
-    std::this_thread::sleep_for(1s);
-    auto f2 = getTicks();
+    output.interval = _lastSched.interval;
+    output.contextSwitches = _lastSched.contextSwitches;
+    output.forks = _lastSched.forks;
+    output.cores = _lastSched.cores;
+    return output;
+}
 
-    for (std::size_t i = 0; i < f2.size(); ++i)
+bool info::ProbeUtilsImpl::_readSchedSample(SchedSample &out)
+{
+    _source.readFile("/proc/stat", _statBuffer);
+    if (!parseProcStat(_statBuffer, _curStat))
     {
-        std::pair<uint64_t, uint64_t> diff = {f2[i].first - f1[i].first,
-                                              f2[i].second - f1[i].second};
-        output.load.push_back(static_cast<double>(diff.first) / diff.second);
+        return false;
     }
+    out.ticks = sumTicks(_curStat.total);
+    out.cores = _curStat.cores.size();
+    out.contextSwitches = _curStat.contextSwitches;
+    out.processes = _curStat.processes;
+
+    // /proc/schedstat есть только в ядрах с CONFIG_SCHEDSTATS
+    _source.readFile("/proc/schedstat", _schedBuffer);
+    parseSchedstat(_schedBuffer, out.cpus);
+    return true;
 }
 
-void putils::ProbeUtilsImpl::_getCPUCache(CPUInfo &output)
+void info::ProbeUtilsImpl::getInterruptInfo(InterruptInfo &output)
+{
+    std::lock_guard lock(_irqMutex);
+
+    if (!_hasPrevIrq)
+    {
+        _prevUptime = _readInterrupts(_prevIrq, _prevSoftirq);
+        _hasPrevIrq = true;
+        if (!_source.replaying())
+        {
+            std::this_thread::sleep_for(_options.warmupDelay);
+        }
+    }
+
+    const double uptime = _readInterrupts(_curIrq, _curSoftirq);
+    diffInterrupts(_prevIrq, _curIrq, output.interrupts);
+    diffInterrupts(_prevSoftirq, _curSoftirq, output.softirqs);
+    output.interval = std::chrono::duration<float>(
+        uptime > _prevUptime ? uptime - _prevUptime : 0);
+
+    _prevUptime = uptime;
+    std::swap(_prevIrq, _curIrq);
+    std::swap(_prevSoftirq, _curSoftirq);
+}
+
+double info::ProbeUtilsImpl::_readInterrupts(InterruptMatrix &irq,
+                                               InterruptMatrix &softirq)
+{
+    // Интервал меряем по /proc/uptime, чтобы он сохранялся в записи
+    double uptime = 0;
+    if (_source.readFile("/proc/uptime", _irqBuffer))
+    {
+        uptime = std::strtod(_irqBuffer.c_str(), nullptr);
+    }
+
+    _source.readFile("/proc/interrupts", _irqBuffer);
+    parseInterrupts(_irqBuffer, irq);
+    _source.readFile("/proc/softirqs", _irqBuffer);
+    parseInterrupts(_irqBuffer, softirq);
+    return uptime;
+}
+
+void info::ProbeUtilsImpl::_getCPUCache(CPUInfo &output)
 {
     // Получаем емкость кэшей
-    std::system("lscpu -C --json --bytes > cpuinfo.json");
-    ifstreamWrapper cacheInfoRaw("cpuinfo.json");
-    auto cacheInfo = json::parse(cacheInfoRaw.getStream());
+    std::string command = "lscpu -C --json --bytes";
+    if (!_options.sysroot.empty())
+    {
+        // Путь передается оболочке в одинарных кавычках, поэтому кавычки
+        // внутри него закрывают строку, экранируются и открывают ее снова
+        command += " --sysroot '";
+        for (char c : _options.sysroot)
+        {
+            if (c == '\'')
+            {
+                command += "'\\''";
+            }
+            else
+            {
+                command += c;
+            }
+        }
+        command += '\'';
+    }
+    // lscpu может не справиться с неполным sysroot: тогда кэши остаются нулевыми
+    auto cacheInfo = json::parse(_source.runCommand(command), nullptr, false);
+    if (cacheInfo.is_discarded())
+    {
+        return;
+    }
 
     for (const auto &entry :
          cacheInfo.value("caches", nlohmann::basic_json<>{}))
@@ -330,12 +849,11 @@ void putils::ProbeUtilsImpl::_getCPUCache(CPUInfo &output)
     }
 }
 
-void putils::ProbeUtilsImpl::_getCPUBasicInfo(CPUInfo &output)
+void info::ProbeUtilsImpl::_getCPUBasicInfo(CPUInfo &output)
 {
-    getOSInfo();
-    output.arch = _osinfo->machine;
-
-    std::ifstream rawCPUInfo("/proc/cpuinfo");
+    std::string raw;
+    _source.readFile("/proc/cpuinfo", raw);
+    std::istringstream rawCPUInfo(raw);
 
     // hoho haha
     int i = 0;
@@ -345,24 +863,28 @@ void putils::ProbeUtilsImpl::_getCPUBasicInfo(CPUInfo &output)
         {
             output.name =
                 std::string(line.begin() + line.find(":") + 2, line.end());
+            output.fields = output.fields | CPUField::Name;
             ++i;
         }
         else if (line.find("cpu cores") != std::string::npos)
         {
             output.cores = std::stoi(
                 std::string(line.begin() + line.find(":") + 2, line.end()));
+            output.fields = output.fields | CPUField::Cores;
             ++i;
         }
         else if (line.find("physical id") != std::string::npos)
         {
             output.physid = std::stoi(
                 std::string(line.begin() + line.find(":") + 2, line.end()));
+            output.fields = output.fields | CPUField::PhysId;
             ++i;
         }
         else if (line.find("cpu MHz") != std::string::npos)
         {
             output.clockFreq = std::stof(
                 std::string(line.begin() + line.find(":") + 2, line.end()));
+            output.fields = output.fields | CPUField::ClockFreq;
             ++i;
         }
         else if (line.find("cache size") != std::string::npos)
@@ -371,6 +893,7 @@ void putils::ProbeUtilsImpl::_getCPUBasicInfo(CPUInfo &output)
             output.overall_cache = std::stoi(
                 std::string(line.begin() + line.find(":") + 2, line.end() - 3));
             output.overall_cache *= 1024;
+            output.fields = output.fields | CPUField::OverallCache;
             ++i;
         }
         if (i == 5)
@@ -378,11 +901,30 @@ void putils::ProbeUtilsImpl::_getCPUBasicInfo(CPUInfo &output)
     }
 }
 
-info::MemoryInfo putils::ProbeUtilsImpl::getMemoryInfo()
+info::SocketInfo info::ProbeUtilsImpl::getSocketInfo()
+{
+    return _sockets.sample();
+}
+
+info::VMInfo info::ProbeUtilsImpl::getVMInfo()
+{
+    return _vm.sample();
+}
+
+std::vector<info::CgroupInfo>
+info::ProbeUtilsImpl::getCgroupInfo(const CgroupFilter &filter)
 {
-    MemoryInfo output;
-    std::ifstream cacheInfoRaw("/proc/meminfo");
-    for (std::string line, it; getline(cacheInfoRaw, line);)
+    return _cgroups.sample(filter);
+}
+
+info::MemoryInfo info::ProbeUtilsImpl::getMemoryInfo(MemoryField fields)
+{
+    MemoryInfo output{};
+    std::string raw;
+    _source.readFile("/proc/meminfo", raw);
+    std::istringstream cacheInfoRaw(raw);
+    for (std::string line, it;
+         !hasFields(output.fields, fields) && getline(cacheInfoRaw, line);)
     {
         std::stringstream lineParsed(line);
         if (line.find("MemTotal") != std::string::npos)
@@ -392,6 +934,7 @@ info::MemoryInfo putils::ProbeUtilsImpl::getMemoryInfo()
             lineParsed >> it;
             // Там все дается в килобайтах
             output.capacity = std::stoll(it) * 1024;
+            output.fields = output.fields | MemoryField::Capacity;
         }
         else if (line.find("MemAvailable") != std::string::npos)
         {
@@ -399,8 +942,7 @@ info::MemoryInfo putils::ProbeUtilsImpl::getMemoryInfo()
             lineParsed >> it;
             lineParsed >> it;
             output.freeSpace = std::stoll(it) * 1024;
-            // Дальше парсить смысла нет
-            break;
+            output.fields = output.fields | MemoryField::FreeSpace;
         }
     }
     return output;
@@ -1,4 +1,5 @@
 #include "windows.h"
+#include <ProbeTelemetry.hpp>
 #include <ProbeUtilities.hpp>
 #include <ProbeUtilsImplWin.hpp>
 #include <array>
@@ -14,15 +15,14 @@
 #include <string>
 #include <unordered_map>
 
-using putils = info::ProbeUtilities;
-putils::ProbeUtilsImpl::ProbeUtilsImpl()
+info::ProbeUtilsImpl::ProbeUtilsImpl(const ProbeOptions &)
 {
     std::cout << "compiled for windows" << std::endl;
 }
 
-putils::ProbeUtilsImpl::~ProbeUtilsImpl() {}
+info::ProbeUtilsImpl::~ProbeUtilsImpl() {}
 
-info::OSInfo putils::ProbeUtilsImpl::getOSInfo()
+info::OSInfo info::ProbeUtilsImpl::getOSInfo(OSField)
 {
     OSInfo result;
     std::string psCommand = "$os = Get-WmiObject Win32_OperatingSystem;"
@@ -49,10 +49,12 @@ info::OSInfo putils::ProbeUtilsImpl::getOSInfo()
         arch = 32;
     }
     result.arch = arch;
+    // Все поля приходят одним запросом WMI
+    result.fields = OSField::All;
     return result;
 }
 
-std::vector<info::UserInfo> putils::ProbeUtilsImpl::getUserInfo()
+std::vector<info::UserInfo> info::ProbeUtilsImpl::getUserInfo()
 {
     // используется single-user Windows
     UserInfo user;
@@ -80,7 +82,7 @@ std::vector<info::UserInfo> putils::ProbeUtilsImpl::getUserInfo()
 }
 
 std::vector<info::DiscPartitionInfo>
-putils::ProbeUtilsImpl::getDiscPartitionInfo()
+info::ProbeUtilsImpl::getDiscPartitionInfo()
 {
     std::vector<DiscPartitionInfo> partitions;
     const size_t bufferSize = 256;
@@ -124,7 +126,15 @@ putils::ProbeUtilsImpl::getDiscPartitionInfo()
     return partitions;
 }
 
-std::vector<info::PeripheryInfo> putils::ProbeUtilsImpl::getPeripheryInfo()
+std::vector<info::MountInfo>
+info::ProbeUtilsImpl::getMountInfo(const MountFilter &)
+{
+    // Точки монтирования в смысле mountinfo в Windows отсутствуют, тома
+    // перечисляет getDiscPartitionInfo()
+    return {};
+}
+
+std::vector<info::PeripheryInfo> info::ProbeUtilsImpl::getPeripheryInfo()
 {
     std::vector<info::PeripheryInfo> result;
 
@@ -173,7 +183,7 @@ std::vector<info::PeripheryInfo> putils::ProbeUtilsImpl::getPeripheryInfo()
 }
 
 std::vector<info::NetworkInterfaceInfo>
-putils::ProbeUtilsImpl::getNetworkInterfaceInfo()
+info::ProbeUtilsImpl::getNetworkInterfaceInfo()
 {
     std::vector<info::NetworkInterfaceInfo> result;
     // Берем сетевые адаптеры, для которых включена IP-конфигурация.
@@ -228,7 +238,7 @@ putils::ProbeUtilsImpl::getNetworkInterfaceInfo()
     return result;
 }
 
-info::CPUInfo putils::ProbeUtilsImpl::getCPUInfo()
+info::CPUInfo info::ProbeUtilsImpl::getCPUInfo(CPUField fields)
 {
     std::unordered_map<int, std::string> archs = {
         {0, "x86"}, {1, "MIPS"},    {2, "Alpha"}, {3, "PowerPC"},
@@ -245,9 +255,14 @@ info::CPUInfo putils::ProbeUtilsImpl::getCPUInfo()
         "$processor.ProcessorId;"
         "$processor.CurrentClockSpeed;"
         "}"
-        "(Get-CimInstance Win32_CacheMemory).InstalledSize;"
-        "(Get-WmiObject "
-        "Win32_PerfFormattedData_PerfOS_Processor).PercentProcessorTime;";
+        "(Get-CimInstance Win32_CacheMemory).InstalledSize;";
+    // Счетчики загрузки - самая медленная часть запроса
+    if (hasFields(fields, CPUField::Load))
+    {
+        psCommand += "(Get-WmiObject "
+                     "Win32_PerfFormattedData_PerfOS_Processor)"
+                     ".PercentProcessorTime;";
+    }
 
     std::istringstream WMI(_execCommand(psCommand));
     std::string line;
@@ -285,16 +300,30 @@ info::CPUInfo putils::ProbeUtilsImpl::getCPUInfo()
 
     info.overall_cache = info.l1_cache + info.l2_cache + info.l3_cache;
 
-    while (std::getline(WMI, line))
+    // Остальные поля приходят одним запросом WMI, поэтому заполняются всегда
+    info.fields = CPUField::Name | CPUField::Arch | CPUField::Cores |
+                  CPUField::Cache | CPUField::OverallCache | CPUField::PhysId |
+                  CPUField::ClockFreq;
+    if (hasFields(fields, CPUField::Load))
     {
-        info.load.push_back(std::stof(line) / 100.f);
+        while (std::getline(WMI, line))
+        {
+            info.load.push_back(std::stof(line) / 100.f);
+        }
+        info.load.pop_back(); // убираем общую загрузку ядер
+        info.fields = CPUField::All;
     }
-    info.load.pop_back(); // убираем общую загрузку ядер
 
     return info;
 }
 
-info::MemoryInfo putils::ProbeUtilsImpl::getMemoryInfo()
+info::SocketInfo info::ProbeUtilsImpl::getSocketInfo()
+{
+    // Аналог sock_diag в Windows - GetExtendedTcpTable, пока не реализовано
+    return {};
+}
+
+info::MemoryInfo info::ProbeUtilsImpl::getMemoryInfo(MemoryField)
 {
     MEMORYSTATUSEX memStatus = {};
     memStatus.dwLength = sizeof(memStatus);
@@ -307,11 +336,56 @@ info::MemoryInfo putils::ProbeUtilsImpl::getMemoryInfo()
     {
         memInfo.capacity = memStatus.ullTotalPhys;
         memInfo.freeSpace = memStatus.ullAvailPhys;
+        memInfo.fields = MemoryField::All;
     }
 
     return memInfo;
 }
-std::string putils::ProbeUtilsImpl::_execCommand(const std::string &command)
+
+info::VMInfo info::ProbeUtilsImpl::getVMInfo()
+{
+    // Счетчики освобождения и уплотнения памяти Windows не публикует
+    return {};
+}
+
+std::vector<info::CgroupInfo>
+info::ProbeUtilsImpl::getCgroupInfo(const CgroupFilter &)
+{
+    // Контрольных групп в Windows нет, ближайший аналог - Job Objects
+    return {};
+}
+
+info::CPUTimesInfo info::ProbeUtilsImpl::getCPUTimes()
+{
+    // Разбивки по состояниям, как в /proc/stat, WMI не дает
+    return {};
+}
+
+info::SchedulerInfo info::ProbeUtilsImpl::getSchedulerInfo()
+{
+    // Аналогов /proc/loadavg и /proc/schedstat в Windows нет
+    return {};
+}
+
+void info::ProbeUtilsImpl::getInterruptInfo(InterruptInfo &output)
+{
+    // Счетчиков прерываний по процессорам Windows не предоставляет
+    output = {};
+}
+
+info::ThermalInfo info::ProbeUtilsImpl::getThermalInfo()
+{
+    // Датчики доступны только через WMI-провайдеры производителей
+    return {};
+}
+
+info::PerfCounterInfo info::ProbeUtilsImpl::getPerfCounterInfo()
+{
+    // perf_event_open есть только в Linux
+    return {};
+}
+
+std::string info::ProbeUtilsImpl::_execCommand(const std::string &command)
 {
     // Создаем pipe (включены настрйки безопастности для с++17)
     SECURITY_ATTRIBUTES sa = {sizeof(SECURITY_ATTRIBUTES), nullptr, TRUE};
@@ -343,6 +417,7 @@ std::string putils::ProbeUtilsImpl::_execCommand(const std::string &command)
                        &si, // STARTUPINFO
                        &pi  // PROCESS_INFORMATION
         );
+    ProbeTelemetry::addSubprocess();
 
     // Закрываем дескриптор записи у родителя (хз, может течь походу)
     CloseHandle(hWritePipe);
@@ -379,7 +454,7 @@ std::string putils::ProbeUtilsImpl::_execCommand(const std::string &command)
 
 template <size_t N>
 std::array<uint8_t, N>
-putils::ProbeUtilsImpl::_splitLine(const std::string &mac, char delimiter,
+info::ProbeUtilsImpl::_splitLine(const std::string &mac, char delimiter,
                                    int base)
 {
     std::istringstream iss(mac);
@@ -404,7 +479,7 @@ putils::ProbeUtilsImpl::_splitLine(const std::string &mac, char delimiter,
 }
 
 std::array<uint8_t, 16>
-putils::ProbeUtilsImpl::_splitIPv6(const std::string &ipv6)
+info::ProbeUtilsImpl::_splitIPv6(const std::string &ipv6)
 {
     std::array<uint8_t, 16> result{};
     std::vector<std::string> segments;
@@ -0,0 +1,151 @@
+#include <ProcInterrupts.hpp>
+#include <ProcScanner.hpp>
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <unordered_map>
+
+namespace
+{
+const char *lineEnd(const char *pos, const char *end)
+{
+    const char *eol =
+        static_cast<const char *>(std::memchr(pos, '\n', end - pos));
+    return eol ? eol : end;
+}
+
+// Ядро хранит эти счетчики в unsigned int, поэтому они переполняются через
+// 2^32. Вычитание по модулю 2^32 дает верное приращение и после
+// переполнения
+uint64_t counterDelta(uint64_t before, uint64_t after)
+{
+    return static_cast<uint32_t>(after - before);
+}
+} // namespace
+
+bool info::parseInterrupts(const std::string &raw, InterruptMatrix &out)
+{
+    out.cpus.clear();
+
+    const char *pos = raw.data(), *end = raw.data() + raw.size();
+    const char *eol = lineEnd(pos, end);
+
+    // Заголовок: "CPU0 CPU1 ...". Отключенные процессоры в нем пропущены,
+    // поэтому номера берутся из заголовка, а не по порядку
+    for (uint64_t cpu; scanNumbers(pos, eol, &cpu, 1);)
+    {
+        out.cpus.push_back(static_cast<uint32_t>(cpu));
+    }
+    const std::size_t cols = out.cpus.size();
+    if (cols == 0)
+    {
+        out.labels.clear();
+        out.descriptions.clear();
+        out.counts.clear();
+        return false;
+    }
+
+    std::size_t rows = 0;
+    for (pos = eol + 1; pos < end; pos = eol + 1)
+    {
+        eol = lineEnd(pos, end);
+
+        while (pos < eol && *pos == ' ')
+        {
+            ++pos;
+        }
+        const char *colon =
+            static_cast<const char *>(std::memchr(pos, ':', eol - pos));
+        if (!colon)
+        {
+            continue;
+        }
+
+        if (rows == out.labels.size())
+        {
+            out.labels.emplace_back();
+            out.descriptions.emplace_back();
+        }
+        // assign переиспользует память строк, оставшуюся с прошлого разбора
+        out.labels[rows].assign(pos, colon);
+
+        out.counts.resize((rows + 1) * cols);
+        uint64_t *row = out.counts.data() + rows * cols;
+        const char *fields = colon + 1;
+        const std::size_t parsed = scanNumbers(fields, eol, row, cols);
+        std::fill(row + parsed, row + cols, 0);
+
+        // Описание есть только после полного набора счетчиков
+        auto &description = out.descriptions[rows];
+        description.clear();
+        if (parsed == cols)
+        {
+            while (fields < eol && *fields == ' ')
+            {
+                ++fields;
+            }
+            const char *last = eol;
+            while (last > fields && last[-1] == ' ')
+            {
+                --last;
+            }
+            description.assign(fields, last);
+        }
+        ++rows;
+    }
+
+    out.labels.resize(rows);
+    out.descriptions.resize(rows);
+    out.counts.resize(rows * cols);
+    return true;
+}
+
+void info::diffInterrupts(const InterruptMatrix &before,
+                          const InterruptMatrix &after, InterruptMatrix &out)
+{
+    out.labels = after.labels;
+    out.descriptions = after.descriptions;
+    out.cpus = after.cpus;
+    out.counts.resize(after.counts.size());
+
+    if (before.cpus != after.cpus)
+    {
+        std::fill(out.counts.begin(), out.counts.end(), 0);
+        return;
+    }
+
+    // Обычный случай: набор строк не изменился, и матрицы вычитаются целиком
+    if (before.labels == after.labels)
+    {
+        for (std::size_t i = 0; i < after.counts.size(); ++i)
+        {
+            out.counts[i] = counterDelta(before.counts[i], after.counts[i]);
+        }
+        return;
+    }
+
+    // Линии MSI-X появляются и исчезают при перенастройке устройств, тогда
+    // строки сопоставляются по меткам
+    const std::size_t cols = after.cpus.size();
+    std::unordered_map<std::string_view, std::size_t> previous;
+    for (std::size_t row = 0; row < before.labels.size(); ++row)
+    {
+        previous.emplace(before.labels[row], row);
+    }
+    for (std::size_t row = 0; row < after.labels.size(); ++row)
+    {
+        uint64_t *delta = out.counts.data() + row * cols;
+        auto found = previous.find(after.labels[row]);
+        if (found == previous.end())
+        {
+            std::fill(delta, delta + cols, 0);
+            continue;
+        }
+        const uint64_t *now = after.counts.data() + row * cols;
+        const uint64_t *then = before.counts.data() + found->second * cols;
+        for (std::size_t col = 0; col < cols; ++col)
+        {
+            delta[col] = counterDelta(then[col], now[col]);
+        }
+    }
+}
@@ -0,0 +1,267 @@
+#include <ProcScanner.hpp>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define __PROC_SCANNER_X86 1
+#include <immintrin.h>
+#endif
+
+namespace
+{
+inline bool isDigit(char c) { return static_cast<unsigned char>(c - '0') < 10; }
+
+// Перевод из строки до 8 цифр за раз (SWAR). Цифры заканчиваются перед
+// runEnd, перед ними в памяти должно быть доступно еще 8 - len байт
+inline uint64_t parseEight(const char *runEnd, std::size_t len)
+{
+    uint64_t val;
+    std::memcpy(&val, runEnd - 8, 8);
+    // На little-endian младшие байты соответствуют старшим разрядам: всё, что
+    // стоит перед числом, обнуляется
+    if (len < 8)
+    {
+        val &= ~uint64_t{0} << (8 * (8 - len));
+    }
+    val &= 0x0F0F0F0F0F0F0F0F;
+    val = (val * 2561) >> 8;
+    val = ((val & 0x00FF00FF00FF00FF) * 6553601) >> 16;
+    return ((val & 0x0000FFFF0000FFFF) * 42949672960001) >> 32;
+}
+
+inline uint64_t parseScalar(const char *run, std::size_t len)
+{
+    uint64_t value = 0;
+    for (std::size_t i = 0; i < len; ++i)
+    {
+        value = value * 10 + (run[i] - '0');
+    }
+    return value;
+}
+
+// Перевод числа из len цифр, начинающегося в run. begin - начало всего
+// буфера: читать память перед ним нельзя
+inline uint64_t convertRun(const char *begin, const char *run, std::size_t len)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    const std::size_t available = (run - begin) + len;
+    if (len <= 8 && available >= 8)
+    {
+        return parseEight(run + len, len);
+    }
+    if (len <= 16 && available >= 16)
+    {
+        return parseEight(run + len - 8, len - 8) * 100000000 +
+               parseEight(run + len, 8);
+    }
+#else
+    (void)begin;
+#endif
+    return parseScalar(run, len);
+}
+
+std::size_t scanScalar(const char *&p, const char *end, uint64_t *out,
+                       std::size_t max)
+{
+    std::size_t n = 0;
+    while (n < max)
+    {
+        while (p < end && !isDigit(*p))
+        {
+            ++p;
+        }
+        if (p == end)
+        {
+            break;
+        }
+
+        uint64_t value = 0;
+        for (; p < end && isDigit(*p); ++p)
+        {
+            value = value * 10 + (*p - '0');
+        }
+        out[n++] = value;
+    }
+    return n;
+}
+
+#ifdef __PROC_SCANNER_X86
+struct SSEMask
+{
+    static constexpr int WIDTH = 16;
+
+    __attribute__((target("sse2"))) static inline uint32_t
+    digits(const char *p)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        __m128i ge = _mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1));
+        __m128i le = _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1));
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(ge, le)));
+    }
+};
+
+struct AVX2Mask
+{
+    static constexpr int WIDTH = 32;
+
+    __attribute__((target("avx2"))) static inline uint32_t
+    digits(const char *p)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        __m256i ge = _mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1));
+        __m256i le = _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), v);
+        return static_cast<uint32_t>(
+            _mm256_movemask_epi8(_mm256_and_si256(ge, le)));
+    }
+};
+
+// Общий цикл по блокам. Встраивается в функции с нужным target, чтобы
+// Mask::digits тоже встроилась
+template <typename Mask>
+__attribute__((always_inline)) inline std::size_t
+scanBlocks(const char *&p, const char *end, uint64_t *out, std::size_t max)
+{
+    constexpr int W = Mask::WIDTH;
+    const char *begin = p;
+    std::size_t n = 0;
+
+    // Буфер короче блока разбирается побайтово
+    if (end - begin < W)
+    {
+        return scanScalar(p, end, out, max);
+    }
+
+    while (n < max && p < end)
+    {
+        uint32_t mask;
+        int width = W;
+        if (end - p >= W)
+        {
+            mask = Mask::digits(p);
+        }
+        else
+        {
+            // Хвост: загружаем последний полный блок буфера и отбрасываем
+            // уже разобранную часть
+            width = end - p;
+            mask = Mask::digits(end - W) >> (W - width);
+        }
+
+        if (mask == 0)
+        {
+            p += width;
+            continue;
+        }
+
+        uint32_t starts = mask & ~(mask << 1);
+        uint32_t ends = mask & ~(mask >> 1);
+        // Последнее число может продолжаться в следующем блоке
+        const bool open = end - p > width && ((mask >> (width - 1)) & 1);
+        const char *next = p + width;
+
+        while (starts)
+        {
+            const int s = __builtin_ctz(starts);
+            const int e = __builtin_ctz(ends);
+
+            if (open && e == width - 1)
+            {
+                if (s != 0)
+                {
+                    next = p + s;
+                    break;
+                }
+                // Число длиннее блока целиком
+                const char *q = p;
+                while (q < end && isDigit(*q))
+                {
+                    ++q;
+                }
+                out[n++] = convertRun(begin, p, q - p);
+                next = q;
+                break;
+            }
+
+            out[n++] = convertRun(begin, p + s, e - s + 1);
+            if (n == max)
+            {
+                next = p + e + 1;
+                break;
+            }
+            starts &= starts - 1;
+            ends &= ends - 1;
+        }
+        p = next;
+    }
+
+    return n;
+}
+
+__attribute__((target("sse2"))) std::size_t
+scanSSE(const char *&p, const char *end, uint64_t *out, std::size_t max)
+{
+    return scanBlocks<SSEMask>(p, end, out, max);
+}
+
+__attribute__((target("avx2"))) std::size_t
+scanAVX2(const char *&p, const char *end, uint64_t *out, std::size_t max)
+{
+    return scanBlocks<AVX2Mask>(p, end, out, max);
+}
+#endif
+
+bool levelSupported(info::ScanLevel level)
+{
+#ifdef __PROC_SCANNER_X86
+    switch (level)
+    {
+    case info::ScanLevel::AVX2:
+        return __builtin_cpu_supports("avx2");
+    case info::ScanLevel::SSE:
+        return __builtin_cpu_supports("sse2");
+    default:
+        return true;
+    }
+#else
+    return level == info::ScanLevel::Scalar;
+#endif
+}
+
+std::size_t dispatch(info::ScanLevel level, const char *&pos, const char *end,
+                     uint64_t *out, std::size_t max)
+{
+    switch (level)
+    {
+#ifdef __PROC_SCANNER_X86
+    case info::ScanLevel::AVX2:
+        return scanAVX2(pos, end, out, max);
+    case info::ScanLevel::SSE:
+        return scanSSE(pos, end, out, max);
+#endif
+    default:
+        return scanScalar(pos, end, out, max);
+    }
+}
+} // namespace
+
+info::ScanLevel info::bestScanLevel()
+{
+    static const ScanLevel best =
+        levelSupported(ScanLevel::AVX2)  ? ScanLevel::AVX2
+        : levelSupported(ScanLevel::SSE) ? ScanLevel::SSE
+                                         : ScanLevel::Scalar;
+    return best;
+}
+
+std::size_t info::scanNumbersWith(ScanLevel level, const char *&pos,
+                                  const char *end, uint64_t *out,
+                                  std::size_t max)
+{
+    return dispatch(levelSupported(level) ? level : ScanLevel::Scalar, pos, end,
+                    out, max);
+}
+
+std::size_t info::scanNumbers(const char *&pos, const char *end, uint64_t *out,
+                              std::size_t max)
+{
+    return dispatch(bestScanLevel(), pos, end, out, max);
+}
@@ -0,0 +1,141 @@
+#include <ProcScanner.hpp>
+#include <ProcStat.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+
+bool info::parseProcStat(const std::string &raw, ProcStatSnapshot &out)
+{
+    out.cores.clear();
+    out.coreIds.clear();
+    out.contextSwitches = out.processes = 0;
+    out.procsRunning = out.procsBlocked = 0;
+    bool found = false;
+
+    const char *pos = raw.data(), *end = raw.data() + raw.size();
+    const char *eol;
+    // Если строка начинается с key, разбирает первое число после него
+    auto scanKey = [&](const char *key, uint64_t &value)
+    {
+        const std::size_t length = std::strlen(key);
+        const char *fields = pos + length;
+        if (static_cast<std::size_t>(eol - pos) > length &&
+            std::memcmp(pos, key, length) == 0)
+        {
+            scanNumbers(fields, eol, &value, 1);
+        }
+    };
+
+    while (pos < end)
+    {
+        eol = static_cast<const char *>(std::memchr(pos, '\n', end - pos));
+        eol = eol ? eol : end;
+
+        if (eol - pos >= 4 && std::strncmp(pos, "cpu", 3) == 0)
+        {
+            // Пропускаем метку строки вместе с номером ядра
+            const char *fields =
+                static_cast<const char *>(std::memchr(pos, ' ', eol - pos));
+            fields = fields ? fields : eol;
+
+            // Старые ядра выводят меньше колонок, недостающие остаются нулями
+            CPUStateTicks ticks{};
+            scanNumbers(fields, eol, ticks.data(), ticks.size());
+            if (pos[3] == ' ')
+            {
+                out.total = ticks;
+            }
+            else
+            {
+                // Номера идут с пропусками, если часть процессоров отключена
+                out.cores.push_back(ticks);
+                out.coreIds.push_back(std::strtoul(pos + 3, nullptr, 10));
+            }
+            found = true;
+        }
+        else
+        {
+            // Длинные строки intr и softirq пропускаются целиком
+            scanKey("ctxt ", out.contextSwitches);
+            scanKey("processes ", out.processes);
+            scanKey("procs_running ", out.procsRunning);
+            scanKey("procs_blocked ", out.procsBlocked);
+        }
+
+        pos = eol + 1;
+    }
+
+    return found;
+}
+
+bool info::parseSchedstat(const std::string &raw,
+                          std::vector<SchedstatCPU> &out)
+{
+    out.clear();
+
+    const char *pos = raw.data(), *end = raw.data() + raw.size();
+    while (pos < end)
+    {
+        const char *eol =
+            static_cast<const char *>(std::memchr(pos, '\n', end - pos));
+        eol = eol ? eol : end;
+
+        // Строки "cpuN f1 ... f9"; три последних поля - время выполнения,
+        // время ожидания в очереди и количество квантов
+        if (eol - pos > 3 && std::strncmp(pos, "cpu", 3) == 0)
+        {
+            const char *fields = pos + 3;
+            uint64_t values[16];
+            const std::size_t count =
+                scanNumbers(fields, eol, values, std::size(values));
+            if (count >= 4)
+            {
+                out.push_back({static_cast<uint32_t>(values[0]),
+                               values[count - 3], values[count - 2],
+                               values[count - 1]});
+            }
+        }
+
+        pos = eol + 1;
+    }
+
+    return !out.empty();
+}
+
+uint64_t info::sumTicks(const CPUStateTicks &ticks)
+{
+    uint64_t total = 0;
+    for (std::size_t i = 0; i <= static_cast<std::size_t>(CPUState::Steal);
+         ++i)
+    {
+        total += ticks[i];
+    }
+    return total;
+}
+
+info::CPUTimes info::diffCPUTimes(const CPUStateTicks &before,
+                                  const CPUStateTicks &after)
+{
+    CPUTimes output;
+    uint64_t total = 0;
+    for (std::size_t i = 0; i < CPUTimes::STATES; ++i)
+    {
+        // Счетчики могут откатиться назад (например, при горячем отключении
+        // процессора), тогда считаем приращение нулевым
+        output.ticks[i] = after[i] >= before[i] ? after[i] - before[i] : 0;
+        if (i != static_cast<std::size_t>(CPUState::Guest) &&
+            i != static_cast<std::size_t>(CPUState::GuestNice))
+        {
+            total += output.ticks[i];
+        }
+    }
+
+    if (total != 0)
+    {
+        for (std::size_t i = 0; i < CPUTimes::STATES; ++i)
+        {
+            output.percent[i] = 100.f * output.ticks[i] / total;
+        }
+    }
+    return output;
+}
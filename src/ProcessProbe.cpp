@@ -0,0 +1,290 @@
+#include <ProcScanner.hpp>
+#include <ProcessProbe.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+#include <sys/resource.h>
+#include <thread>
+#include <unistd.h>
+
+namespace
+{
+// Поля /proc/[pid]/stat после состояния (с четвертого), нумерация с нуля
+constexpr std::size_t STAT_UTIME = 10;
+constexpr std::size_t STAT_STIME = 11;
+constexpr std::size_t STAT_PROCESSOR = 35;
+constexpr std::size_t STAT_FIELDS = STAT_PROCESSOR + 1;
+
+// Файлы stat потоков, открытые между замерами, не должны занимать больше
+// четверти дескрипторов, доступных процессу
+std::size_t pinBudget()
+{
+    std::size_t budget = info::ProcessProbe::MAX_PINNED_THREADS;
+    rlimit limit{};
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY)
+    {
+        budget = std::min<std::size_t>(budget, limit.rlim_cur / 4);
+    }
+    return budget;
+}
+
+uint64_t delta(uint64_t current, uint64_t previous)
+{
+    return current >= previous ? current - previous : 0;
+}
+
+// Разбирает строки вида "key:   value", вызывая handle для каждой
+template <typename Handler> void forEachLine(const std::string &raw, Handler handle)
+{
+    const char *pos = raw.data(), *end = raw.data() + raw.size();
+    while (pos < end)
+    {
+        const char *eol =
+            static_cast<const char *>(std::memchr(pos, '\n', end - pos));
+        eol = eol ? eol : end;
+        const char *colon =
+            static_cast<const char *>(std::memchr(pos, ':', eol - pos));
+        if (colon)
+        {
+            handle(std::string_view(pos, colon - pos),
+                   std::strtoull(colon + 1, nullptr, 10));
+        }
+        pos = eol + 1;
+    }
+}
+} // namespace
+
+info::ProcessProbe::ProcessProbe(uint32_t pid, ProbeOptions options)
+    : _pid(pid), _options(std::move(options)), _source(_options),
+      _root("/proc/" + std::to_string(pid)), _ticks(sysconf(_SC_CLK_TCK)),
+      _stat(_source, _root + "/stat"), _io(_source, _root + "/io"),
+      _smaps(_source, _root + "/smaps_rollup"), _pinBudget(pinBudget())
+{
+}
+
+bool info::ProcessProbe::parseStat(const std::string &raw, std::string &name,
+                                   char &state, uint64_t &user,
+                                   uint64_t &system, uint32_t &processor)
+{
+    // Имя может содержать пробелы и скобки, поэтому оно ограничено первой
+    // '(' и последней ')'
+    const std::size_t open = raw.find('(');
+    const std::size_t close = raw.rfind(')');
+    if (open == std::string::npos || close == std::string::npos ||
+        close < open || close + 3 >= raw.size())
+    {
+        return false;
+    }
+    name.assign(raw, open + 1, close - open - 1);
+    state = raw[close + 2];
+
+    uint64_t fields[STAT_FIELDS] = {};
+    const char *pos = raw.data() + close + 3;
+    const std::size_t count =
+        scanNumbers(pos, raw.data() + raw.size(), fields, STAT_FIELDS);
+    if (count <= STAT_STIME)
+    {
+        return false;
+    }
+    user = fields[STAT_UTIME];
+    system = fields[STAT_STIME];
+    processor = count > STAT_PROCESSOR ? fields[STAT_PROCESSOR] : 0;
+    return true;
+}
+
+void info::ProcessProbe::parseSmapsRollup(const std::string &raw,
+                                          ProcessInfo &out)
+{
+    // Значения в килобайтах: "Pss_Anon:          1234 kB"
+    forEachLine(raw,
+                [&](std::string_view key, uint64_t value)
+                {
+                    uint64_t *target = key == "Rss"        ? &out.rss
+                                       : key == "Pss"      ? &out.pss
+                                       : key == "Pss_Anon" ? &out.pssAnon
+                                       : key == "Pss_File" ? &out.pssFile
+                                       : key == "Swap"     ? &out.swap
+                                       : key == "SwapPss"  ? &out.swapPss
+                                                           : nullptr;
+                    if (target)
+                    {
+                        *target = value * 1024;
+                    }
+                });
+}
+
+info::ProcessProbe::IOCounters info::ProcessProbe::_readIO()
+{
+    IOCounters output;
+    if (_io.read(_buffer))
+    {
+        forEachLine(_buffer,
+                    [&](std::string_view key, uint64_t value)
+                    {
+                        uint64_t *target =
+                            key == "syscr"         ? &output.syscr
+                            : key == "syscw"       ? &output.syscw
+                            : key == "read_bytes"  ? &output.readBytes
+                            : key == "write_bytes" ? &output.writeBytes
+                                                   : nullptr;
+                        if (target)
+                        {
+                            *target = value;
+                        }
+                    });
+    }
+    return output;
+}
+
+void info::ProcessProbe::_readThreads(ProcessInfo &output, double seconds)
+{
+    for (auto &[tid, thread] : _threads)
+    {
+        thread.seen = false;
+    }
+
+    // Список потоков меняется, поэтому директория task читается при каждом
+    // замере, а файлы stat уже известных потоков остаются открытыми
+    for (const auto &name : _source.listSubdirectories(_root + "/task"))
+    {
+        const uint32_t tid = std::strtoul(name.c_str(), nullptr, 10);
+        auto found = _threads.find(tid);
+        if (found == _threads.end())
+        {
+            const bool pin = _pinned < _pinBudget;
+            _pinned += pin;
+            found = _threads
+                        .emplace(tid, Thread{PinnedFile(_source,
+                                                        _root + "/task/" +
+                                                            name + "/stat",
+                                                        pin)})
+                        .first;
+        }
+        Thread &thread = found->second;
+
+        ThreadInfo info{tid, {}, '?', 0};
+        uint64_t user, system;
+        if (!thread.stat.read(_buffer))
+        {
+            const int error = thread.stat.error();
+            if (error == ENOENT || error == ESRCH)
+            {
+                // Поток завершился после чтения директории
+                continue;
+            }
+            // Поток жив, но его не удалось прочитать: он остается в списке,
+            // чтобы не потерять накопленное время, и учитывается как сбой.
+            // При нехватке дескрипторов его файл больше не держится открытым
+            if ((error == EMFILE || error == ENFILE) && thread.stat.pinned())
+            {
+                thread.stat.unpin();
+                --_pinned;
+            }
+            thread.seen = true;
+            ++output.failedThreads;
+            continue;
+        }
+        if (!parseStat(_buffer, info.name, info.state, user, system,
+                       info.processor))
+        {
+            continue;
+        }
+        thread.seen = true;
+        if (seconds > 0)
+        {
+            info.user = delta(user, thread.user) / _ticks / seconds;
+            info.system = delta(system, thread.system) / _ticks / seconds;
+        }
+        thread.user = user;
+        thread.system = system;
+        output.threads.push_back(std::move(info));
+    }
+
+    for (auto it = _threads.begin(); it != _threads.end();)
+    {
+        if (it->second.seen)
+        {
+            ++it;
+            continue;
+        }
+        _pinned -= it->second.stat.pinned();
+        it = _threads.erase(it);
+    }
+
+    std::sort(output.threads.begin(), output.threads.end(),
+              [](const ThreadInfo &a, const ThreadInfo &b)
+              {
+                  return a.cpu() != b.cpu() ? a.cpu() > b.cpu()
+                                            : a.tid < b.tid;
+              });
+}
+
+info::ProcessInfo info::ProcessProbe::_measure(bool baseline)
+{
+    ProcessInfo output;
+    output.pid = _pid;
+
+    const auto now = _source.monotonic();
+    const double seconds =
+        baseline ? 0
+                 : std::chrono::duration<double>(now - _previousTime).count();
+    _previousTime = now;
+
+    char state;
+    uint64_t user, system;
+    uint32_t processor;
+    if (!_stat.read(_buffer) ||
+        !parseStat(_buffer, output.name, state, user, system, processor))
+    {
+        return output;
+    }
+    output.alive = true;
+    if (seconds > 0)
+    {
+        output.interval = std::chrono::duration<float>(seconds);
+        output.user = delta(user, _user) / _ticks / seconds;
+        output.system = delta(system, _system) / _ticks / seconds;
+    }
+    _user = user;
+    _system = system;
+
+    _readThreads(output, seconds);
+    output.fds = _source.listDirectory(_root + "/fd").size();
+
+    const IOCounters io = _readIO();
+    output.readBytes = io.readBytes;
+    output.writeBytes = io.writeBytes;
+    if (seconds > 0)
+    {
+        output.readRate = delta(io.readBytes, _ioCounters.readBytes) / seconds;
+        output.writeRate =
+            delta(io.writeBytes, _ioCounters.writeBytes) / seconds;
+        output.readCalls = delta(io.syscr, _ioCounters.syscr) / seconds;
+        output.writeCalls = delta(io.syscw, _ioCounters.syscw) / seconds;
+    }
+    _ioCounters = io;
+
+    if (_smaps.read(_buffer))
+    {
+        parseSmapsRollup(_buffer, output);
+    }
+    return output;
+}
+
+info::ProcessInfo info::ProcessProbe::sample()
+{
+    std::lock_guard lock(_mutex);
+
+    if (!_opened)
+    {
+        _opened = true;
+        _measure(true);
+        if (!_source.replaying())
+        {
+            std::this_thread::sleep_for(_options.warmupDelay);
+        }
+    }
+    return _measure(false);
+}
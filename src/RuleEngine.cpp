@@ -0,0 +1,241 @@
+#include <RuleEngine.hpp>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+bool rising(info::RuleCondition condition)
+{
+    return condition == info::RuleCondition::Above ||
+           condition == info::RuleCondition::RateAbove;
+}
+
+bool onRate(info::RuleCondition condition)
+{
+    return condition == info::RuleCondition::RateAbove ||
+           condition == info::RuleCondition::RateBelow;
+}
+
+// Разбирает длительность вида "30s", "500ms" или "5m"
+bool parseDuration(const char *text, std::chrono::milliseconds &out)
+{
+    char *end;
+    const double value = std::strtod(text, &end);
+    double scale;
+    if (end == text || !(value >= 0))
+    {
+        return false;
+    }
+    if (std::strcmp(end, "ms") == 0)
+    {
+        scale = 1;
+    }
+    else if (std::strcmp(end, "s") == 0)
+    {
+        scale = 1000;
+    }
+    else if (std::strcmp(end, "m") == 0)
+    {
+        scale = 60000;
+    }
+    else
+    {
+        return false;
+    }
+    out = std::chrono::milliseconds(std::llround(value * scale));
+    return true;
+}
+} // namespace
+
+bool info::AlertRule::parse(const std::string &spec, AlertRule &out)
+{
+    const std::size_t op = spec.find_first_of("<>");
+    if (op == std::string::npos)
+    {
+        return false;
+    }
+
+    AlertRule rule;
+    std::size_t begin = 0;
+    const std::size_t eq = spec.find('=');
+    if (eq < op)
+    {
+        rule.name = spec.substr(0, eq);
+        begin = eq + 1;
+    }
+    else
+    {
+        rule.name = spec;
+    }
+
+    rule.metric = spec.substr(begin, op - begin);
+    const bool rate = rule.metric.size() > 6 &&
+                      rule.metric.compare(0, 5, "rate(") == 0 &&
+                      rule.metric.back() == ')';
+    if (rate)
+    {
+        rule.metric = rule.metric.substr(5, rule.metric.size() - 6);
+    }
+    if (rule.metric.empty() || rule.name.empty())
+    {
+        return false;
+    }
+    const bool above = spec[op] == '>';
+    rule.condition = rate ? (above ? RuleCondition::RateAbove
+                                   : RuleCondition::RateBelow)
+                          : (above ? RuleCondition::Above : RuleCondition::Below);
+
+    const char *pos = spec.c_str() + op + 1;
+    char *end;
+    rule.threshold = std::strtod(pos, &end);
+    if (end == pos || !std::isfinite(rule.threshold))
+    {
+        return false;
+    }
+    pos = end;
+    if (*pos == '~')
+    {
+        rule.hysteresis = std::strtod(pos + 1, &end);
+        if (end == pos + 1 || !(rule.hysteresis >= 0))
+        {
+            return false;
+        }
+        pos = end;
+    }
+    if (*pos == '@')
+    {
+        if (!parseDuration(pos + 1, rule.duration))
+        {
+            return false;
+        }
+        pos += std::strlen(pos);
+    }
+    if (*pos != '\0')
+    {
+        return false;
+    }
+
+    out = std::move(rule);
+    return true;
+}
+
+std::size_t info::RuleEngine::addRule(AlertRule rule, Callback callback)
+{
+    const std::size_t id = metric(rule.metric);
+    _metrics[id].rules.push_back(_rules.size());
+    _rules.push_back(
+        {std::move(rule), std::move(callback), AlertState::Inactive, {}});
+    return _rules.size() - 1;
+}
+
+std::size_t info::RuleEngine::metric(const std::string &name)
+{
+    auto [entry, inserted] = _names.try_emplace(name, _metrics.size());
+    if (inserted)
+    {
+        _metrics.emplace_back();
+    }
+    return entry->second;
+}
+
+void info::RuleEngine::update(const std::string &metric,
+                              std::chrono::steady_clock::time_point time,
+                              double value)
+{
+    auto found = _names.find(metric);
+    if (found != _names.end())
+    {
+        update(found->second, time, value);
+    }
+}
+
+void info::RuleEngine::update(std::size_t metric,
+                              std::chrono::steady_clock::time_point time,
+                              double value)
+{
+    if (metric >= _metrics.size() || !std::isfinite(value))
+    {
+        return;
+    }
+    Metric &entry = _metrics[metric];
+
+    // Скорость считается по двум последним значениям, поэтому история не
+    // нужна
+    double rate = 0;
+    bool hasRate = false;
+    if (entry.hasValue)
+    {
+        const double seconds =
+            std::chrono::duration<double>(time - entry.time).count();
+        if (seconds > 0)
+        {
+            rate = (value - entry.value) / seconds;
+            hasRate = true;
+        }
+    }
+    entry.hasValue = true;
+    entry.time = time;
+    entry.value = value;
+
+    for (std::size_t id : entry.rules)
+    {
+        Rule &rule = _rules[id];
+        if (!onRate(rule.rule.condition))
+        {
+            _evaluate(rule, time, value);
+        }
+        else if (hasRate)
+        {
+            _evaluate(rule, time, rate);
+        }
+    }
+}
+
+void info::RuleEngine::_evaluate(Rule &rule,
+                                 std::chrono::steady_clock::time_point time,
+                                 double value)
+{
+    const AlertRule &spec = rule.rule;
+    const bool up = rising(spec.condition);
+
+    if (rule.state == AlertState::Firing)
+    {
+        const bool cleared = up ? value <= spec.threshold - spec.hysteresis
+                                : value >= spec.threshold + spec.hysteresis;
+        if (cleared)
+        {
+            rule.state = AlertState::Inactive;
+            if (rule.callback)
+            {
+                rule.callback({spec, false, time, value});
+            }
+        }
+        return;
+    }
+
+    const bool met = up ? value > spec.threshold : value < spec.threshold;
+    if (!met)
+    {
+        rule.state = AlertState::Inactive;
+        return;
+    }
+    if (rule.state == AlertState::Inactive)
+    {
+        rule.state = AlertState::Pending;
+        rule.since = time;
+    }
+    if (time - rule.since >= spec.duration)
+    {
+        rule.state = AlertState::Firing;
+        if (rule.callback)
+        {
+            rule.callback({spec, true, time, value});
+        }
+    }
+}
+
+info::AlertState info::RuleEngine::state(std::size_t rule) const
+{
+    return rule < _rules.size() ? _rules[rule].state : AlertState::Inactive;
+}
@@ -0,0 +1,229 @@
+#include <SamplingScheduler.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+info::SamplingScheduler::SamplingScheduler(std::chrono::microseconds tolerance)
+    : _tolerance(tolerance)
+{
+    // steady_clock в libstdc++ и libc++ на Linux - это CLOCK_MONOTONIC, поэтому
+    // моменты задач передаются в timerfd без пересчета
+    _timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    _wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    const int epoll = epoll_create1(EPOLL_CLOEXEC);
+    if (_timer < 0 || _wake < 0 || epoll < 0)
+    {
+        if (epoll >= 0)
+        {
+            close(epoll);
+        }
+        return;
+    }
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = _timer;
+    bool added = epoll_ctl(epoll, EPOLL_CTL_ADD, _timer, &event) == 0;
+    event.data.fd = _wake;
+    added = added && epoll_ctl(epoll, EPOLL_CTL_ADD, _wake, &event) == 0;
+    if (!added)
+    {
+        close(epoll);
+        return;
+    }
+    _epoll = epoll;
+}
+
+info::SamplingScheduler::~SamplingScheduler()
+{
+    for (int fd : {_epoll, _timer, _wake})
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+    }
+}
+
+std::size_t info::SamplingScheduler::add(std::string name,
+                                         clock::duration interval, Task task)
+{
+    Entry entry;
+    entry.name = std::move(name);
+    entry.interval = std::max(interval, clock::duration::zero());
+    entry.task = std::move(task);
+    if (_running)
+    {
+        entry.started = true;
+        entry.due = clock::now();
+    }
+    _entries.push_back(std::move(entry));
+    return _entries.size() - 1;
+}
+
+void info::SamplingScheduler::remove(std::size_t id)
+{
+    if (id < _entries.size())
+    {
+        _entries[id].active = false;
+    }
+}
+
+void info::SamplingScheduler::onOverrun(OverrunCallback callback)
+{
+    _onOverrun = std::move(callback);
+}
+
+void info::SamplingScheduler::stop()
+{
+    _stopped = true;
+    if (_wake >= 0)
+    {
+        const uint64_t one = 1;
+        [[maybe_unused]] ssize_t written = write(_wake, &one, sizeof(one));
+    }
+}
+
+info::ScheduledTaskStats info::SamplingScheduler::stats(std::size_t id) const
+{
+    return id < _entries.size() ? _entries[id].stats : ScheduledTaskStats{};
+}
+
+info::SamplingScheduler::Entry *
+info::SamplingScheduler::_nextDue(clock::time_point horizon)
+{
+    // Задач обычно единицы, поэтому достаточно просмотра всего списка.
+    // Среди наступивших первой выполняется задача с меньшим периодом
+    Entry *best = nullptr;
+    for (Entry &entry : _entries)
+    {
+        if (!entry.active || entry.due > horizon)
+        {
+            continue;
+        }
+        if (!best || entry.interval < best->interval ||
+            (entry.interval == best->interval && entry.due < best->due))
+        {
+            best = &entry;
+        }
+    }
+    return best;
+}
+
+void info::SamplingScheduler::_wait(clock::time_point deadline)
+{
+    itimerspec spec{};
+    if (deadline != clock::time_point::max())
+    {
+        using namespace std::chrono;
+        const auto since = duration_cast<nanoseconds>(deadline.time_since_epoch());
+        const auto whole = duration_cast<seconds>(since);
+        spec.it_value.tv_sec = whole.count();
+        spec.it_value.tv_nsec = (since - whole).count();
+        // Нулевое время снимает таймер, а не взводит его
+        if (spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0)
+        {
+            spec.it_value.tv_nsec = 1;
+        }
+    }
+    timerfd_settime(_timer, TFD_TIMER_ABSTIME, &spec, nullptr);
+
+    epoll_event events[2];
+    int count;
+    do
+    {
+        count = epoll_wait(_epoll, events, 2, -1);
+    } while (count < 0 && errno == EINTR);
+
+    uint64_t expirations;
+    for (int i = 0; i < count; ++i)
+    {
+        [[maybe_unused]] ssize_t got =
+            read(events[i].data.fd, &expirations, sizeof(expirations));
+    }
+}
+
+void info::SamplingScheduler::_execute(Entry &entry)
+{
+    const auto start = clock::now();
+    entry.task();
+    const auto end = clock::now();
+
+    ScheduledTaskStats &stats = entry.stats;
+    const auto lateness = std::max(start - entry.due, clock::duration::zero());
+    const auto duration = end - start;
+    ++stats.runs;
+    stats.maxLateness = std::max<std::chrono::nanoseconds>(stats.maxLateness,
+                                                           lateness);
+    stats.lastDuration = duration;
+    stats.maxDuration =
+        std::max<std::chrono::nanoseconds>(stats.maxDuration, duration);
+
+    if (entry.interval == clock::duration::zero())
+    {
+        entry.active = false;
+        return;
+    }
+
+    // Следующий момент берется из сетки от общего начала, а не от времени
+    // окончания замера, поэтому задержки не сдвигают расписание
+    const auto interval = entry.interval;
+    auto next = _epoch + ((entry.due - _epoch) / interval + 1) * interval;
+    if (next <= end)
+    {
+        const uint64_t missed = (end - next) / interval + 1;
+        next += missed * interval;
+        stats.missed += missed;
+        if (_onOverrun)
+        {
+            _onOverrun({entry.name, missed, lateness, duration});
+        }
+    }
+    entry.due = next;
+}
+
+void info::SamplingScheduler::run()
+{
+    if (!valid())
+    {
+        return;
+    }
+    _running = true;
+    _epoch = clock::now();
+    for (Entry &entry : _entries)
+    {
+        if (!entry.started)
+        {
+            entry.started = true;
+            entry.due = _epoch;
+        }
+    }
+
+    while (!_stopped)
+    {
+        // Задачи, моменты которых наступят в пределах _tolerance,
+        // выполняются в этом же пробуждении. После каждой задачи очередь
+        // пересматривается, чтобы долгий замер не задерживал частые задачи
+        if (Entry *entry = _nextDue(clock::now() + _tolerance))
+        {
+            _execute(*entry);
+            continue;
+        }
+
+        auto deadline = clock::time_point::max();
+        for (const Entry &entry : _entries)
+        {
+            if (entry.active && entry.due < deadline)
+            {
+                deadline = entry.due;
+            }
+        }
+        _wait(deadline);
+    }
+
+    _running = false;
+    _stopped = false;
+}
@@ -0,0 +1,249 @@
+#include <SharedSnapshot.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace info
+{
+/**
+ * @brief Содержимое сегмента разделяемой памяти
+ */
+struct SnapshotSegment
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t size; ///< sizeof(SnapshotSegment) у издателя
+
+    /**
+     * @brief Счетчик seqlock: нечетный, пока издатель пишет data
+     */
+    std::atomic<uint64_t> sequence;
+
+    SnapshotData data;
+};
+} // namespace info
+
+namespace
+{
+constexpr char MAGIC[8] = {'S', 'P', 'S', 'H', 'M', 0, 0, 0};
+constexpr uint32_t VERSION = 1;
+
+// Издатель держит счетчик нечетным несколько микросекунд. Если он
+// завершился посреди записи, счетчик не станет четным никогда
+constexpr int READ_ATTEMPTS = 1000;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "seqlock в разделяемой памяти требует атомиков без блокировок");
+
+// shm_open ожидает имя вида "/name"
+std::string segmentName(std::string name)
+{
+    if (name.empty() || name.front() != '/')
+    {
+        name.insert(name.begin(), '/');
+    }
+    return name;
+}
+
+void copyString(char *destination, std::size_t size, const std::string &source)
+{
+    std::size_t length = std::min(source.size(), size - 1);
+    std::memcpy(destination, source.data(), length);
+    std::memset(destination + length, 0, size - length);
+}
+} // namespace
+
+info::CPUInfo info::SnapshotData::cpuInfo() const
+{
+    CPUInfo output{};
+    output.name.assign(cpuName, strnlen(cpuName, sizeof(cpuName)));
+    output.arch.assign(cpuArch, strnlen(cpuArch, sizeof(cpuArch)));
+    output.cores = cores;
+    output.load.assign(load, load + std::min<std::size_t>(loadCount, MAX_CORES));
+    output.l1_cache = l1_cache;
+    output.l2_cache = l2_cache;
+    output.l3_cache = l3_cache;
+    output.overall_cache = overall_cache;
+    output.physid = physid;
+    output.clockFreq = clockFreq;
+    output.fields = cpuFields;
+    return output;
+}
+
+info::MemoryInfo info::SnapshotData::memoryInfo() const
+{
+    return {memoryCapacity, memoryFree, memoryFields};
+}
+
+info::SnapshotPublisher::SnapshotPublisher(std::string name,
+                                           ProbeOptions options)
+    : _name(segmentName(std::move(name))), _probe(options)
+{
+    // Неизменяемые поля читаются один раз. Загрузка запрашивается здесь же,
+    // чтобы первая публикация уже считалась за интервал
+    _static = _probe.getCPUInfo(CPUField::Name | CPUField::Arch |
+                                CPUField::Cores | CPUField::Cache |
+                                CPUField::OverallCache | CPUField::PhysId |
+                                CPUField::Load);
+
+    int fd = shm_open(_name.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0)
+    {
+        return;
+    }
+    if (ftruncate(fd, sizeof(SnapshotSegment)) != 0)
+    {
+        close(fd);
+        return;
+    }
+    void *memory = mmap(nullptr, sizeof(SnapshotSegment),
+                        PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED)
+    {
+        return;
+    }
+
+    // Сегмент мог остаться от издателя, завершившегося посреди записи
+    _segment = static_cast<SnapshotSegment *>(memory);
+    _segment->sequence.store(0, std::memory_order_relaxed);
+    std::memset(&_segment->data, 0, sizeof(SnapshotData));
+    _segment->version = VERSION;
+    _segment->size = sizeof(SnapshotSegment);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(_segment->magic, MAGIC, sizeof(MAGIC));
+}
+
+info::SnapshotPublisher::~SnapshotPublisher()
+{
+    if (_segment)
+    {
+        munmap(_segment, sizeof(SnapshotSegment));
+        shm_unlink(_name.c_str());
+    }
+}
+
+bool info::SnapshotPublisher::publish()
+{
+    if (!_segment)
+    {
+        return false;
+    }
+
+    // Замеры выполняются до входа в seqlock, чтобы читатели не ждали их
+    CPUInfo cpu = _probe.getCPUInfo(CPUField::Load | CPUField::ClockFreq);
+    MemoryInfo memory = _probe.getMemoryInfo();
+    auto now = std::chrono::system_clock::now();
+
+    uint64_t sequence = _segment->sequence.load(std::memory_order_relaxed);
+    _segment->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    SnapshotData &data = _segment->data;
+    data.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         now.time_since_epoch())
+                         .count();
+    ++data.published;
+    data.cpuFields = _static.fields | cpu.fields;
+    data.memoryFields = memory.fields;
+    copyString(data.cpuName, sizeof(data.cpuName), _static.name);
+    copyString(data.cpuArch, sizeof(data.cpuArch), _static.arch);
+    data.cores = _static.cores;
+    data.loadCount = std::min(cpu.load.size(), SnapshotData::MAX_CORES);
+    std::copy_n(cpu.load.begin(), data.loadCount, data.load);
+    data.l1_cache = _static.l1_cache;
+    data.l2_cache = _static.l2_cache;
+    data.l3_cache = _static.l3_cache;
+    data.overall_cache = _static.overall_cache;
+    data.physid = _static.physid;
+    data.clockFreq = cpu.clockFreq;
+    data.memoryCapacity = memory.capacity;
+    data.memoryFree = memory.freeSpace;
+
+    _segment->sequence.store(sequence + 2, std::memory_order_release);
+    return true;
+}
+
+info::SnapshotReader::SnapshotReader(const std::string &name)
+{
+    int fd = shm_open(segmentName(name).c_str(), O_RDONLY, 0);
+    if (fd < 0)
+    {
+        return;
+    }
+    struct stat status;
+    if (fstat(fd, &status) != 0 ||
+        static_cast<std::size_t>(status.st_size) < sizeof(SnapshotSegment))
+    {
+        close(fd);
+        return;
+    }
+    void *memory = mmap(nullptr, sizeof(SnapshotSegment), PROT_READ,
+                        MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED)
+    {
+        return;
+    }
+
+    auto segment = static_cast<const SnapshotSegment *>(memory);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (std::memcmp(segment->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        segment->version != VERSION ||
+        segment->size != sizeof(SnapshotSegment))
+    {
+        munmap(memory, sizeof(SnapshotSegment));
+        return;
+    }
+    _segment = segment;
+}
+
+info::SnapshotReader::~SnapshotReader()
+{
+    if (_segment)
+    {
+        munmap(const_cast<SnapshotSegment *>(_segment),
+               sizeof(SnapshotSegment));
+    }
+}
+
+bool info::SnapshotReader::read(SnapshotData &output) const
+{
+    if (!_segment)
+    {
+        return false;
+    }
+    for (int attempt = 0; attempt < READ_ATTEMPTS; ++attempt)
+    {
+        uint64_t before = _segment->sequence.load(std::memory_order_acquire);
+        if (before & 1)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        std::memcpy(&output, &_segment->data, sizeof(SnapshotData));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (_segment->sequence.load(std::memory_order_relaxed) == before)
+        {
+            return output.published != 0;
+        }
+    }
+    return false;
+}
+
+info::CPUInfo info::SnapshotReader::getCPUInfo() const
+{
+    SnapshotData data;
+    return read(data) ? data.cpuInfo() : CPUInfo{};
+}
+
+info::MemoryInfo info::SnapshotReader::getMemoryInfo() const
+{
+    SnapshotData data;
+    return read(data) ? data.memoryInfo() : MemoryInfo{};
+}
@@ -0,0 +1,303 @@
+#include <ProbeTelemetry.hpp>
+#include <SocketProbe.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <linux/inet_diag.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/sock_diag.h>
+#include <linux/unix_diag.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace
+{
+// Ядро отдает порции дампа размером не больше страницы на сообщение, но
+// несколько сообщений за раз; больший буфер уменьшает число recv
+constexpr std::size_t RECEIVE_BUFFER = 64 * 1024;
+
+constexpr uint32_t ALL_STATES = ~0u;
+
+struct InetRequest
+{
+    nlmsghdr header;
+    inet_diag_req_v2 body;
+};
+
+struct UnixRequest
+{
+    nlmsghdr header;
+    unix_diag_req body;
+};
+
+nlmsghdr dumpHeader(std::size_t size)
+{
+    nlmsghdr header{};
+    header.nlmsg_len = size;
+    header.nlmsg_type = SOCK_DIAG_BY_FAMILY;
+    header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    return header;
+}
+
+bool isZero(const uint32_t *address, std::size_t words)
+{
+    return std::all_of(address, address + words,
+                       [](uint32_t word) { return word == 0; });
+}
+} // namespace
+
+std::size_t
+info::SocketProbe::SubnetHash::operator()(const Subnet &subnet) const
+{
+    uint64_t high, low;
+    std::memcpy(&high, subnet.address.data(), sizeof(high));
+    std::memcpy(&low, subnet.address.data() + 8, sizeof(low));
+    return std::hash<uint64_t>()(high ^ (low * 0x9e3779b97f4a7c15ull) ^
+                                 subnet.ipv6);
+}
+
+info::SocketProbe::SocketProbe(ProbeSource &source)
+    : _source(source), _tcpPorts(65536), _udpPorts(65536)
+{
+}
+
+template <typename Handler>
+bool info::SocketProbe::_dump(const void *request, std::size_t size,
+                              const std::string &key, Handler &&handle)
+{
+    // Разбирает одну порцию ответа. Возвращает false на NLMSG_DONE и ошибке
+    auto consume = [&handle](const char *data, std::size_t length)
+    {
+        auto *message = reinterpret_cast<const nlmsghdr *>(data);
+        for (int left = length; NLMSG_OK(message, left);
+             message = NLMSG_NEXT(message, left))
+        {
+            if (message->nlmsg_type == NLMSG_DONE ||
+                message->nlmsg_type == NLMSG_ERROR)
+            {
+                return false;
+            }
+            handle(message);
+        }
+        return true;
+    };
+
+    if (_source.replaying())
+    {
+        while (_source.replay(CaptureKind::Netlink, key, _buffer) &&
+               consume(_buffer.data(), _buffer.size()))
+        {
+        }
+        return true;
+    }
+
+    int fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_SOCK_DIAG);
+    ProbeTelemetry::addSyscalls(1);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    sockaddr_nl kernel{};
+    kernel.nl_family = AF_NETLINK;
+    bool sent = sendto(fd, request, size, 0,
+                       reinterpret_cast<sockaddr *>(&kernel),
+                       sizeof(kernel)) == static_cast<ssize_t>(size);
+    ProbeTelemetry::addSyscalls(1);
+
+    _buffer.resize(RECEIVE_BUFFER);
+    for (bool more = sent; more;)
+    {
+        ssize_t n = recv(fd, _buffer.data(), _buffer.size(), 0);
+        ProbeTelemetry::addSyscalls(1);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            break;
+        }
+        ProbeTelemetry::addBytes(n);
+        _source.record(CaptureKind::Netlink, key, _buffer.data(), n);
+        more = consume(_buffer.data(), n);
+    }
+
+    close(fd);
+    ProbeTelemetry::addSyscalls(1);
+    return sent;
+}
+
+void info::SocketProbe::_countRemote(uint8_t family, const uint32_t *address)
+{
+    // Подсети: /24 для IPv4 и /64 для IPv6
+    Subnet subnet{};
+    subnet.ipv6 = family == AF_INET6;
+    // IPv4-клиенты двухстековых сокетов приходят как ::ffff:a.b.c.d, и без
+    // этой проверки все они попали бы в одну подсеть ::/64
+    if (subnet.ipv6 && address[0] == 0 && address[1] == 0 &&
+        address[2] == htonl(0xffff))
+    {
+        subnet.ipv6 = false;
+        address += 3;
+    }
+    std::memcpy(subnet.address.data(), address, subnet.ipv6 ? 8 : 3);
+    ++_subnets[subnet];
+}
+
+void info::SocketProbe::_dumpInet(uint8_t family, uint8_t protocol,
+                                  SocketInfo &output)
+{
+    InetRequest request{};
+    request.header = dumpHeader(sizeof(request));
+    request.body.sdiag_family = family;
+    request.body.sdiag_protocol = protocol;
+    request.body.idiag_states = ALL_STATES;
+    if (protocol == IPPROTO_TCP)
+    {
+        request.body.idiag_ext = 1 << (INET_DIAG_INFO - 1);
+    }
+
+    const bool tcp = protocol == IPPROTO_TCP;
+    const std::size_t words = family == AF_INET6 ? 4 : 1;
+    uint64_t &total = tcp ? (family == AF_INET6 ? output.tcp6 : output.tcp4)
+                          : (family == AF_INET6 ? output.udp6 : output.udp4);
+    auto &ports = tcp ? _tcpPorts : _udpPorts;
+
+    std::string key = "sock_diag:";
+    key += tcp ? "tcp" : "udp";
+    key += family == AF_INET6 ? '6' : '4';
+
+    _dump(&request, sizeof(request), key,
+          [&](const nlmsghdr *message)
+          {
+              if (message->nlmsg_len < NLMSG_LENGTH(sizeof(inet_diag_msg)))
+              {
+                  return;
+              }
+              auto *diag =
+                  static_cast<const inet_diag_msg *>(NLMSG_DATA(message));
+              ++total;
+              ++ports[ntohs(diag->id.idiag_sport)];
+
+              if (tcp && diag->idiag_state ==
+                             static_cast<uint8_t>(TCPState::Listen))
+              {
+                  // Для слушающего сокета rqueue - длина очереди accept,
+                  // wqueue - ее предел (backlog). Как и sk_acceptq_is_full в
+                  // ядре, очередь считается переполненной, только когда
+                  // длина превысила предел
+                  output.acceptQueue += diag->idiag_rqueue;
+                  output.fullAcceptQueues +=
+                      diag->idiag_rqueue > diag->idiag_wqueue;
+              }
+              else
+              {
+                  output.receiveQueue += diag->idiag_rqueue;
+                  output.sendQueue += diag->idiag_wqueue;
+                  if (!isZero(diag->id.idiag_dst, words))
+                  {
+                      _countRemote(family, diag->id.idiag_dst);
+                  }
+              }
+              if (!tcp)
+              {
+                  return;
+              }
+
+              if (diag->idiag_state < output.tcpStates.size())
+              {
+                  ++output.tcpStates[diag->idiag_state];
+              }
+
+              // Атрибуты идут сразу за inet_diag_msg
+              int left = message->nlmsg_len - NLMSG_LENGTH(sizeof(*diag));
+              for (auto *attr = reinterpret_cast<const rtattr *>(diag + 1);
+                   RTA_OK(attr, left); attr = RTA_NEXT(attr, left))
+              {
+                  if (attr->rta_type != INET_DIAG_INFO)
+                  {
+                      continue;
+                  }
+                  // Старые ядра отдают укороченную tcp_info
+                  tcp_info info{};
+                  std::memcpy(&info, RTA_DATA(attr),
+                              std::min<std::size_t>(RTA_PAYLOAD(attr),
+                                                    sizeof(info)));
+                  output.retransmitting += info.tcpi_retransmits != 0;
+                  output.totalRetransmits += info.tcpi_total_retrans;
+              }
+          });
+}
+
+void info::SocketProbe::_dumpUnix(SocketInfo &output)
+{
+    UnixRequest request{};
+    request.header = dumpHeader(sizeof(request));
+    request.body.sdiag_family = AF_UNIX;
+    request.body.udiag_states = ALL_STATES;
+
+    _dump(&request, sizeof(request), "sock_diag:unix",
+          [&output](const nlmsghdr *message)
+          {
+              if (message->nlmsg_len < NLMSG_LENGTH(sizeof(unix_diag_msg)))
+              {
+                  return;
+              }
+              auto *diag =
+                  static_cast<const unix_diag_msg *>(NLMSG_DATA(message));
+              switch (diag->udiag_type)
+              {
+              case SOCK_STREAM:
+                  ++output.unixStream;
+                  break;
+              case SOCK_DGRAM:
+                  ++output.unixDgram;
+                  break;
+              case SOCK_SEQPACKET:
+                  ++output.unixSeqpacket;
+                  break;
+              }
+          });
+}
+
+info::SocketInfo info::SocketProbe::sample()
+{
+    std::lock_guard lock(_mutex);
+
+    std::fill(_tcpPorts.begin(), _tcpPorts.end(), 0);
+    std::fill(_udpPorts.begin(), _udpPorts.end(), 0);
+    _subnets.clear();
+
+    SocketInfo output;
+    for (uint8_t family : {AF_INET, AF_INET6})
+    {
+        _dumpInet(family, IPPROTO_TCP, output);
+        _dumpInet(family, IPPROTO_UDP, output);
+    }
+    _dumpUnix(output);
+
+    for (uint32_t port = 0; port < _tcpPorts.size(); ++port)
+    {
+        if (_tcpPorts[port] || _udpPorts[port])
+        {
+            output.localPorts.push_back({static_cast<uint16_t>(port),
+                                         _tcpPorts[port], _udpPorts[port]});
+        }
+    }
+
+    output.remoteSubnets.reserve(_subnets.size());
+    for (const auto &[subnet, sockets] : _subnets)
+    {
+        output.remoteSubnets.push_back(
+            {subnet.address, subnet.ipv6,
+             static_cast<uint8_t>(subnet.ipv6 ? 64 : 24), sockets});
+    }
+    std::sort(output.remoteSubnets.begin(), output.remoteSubnets.end(),
+              [](const SocketSubnetStats &a, const SocketSubnetStats &b)
+              { return a.sockets > b.sockets; });
+    return output;
+}
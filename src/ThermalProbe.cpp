@@ -0,0 +1,213 @@
+#include <ThermalProbe.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <thread>
+
+namespace
+{
+bool startsWith(const std::string &s, const char *prefix)
+{
+    return s.rfind(prefix, 0) == 0;
+}
+
+bool endsWith(const std::string &s, const std::string &suffix)
+{
+    return s.size() >= suffix.size() &&
+           s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+} // namespace
+
+info::ThermalProbe::ThermalProbe(ProbeSource &source,
+                                 std::chrono::milliseconds warmup)
+    : _source(source), _warmup(warmup)
+{
+}
+
+std::string info::ThermalProbe::_readLine(const std::string &path)
+{
+    if (!_source.readFile(path, _buffer))
+    {
+        return {};
+    }
+    while (!_buffer.empty() &&
+           (_buffer.back() == '\n' || _buffer.back() == ' '))
+    {
+        _buffer.pop_back();
+    }
+    return _buffer;
+}
+
+bool info::ThermalProbe::_readNumber(PinnedFile &file, int64_t &out)
+{
+    if (!file.read(_buffer) || _buffer.empty())
+    {
+        return false;
+    }
+    char *end;
+    out = std::strtoll(_buffer.c_str(), &end, 10);
+    return end != _buffer.c_str();
+}
+
+void info::ThermalProbe::_openHwmon(const std::string &dir)
+{
+    const std::string chip = _readLine(dir + "/name");
+
+    // Интересны файлы tempN_input (миллиградусы) и fanN_input (об/мин)
+    for (const auto &file : _source.listDirectory(dir))
+    {
+        const bool temperature = startsWith(file, "temp");
+        if ((!temperature && !startsWith(file, "fan")) ||
+            !endsWith(file, "_input"))
+        {
+            continue;
+        }
+
+        const std::string sensor = file.substr(0, file.size() - 6);
+        std::string label = _readLine(dir + "/" + sensor + "_label");
+        HwmonSensor entry{{chip, label.empty() ? sensor : label, 0},
+                          PinnedFile(_source, dir + "/" + file),
+                          temperature ? 1e-3f : 1.f};
+        (temperature ? _temperatures : _fans).push_back(std::move(entry));
+    }
+}
+
+void info::ThermalProbe::_open()
+{
+    _opened = true;
+
+    for (const auto &name : _source.listDirectory("/sys/class/thermal"))
+    {
+        if (startsWith(name, "thermal_zone"))
+        {
+            const std::string dir = "/sys/class/thermal/" + name;
+            _zones.push_back({{name, _readLine(dir + "/type"), 0},
+                              PinnedFile(_source, dir + "/temp")});
+        }
+    }
+
+    for (const auto &name : _source.listDirectory("/sys/class/hwmon"))
+    {
+        _openHwmon("/sys/class/hwmon/" + name);
+    }
+
+    // Сами директории intel-rapl и intel-rapl-mmio - типы управления, а не
+    // домены, у них нет счетчика энергии. Часть клиентских платформ отдает
+    // домен пакета только через MMIO, а где он есть в обоих интерфейсах, это
+    // один и тот же счетчик: домены MMIO с уже найденным через MSR именем
+    // пропускаются
+    const auto zones = _source.listDirectory("/sys/class/powercap");
+    std::vector<std::string> domains;
+    for (const char *prefix : {"intel-rapl:", "intel-rapl-mmio:"})
+    {
+        for (const auto &name : zones)
+        {
+            if (startsWith(name, prefix))
+            {
+                domains.push_back(name);
+            }
+        }
+    }
+
+    for (const auto &name : domains)
+    {
+        const std::string dir = "/sys/class/powercap/" + name;
+        std::string domain = _readLine(dir + "/name");
+        if (startsWith(name, "intel-rapl-mmio:") &&
+            std::any_of(_power.begin(), _power.end(),
+                        [&domain](const PowerZone &zone)
+                        { return zone.info.name == domain; }))
+        {
+            continue;
+        }
+        PowerZone zone{{std::move(domain), name, 0},
+                       PinnedFile(_source, dir + "/energy_uj"),
+                       std::strtoull(
+                           _readLine(dir + "/max_energy_range_uj").c_str(),
+                           nullptr, 10),
+                       0};
+
+        // Без прав на чтение счетчика домен не показываем
+        int64_t energy;
+        if (_readNumber(zone.energy, energy))
+        {
+            zone.previous = energy;
+            _power.push_back(std::move(zone));
+        }
+    }
+}
+
+info::ThermalInfo info::ThermalProbe::sample()
+{
+    std::lock_guard lock(_mutex);
+
+    if (!_opened)
+    {
+        _open();
+        _previousTime = _source.monotonic();
+        if (!_power.empty() && !_source.replaying())
+        {
+            std::this_thread::sleep_for(_warmup);
+        }
+    }
+
+    ThermalInfo output;
+    int64_t value;
+
+    for (auto &zone : _zones)
+    {
+        if (_readNumber(zone.temp, value))
+        {
+            zone.info.temperature = value * 1e-3f;
+            output.zones.push_back(zone.info);
+        }
+    }
+
+    auto readSensors = [&](std::vector<HwmonSensor> &sensors,
+                           std::vector<HwmonSensorInfo> &out)
+    {
+        for (auto &sensor : sensors)
+        {
+            if (_readNumber(sensor.input, value))
+            {
+                sensor.info.value = value * sensor.scale;
+                out.push_back(sensor.info);
+            }
+        }
+    };
+    readSensors(_temperatures, output.temperatures);
+    readSensors(_fans, output.fans);
+
+    const auto now = _source.monotonic();
+    const double seconds =
+        std::chrono::duration<double>(now - _previousTime).count();
+    _previousTime = now;
+    output.interval = std::chrono::duration<float>(seconds);
+
+    for (auto &zone : _power)
+    {
+        if (!_readNumber(zone.energy, value))
+        {
+            continue;
+        }
+        const uint64_t energy = value;
+        const uint64_t previous = zone.previous;
+        zone.previous = energy;
+        // Счетчик переполняется при достижении max_energy_range_uj. Если
+        // предел неизвестен или разность с его учетом больше самого предела
+        // (счетчик сброшен), мощность за этот интервал не определена
+        uint64_t delta = energy - previous;
+        if (energy < previous)
+        {
+            delta = energy + (zone.maxRange - previous);
+            if (zone.maxRange == 0 || previous > zone.maxRange ||
+                delta > zone.maxRange)
+            {
+                continue;
+            }
+        }
+        zone.info.power = seconds > 0 ? delta * 1e-6 / seconds : 0;
+        output.power.push_back(zone.info);
+    }
+
+    return output;
+}
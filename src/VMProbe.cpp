@@ -0,0 +1,330 @@
+#include <ProcScanner.hpp>
+#include <VMProbe.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+#include <thread>
+
+namespace
+{
+struct VMKey
+{
+    std::string_view name;
+    info::VMCounter counter;
+};
+
+using info::VMCounter;
+
+// Таблица отсортирована по имени для двоичного поиска. Несколько ключей
+// могут относиться к одному счетчику: до 4.10 allocstall был один на все
+// зоны
+constexpr VMKey VM_KEYS[] = {
+    {"allocstall", VMCounter::AllocStall},
+    {"allocstall_device", VMCounter::AllocStall},
+    {"allocstall_dma", VMCounter::AllocStall},
+    {"allocstall_dma32", VMCounter::AllocStall},
+    {"allocstall_movable", VMCounter::AllocStall},
+    {"allocstall_normal", VMCounter::AllocStall},
+    {"compact_fail", VMCounter::CompactFail},
+    {"compact_stall", VMCounter::CompactStall},
+    {"compact_success", VMCounter::CompactSuccess},
+    {"oom_kill", VMCounter::OomKill},
+    {"pgfault", VMCounter::PgFault},
+    {"pgmajfault", VMCounter::PgMajFault},
+    {"pgscan_direct", VMCounter::PgscanDirect},
+    {"pgscan_kswapd", VMCounter::PgscanKswapd},
+    {"pgsteal_direct", VMCounter::PgstealDirect},
+    {"pgsteal_kswapd", VMCounter::PgstealKswapd},
+    {"pswpin", VMCounter::PswpIn},
+    {"pswpout", VMCounter::PswpOut},
+    {"thp_collapse_alloc", VMCounter::ThpCollapseAlloc},
+    {"thp_fault_alloc", VMCounter::ThpFaultAlloc},
+    {"thp_fault_fallback", VMCounter::ThpFaultFallback},
+    {"thp_split_page", VMCounter::ThpSplitPage},
+};
+
+constexpr bool keysSorted()
+{
+    for (std::size_t i = 1; i < std::size(VM_KEYS); ++i)
+    {
+        if (!(VM_KEYS[i - 1].name < VM_KEYS[i].name))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+static_assert(keysSorted(), "VM_KEYS must be sorted by name");
+
+const VMKey *findKey(std::string_view name)
+{
+    const VMKey *key = std::lower_bound(
+        std::begin(VM_KEYS), std::end(VM_KEYS), name,
+        [](const VMKey &entry, std::string_view value)
+        { return entry.name < value; });
+    return key != std::end(VM_KEYS) && key->name == name ? key : nullptr;
+}
+
+const char *skipSpaces(const char *pos, const char *end)
+{
+    while (pos < end && *pos == ' ')
+    {
+        ++pos;
+    }
+    return pos;
+}
+
+const char *lineEnd(const char *pos, const char *end)
+{
+    const char *eol =
+        static_cast<const char *>(std::memchr(pos, '\n', end - pos));
+    return eol ? eol : end;
+}
+
+// Разбирает заголовок "Node 0, zone   Normal" из buddyinfo и zoneinfo.
+// После вызова pos указывает на конец имени зоны
+bool parseZoneHeader(const char *&pos, const char *eol, uint32_t &node,
+                     std::string_view &zone)
+{
+    if (eol - pos < 5 || std::memcmp(pos, "Node ", 5) != 0)
+    {
+        return false;
+    }
+    char *next;
+    node = std::strtoul(pos + 5, &next, 10);
+    const char *label = static_cast<const char *>(
+        std::memchr(next, 'z', eol - next));
+    if (!label || eol - label < 5 || std::memcmp(label, "zone ", 5) != 0)
+    {
+        return false;
+    }
+    const char *name = skipSpaces(label + 5, eol);
+    const char *nameEnd = name;
+    while (nameEnd < eol && *nameEnd != ' ')
+    {
+        ++nameEnd;
+    }
+    zone = std::string_view(name, nameEnd - name);
+    pos = nameEnd;
+    return true;
+}
+} // namespace
+
+info::VMProbe::VMProbe(ProbeSource &source, std::chrono::milliseconds warmup)
+    : _source(source), _warmup(warmup)
+{
+}
+
+void info::VMProbe::parseVmstat(const std::string &raw, VMCounters &out)
+{
+    out.fill(0);
+
+    const char *pos = raw.data(), *end = raw.data() + raw.size();
+    while (pos < end)
+    {
+        const char *eol = lineEnd(pos, end);
+        const char *space =
+            static_cast<const char *>(std::memchr(pos, ' ', eol - pos));
+        if (space)
+        {
+            // Большая часть строк - nr_*, в таблице их нет
+            const VMKey *key = findKey(std::string_view(pos, space - pos));
+            if (key)
+            {
+                uint64_t value = 0;
+                scanNumbers(space, eol, &value, 1);
+                out[static_cast<std::size_t>(key->counter)] += value;
+            }
+        }
+        pos = eol + 1;
+    }
+}
+
+void info::VMProbe::parseBuddyinfo(const std::string &raw,
+                                   std::vector<BuddyZoneInfo> &out)
+{
+    std::size_t count = 0;
+
+    const char *pos = raw.data(), *end = raw.data() + raw.size();
+    while (pos < end)
+    {
+        const char *eol = lineEnd(pos, end);
+        uint32_t node;
+        std::string_view zone;
+        if (parseZoneHeader(pos, eol, node, zone))
+        {
+            if (count == out.size())
+            {
+                out.emplace_back();
+            }
+            BuddyZoneInfo &entry = out[count++];
+            entry.node = node;
+            entry.zone.assign(zone);
+            entry.freeBlocks.fill(0);
+            entry.freePages = entry.min = entry.low = entry.high = 0;
+            scanNumbers(pos, eol, entry.freeBlocks.data(),
+                        entry.freeBlocks.size());
+        }
+        pos = eol + 1;
+    }
+    out.resize(count);
+}
+
+void info::VMProbe::parseZoneinfo(const std::string &raw,
+                                  std::vector<BuddyZoneInfo> &zones)
+{
+    BuddyZoneInfo *current = nullptr;
+
+    const char *pos = raw.data(), *end = raw.data() + raw.size();
+    while (pos < end)
+    {
+        const char *eol = lineEnd(pos, end);
+        uint32_t node;
+        std::string_view zone;
+        if (parseZoneHeader(pos, eol, node, zone))
+        {
+            auto found = std::find_if(
+                zones.begin(), zones.end(), [&](const BuddyZoneInfo &entry)
+                { return entry.node == node && entry.zone == zone; });
+            current = found != zones.end() ? &*found : nullptr;
+        }
+        else if (current)
+        {
+            // Строки зоны: "  pages free     264616", "        min      8312".
+            // Поля pagesets ("high:  1234") отличаются двоеточием
+            const char *key = skipSpaces(pos, eol);
+            const char *keyEnd = key;
+            while (keyEnd < eol && *keyEnd != ' ')
+            {
+                ++keyEnd;
+            }
+            std::string_view name(key, keyEnd - key);
+            uint64_t *target = nullptr;
+            if (name == "min")
+            {
+                target = &current->min;
+            }
+            else if (name == "low")
+            {
+                target = &current->low;
+            }
+            else if (name == "high")
+            {
+                target = &current->high;
+            }
+            else if (name == "pages" && eol - keyEnd > 5 &&
+                     std::memcmp(keyEnd, " free", 5) == 0)
+            {
+                target = &current->freePages;
+                keyEnd += 5;
+            }
+            if (target)
+            {
+                scanNumbers(keyEnd, eol, target, 1);
+            }
+        }
+        pos = eol + 1;
+    }
+}
+
+uint64_t info::VMProbe::_readNumber(PinnedFile &file)
+{
+    if (!file.read(_buffer))
+    {
+        return 0;
+    }
+    return std::strtoull(_buffer.c_str(), nullptr, 10);
+}
+
+void info::VMProbe::_openHugepages(const std::string &dir, uint32_t node)
+{
+    // Директории вида hugepages-2048kB
+    for (const auto &name : _source.listDirectory(dir))
+    {
+        if (name.rfind("hugepages-", 0) != 0)
+        {
+            continue;
+        }
+        const std::string pool = dir + "/" + name;
+        const uint64_t size = std::strtoull(name.c_str() + 10, nullptr, 10);
+        _hugepages.push_back({{node, size * 1024, 0, 0, 0},
+                              PinnedFile(_source, pool + "/nr_hugepages"),
+                              PinnedFile(_source, pool + "/free_hugepages"),
+                              PinnedFile(_source, pool + "/surplus_hugepages")});
+    }
+}
+
+void info::VMProbe::_open()
+{
+    _opened = true;
+
+    for (const auto &name : _source.listDirectory("/sys/devices/system/node"))
+    {
+        if (name.size() > 4 && name.rfind("node", 0) == 0 &&
+            std::isdigit(static_cast<unsigned char>(name[4])))
+        {
+            _openHugepages("/sys/devices/system/node/" + name + "/hugepages",
+                           std::strtoul(name.c_str() + 4, nullptr, 10));
+        }
+    }
+    // Ядро без CONFIG_NUMA показывает только общие пулы
+    if (_hugepages.empty())
+    {
+        _openHugepages("/sys/kernel/mm/hugepages", 0);
+    }
+}
+
+info::VMInfo info::VMProbe::sample()
+{
+    std::lock_guard lock(_mutex);
+
+    if (!_opened)
+    {
+        _open();
+        _source.readFile("/proc/vmstat", _buffer);
+        parseVmstat(_buffer, _previous);
+        _previousTime = _source.monotonic();
+        if (!_source.replaying())
+        {
+            std::this_thread::sleep_for(_warmup);
+        }
+    }
+
+    VMInfo output;
+    _source.readFile("/proc/vmstat", _buffer);
+    parseVmstat(_buffer, output.totals);
+
+    const auto now = _source.monotonic();
+    const double seconds =
+        std::chrono::duration<double>(now - _previousTime).count();
+    _previousTime = now;
+    output.interval = std::chrono::duration<float>(seconds);
+
+    for (std::size_t i = 0; i < VMInfo::COUNTERS; ++i)
+    {
+        // Счетчики только растут; уменьшение возможно, если ключ пропал из
+        // файла, и считается нулевым приращением
+        const uint64_t delta = output.totals[i] >= _previous[i]
+                                   ? output.totals[i] - _previous[i]
+                                   : 0;
+        output.rates[i] = seconds > 0 ? delta / seconds : 0;
+    }
+    _previous = output.totals;
+
+    _source.readFile("/proc/buddyinfo", _buffer);
+    parseBuddyinfo(_buffer, output.zones);
+    _source.readFile("/proc/zoneinfo", _buffer);
+    parseZoneinfo(_buffer, output.zones);
+
+    for (auto &pool : _hugepages)
+    {
+        pool.info.total = _readNumber(pool.total);
+        pool.info.free = _readNumber(pool.free);
+        pool.info.surplus = _readNumber(pool.surplus);
+        output.hugepages.push_back(pool.info);
+    }
+
+    return output;
+}
@@ -0,0 +1,594 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utmp.h>
+#include <vector>
+
+/*
+ *
+ * Генератор синтетического дерева /proc и /sys для запуска библиотеки
+ * через ProbeOptions::sysroot. Позволяет проверять скорость парсеров на
+ * конфигурациях, которых нет под рукой (сотни ядер, десятки тысяч точек
+ * монтирования, тысячи сетевых интерфейсов)
+ *
+ */
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Параметры генерируемой системы
+ */
+struct FixtureConfig
+{
+    fs::path root;              ///< Куда писать дерево
+    uint32_t cpus = 512;        ///< Количество логических процессоров
+    uint32_t mounts = 20000;    ///< Количество точек монтирования
+    uint32_t interfaces = 5000; ///< Количество сетевых интерфейсов
+    uint32_t disks = 64;        ///< Количество блочных устройств
+    uint32_t irqs = 2048;       ///< Количество линий прерываний
+    uint32_t users = 16;        ///< Количество активных пользователей
+    uint32_t cgroups = 10000;   ///< Количество контрольных групп
+    uint64_t seed = 42;         ///< Зерно генератора случайных чисел
+};
+
+// Открывает файл внутри дерева, создавая промежуточные директории
+static std::ofstream openFixture(const FixtureConfig &cfg, const fs::path &rel)
+{
+    fs::path full = cfg.root / rel;
+    fs::create_directories(full.parent_path());
+    return std::ofstream(full, std::ios_base::out | std::ios_base::trunc |
+                                   std::ios_base::binary);
+}
+
+static void writeProcStat(const FixtureConfig &cfg, std::mt19937_64 &rng)
+{
+    auto out = openFixture(cfg, "proc/stat");
+    std::uniform_int_distribution<uint64_t> ticks(0, 100000000);
+
+    // Колонки: user nice system idle iowait irq softirq steal guest guest_nice
+    std::vector<std::array<uint64_t, 10>> rows(cfg.cpus);
+    std::array<uint64_t, 10> total{};
+    for (auto &row : rows)
+    {
+        for (std::size_t i = 0; i < row.size(); ++i)
+        {
+            row[i] = ticks(rng) >> (i >= 5 ? 4 : 0);
+            total[i] += row[i];
+        }
+    }
+
+    auto writeRow = [&out](const std::string &label, const auto &row)
+    {
+        out << label;
+        for (auto v : row)
+        {
+            out << ' ' << v;
+        }
+        out << '\n';
+    };
+
+    writeRow("cpu ", total);
+    for (uint32_t i = 0; i < cfg.cpus; ++i)
+    {
+        writeRow("cpu" + std::to_string(i), rows[i]);
+    }
+
+    out << "intr " << ticks(rng);
+    for (uint32_t i = 0; i < cfg.irqs; ++i)
+    {
+        out << ' ' << (ticks(rng) >> 8);
+    }
+    out << '\n';
+    out << "ctxt " << ticks(rng) * 100 << '\n';
+    out << "btime 1700000000\n";
+    out << "processes " << ticks(rng) << '\n';
+    out << "procs_running " << 1 + rng() % cfg.cpus << '\n';
+    out << "procs_blocked " << rng() % 8 << '\n';
+    out << "softirq " << ticks(rng);
+    for (int i = 0; i < 10; ++i)
+    {
+        out << ' ' << (ticks(rng) >> 2);
+    }
+    out << '\n';
+}
+
+static void writeScheduler(const FixtureConfig &cfg, std::mt19937_64 &rng)
+{
+    std::uniform_int_distribution<uint64_t> nanos(0, 1ull << 50);
+
+    openFixture(cfg, "proc/uptime") << "86400.00 " << 86400 * cfg.cpus
+                                    << ".00\n";
+    openFixture(cfg, "proc/loadavg")
+        << "1.52 1.31 0.97 " << 1 + rng() % cfg.cpus << '/'
+        << 200 + cfg.cpus * 4 << ' ' << 10000 + rng() % 100000 << '\n';
+
+    // Версия 15: у каждого процессора девять полей, за ним строки доменов
+    auto out = openFixture(cfg, "proc/schedstat");
+    out << "version 15\ntimestamp " << 4300000000ull + rng() % 1000000
+        << '\n';
+    for (uint32_t i = 0; i < cfg.cpus; ++i)
+    {
+        out << "cpu" << i << " 0 0 0 0 0 0 " << nanos(rng) << ' '
+            << (nanos(rng) >> 4) << ' ' << (nanos(rng) >> 20) << '\n';
+        out << "domain0 00000000,00000003";
+        for (int j = 0; j < 45; ++j)
+        {
+            out << " 0";
+        }
+        out << '\n';
+    }
+}
+
+static void writeCPUInfo(const FixtureConfig &cfg, std::mt19937_64 &)
+{
+    auto out = openFixture(cfg, "proc/cpuinfo");
+    for (uint32_t i = 0; i < cfg.cpus; ++i)
+    {
+        out << "processor\t: " << i << '\n'
+            << "vendor_id\t: GenuineIntel\n"
+            << "model name\t: Synthetic CPU @ 2.10GHz\n"
+            << "cpu MHz\t\t: 2100.000\n"
+            << "cache size\t: 32768 KB\n"
+            << "physical id\t: " << i / (cfg.cpus / 2 ? cfg.cpus / 2 : 1)
+            << '\n'
+            << "cpu cores\t: " << cfg.cpus << '\n'
+            << '\n';
+    }
+}
+
+static void writeCPUTopology(const FixtureConfig &cfg, std::mt19937_64 &)
+{
+    const std::string range = "0-" + std::to_string(cfg.cpus - 1) + "\n";
+    for (const char *mask : {"possible", "present", "online"})
+    {
+        openFixture(cfg, fs::path("sys/devices/system/cpu") / mask) << range;
+    }
+
+    // Кэши в том виде, в котором их читает lscpu --sysroot
+    struct CacheLevel
+    {
+        int level;
+        const char *type;
+        const char *size;
+        uint32_t sharedBy;
+    };
+    static const CacheLevel levels[] = {{1, "Data", "48K", 1},
+                                        {1, "Instruction", "32K", 1},
+                                        {2, "Unified", "2048K", 1},
+                                        {3, "Unified", "65536K", 64}};
+
+    for (uint32_t cpu = 0; cpu < cfg.cpus; ++cpu)
+    {
+        const fs::path dir =
+            fs::path("sys/devices/system/cpu") / ("cpu" + std::to_string(cpu));
+        for (std::size_t i = 0; i < std::size(levels); ++i)
+        {
+            const auto &lvl = levels[i];
+            const fs::path idx = dir / "cache" / ("index" + std::to_string(i));
+            const uint32_t first = cpu - cpu % lvl.sharedBy;
+            const uint32_t last = std::min(first + lvl.sharedBy, cfg.cpus) - 1;
+
+            openFixture(cfg, idx / "level") << lvl.level << '\n';
+            openFixture(cfg, idx / "type") << lvl.type << '\n';
+            openFixture(cfg, idx / "size") << lvl.size << '\n';
+            openFixture(cfg, idx / "coherency_line_size") << "64\n";
+            openFixture(cfg, idx / "ways_of_associativity") << "8\n";
+            openFixture(cfg, idx / "shared_cpu_list")
+                << first << '-' << last << '\n';
+        }
+    }
+}
+
+static void writeMemInfo(const FixtureConfig &cfg, std::mt19937_64 &rng)
+{
+    auto out = openFixture(cfg, "proc/meminfo");
+    const uint64_t total = uint64_t{4} << 30; // 4 ТБ в килобайтах
+    out << "MemTotal:       " << total << " kB\n"
+        << "MemFree:        " << total / 4 << " kB\n"
+        << "MemAvailable:   " << total / 3 + rng() % 1024 << " kB\n"
+        << "Buffers:        " << total / 100 << " kB\n"
+        << "Cached:         " << total / 10 << " kB\n";
+}
+
+static void writeVM(const FixtureConfig &cfg, std::mt19937_64 &rng)
+{
+    // Узел NUMA на каждые 64 процессора
+    const uint32_t nodes = std::clamp<uint32_t>(cfg.cpus / 64, 1, 8);
+    const char *zones[] = {"DMA", "DMA32", "Normal", "Movable"};
+
+    auto vmstat = openFixture(cfg, "proc/vmstat");
+    vmstat << "nr_free_pages " << rng() % (uint64_t{1} << 30) << '\n'
+           << "nr_inactive_anon " << rng() % (uint64_t{1} << 28) << '\n';
+    for (const char *key :
+         {"pgfault", "pgmajfault", "pswpin", "pswpout", "allocstall_dma",
+          "allocstall_dma32", "allocstall_normal", "allocstall_movable",
+          "pgsteal_kswapd", "pgsteal_direct", "pgscan_kswapd", "pgscan_direct",
+          "oom_kill", "compact_stall", "compact_fail", "compact_success",
+          "thp_fault_alloc", "thp_fault_fallback", "thp_collapse_alloc",
+          "thp_split_page"})
+    {
+        vmstat << key << ' ' << rng() % (uint64_t{1} << 32) << '\n';
+    }
+
+    auto buddy = openFixture(cfg, "proc/buddyinfo");
+    auto zoneinfo = openFixture(cfg, "proc/zoneinfo");
+    for (uint32_t n = 0; n < nodes; ++n)
+    {
+        for (const char *zone : zones)
+        {
+            // DMA и DMA32 есть только у первого узла, Movable пустая и в
+            // buddyinfo не выводится
+            if (n > 0 && std::strncmp(zone, "DMA", 3) == 0)
+            {
+                continue;
+            }
+            const bool empty = std::strcmp(zone, "Movable") == 0;
+            if (!empty)
+            {
+                char header[64];
+                std::snprintf(header, sizeof(header), "Node %u, zone %8s", n,
+                              zone);
+                buddy << header;
+                for (int order = 0; order < 11; ++order)
+                {
+                    buddy << ' ' << std::setw(6) << rng() % 50000;
+                }
+                buddy << " \n";
+            }
+
+            const uint64_t min = empty ? 32 : 8000 + rng() % 1000;
+            zoneinfo << "Node " << n << ", zone " << std::setw(8) << zone
+                     << "\n  pages free     " << (empty ? 0 : rng() % 10000000)
+                     << "\n        boost    0\n        min      " << min
+                     << "\n        low      " << min * 5 / 4
+                     << "\n        high     " << min * 3 / 2
+                     << "\n        spanned  " << rng() % 10000000
+                     << "\n  pagesets\n    cpu: 0\n              count: 12"
+                     << "\n              high:  378\n";
+        }
+
+        const std::string hugepages = "sys/devices/system/node/node" +
+                                      std::to_string(n) + "/hugepages/";
+        for (const char *size : {"2048kB", "1048576kB"})
+        {
+            const std::string pool = hugepages + "hugepages-" + size + "/";
+            const uint64_t total = rng() % 4096;
+            openFixture(cfg, pool + "nr_hugepages") << total << '\n';
+            openFixture(cfg, pool + "free_hugepages")
+                << (total ? rng() % total : 0) << '\n';
+            openFixture(cfg, pool + "surplus_hugepages") << "0\n";
+        }
+    }
+}
+
+// Файлы контроллеров одной группы. У корня иерархии memory.current и
+// pids.current нет
+static void writeCgroup(const FixtureConfig &cfg, std::mt19937_64 &rng,
+                        const std::string &dir, bool root)
+{
+    const uint64_t user = rng() % (uint64_t{1} << 36);
+    const uint64_t system = rng() % (uint64_t{1} << 34);
+    openFixture(cfg, dir + "/cgroup.controllers") << "cpu io memory pids\n";
+    openFixture(cfg, dir + "/cpu.stat")
+        << "usage_usec " << user + system << "\nuser_usec " << user
+        << "\nsystem_usec " << system << "\nnr_periods " << rng() % 100000
+        << "\nnr_throttled " << rng() % 1000 << "\nthrottled_usec "
+        << rng() % 10000000 << "\n";
+    auto io = openFixture(cfg, dir + "/io.stat");
+    for (const char *device : {"8:0", "259:0"})
+    {
+        io << device << " rbytes=" << rng() % (uint64_t{1} << 40)
+           << " wbytes=" << rng() % (uint64_t{1} << 40)
+           << " rios=" << rng() % 10000000 << " wios=" << rng() % 10000000
+           << " dbytes=0 dios=0\n";
+    }
+    if (!root)
+    {
+        openFixture(cfg, dir + "/memory.current")
+            << rng() % (uint64_t{1} << 34) << '\n';
+        openFixture(cfg, dir + "/pids.current") << rng() % 200 << '\n';
+    }
+}
+
+static void writeCgroups(const FixtureConfig &cfg, std::mt19937_64 &rng)
+{
+    // Иерархия как у узла Kubernetes: служебные срезы и поды по четыре
+    // контейнера
+    const std::string root = "sys/fs/cgroup";
+    writeCgroup(cfg, rng, root, true);
+    uint32_t written = 1;
+    for (const char *slice : {"system.slice", "user.slice", "kubepods.slice"})
+    {
+        if (written < cfg.cgroups)
+        {
+            writeCgroup(cfg, rng, root + "/" + slice, false);
+            ++written;
+        }
+    }
+    for (uint32_t pod = 0; written < cfg.cgroups; ++pod)
+    {
+        const std::string podDir =
+            root + "/kubepods.slice/pod" + std::to_string(pod);
+        writeCgroup(cfg, rng, podDir, false);
+        ++written;
+        for (uint32_t c = 0; c < 4 && written < cfg.cgroups; ++c, ++written)
+        {
+            writeCgroup(cfg, rng, podDir + "/ctr" + std::to_string(c), false);
+        }
+    }
+}
+
+static void writeMountInfo(const FixtureConfig &cfg, std::mt19937_64 &rng)
+{
+    auto out = openFixture(cfg, "proc/self/mountinfo");
+    static const char *fstypes[] = {"ext4", "xfs", "tmpfs", "overlay",
+                                    "nfs4", "fuse.sshfs", "proc", "sysfs"};
+
+    out << "1 0 8:1 / / rw,relatime shared:1 - ext4 /dev/sda1 rw\n";
+    for (uint32_t i = 1; i < cfg.mounts; ++i)
+    {
+        const char *fstype = fstypes[rng() % std::size(fstypes)];
+        out << i + 1 << " 1 0:" << i << " / /mnt/m" << i
+            << " rw,relatime shared:" << i + 1 << " - " << fstype
+            << " src" << i << " rw\n";
+    }
+}
+
+static void writeDiskStats(const FixtureConfig &cfg, std::mt19937_64 &rng)
+{
+    auto out = openFixture(cfg, "proc/diskstats");
+    for (uint32_t i = 0; i < cfg.disks; ++i)
+    {
+        out << "   8       " << i * 16 << " sd" << char('a' + i % 26);
+        if (i >= 26)
+        {
+            out << i / 26;
+        }
+        for (int f = 0; f < 17; ++f)
+        {
+            out << ' ' << rng() % 100000000;
+        }
+        out << '\n';
+    }
+}
+
+static void writeInterrupts(const FixtureConfig &cfg, std::mt19937_64 &rng)
+{
+    auto out = openFixture(cfg, "proc/interrupts");
+    out << "     ";
+    for (uint32_t c = 0; c < cfg.cpus; ++c)
+    {
+        out << "      CPU" << c;
+    }
+    out << '\n';
+
+    for (uint32_t irq = 0; irq < cfg.irqs; ++irq)
+    {
+        out << ' ' << irq << ':';
+        for (uint32_t c = 0; c < cfg.cpus; ++c)
+        {
+            out << ' ' << rng() % 1000000;
+        }
+        out << "  IR-PCI-MSIX-0000:3b:00.0 " << irq << "-edge      eth0-TxRx-"
+            << irq << '\n';
+    }
+
+    for (const char *label : {"NMI", "LOC", "RES", "CAL", "TLB"})
+    {
+        out << label << ':';
+        for (uint32_t c = 0; c < cfg.cpus; ++c)
+        {
+            out << ' ' << rng() % 1000000;
+        }
+        out << "   " << label << " interrupts\n";
+    }
+
+    auto softirqs = openFixture(cfg, "proc/softirqs");
+    softirqs << "       ";
+    for (uint32_t c = 0; c < cfg.cpus; ++c)
+    {
+        softirqs << "       CPU" << c;
+    }
+    softirqs << '\n';
+    for (const char *label : {"HI", "TIMER", "NET_TX", "NET_RX", "BLOCK",
+                              "IRQ_POLL", "TASKLET", "SCHED", "HRTIMER", "RCU"})
+    {
+        softirqs << "  " << label << ':';
+        for (uint32_t c = 0; c < cfg.cpus; ++c)
+        {
+            softirqs << ' ' << rng() % 10000000;
+        }
+        softirqs << '\n';
+    }
+}
+
+static void writeNetwork(const FixtureConfig &cfg, std::mt19937_64 &rng)
+{
+    auto dev = openFixture(cfg, "proc/net/dev");
+    dev << "Inter-|   Receive                                                |"
+           "  Transmit\n"
+        << " face |bytes    packets errs drop fifo frame compressed "
+           "multicast|bytes    packets errs drop fifo colls carrier "
+           "compressed\n";
+
+    for (uint32_t i = 0; i < cfg.interfaces; ++i)
+    {
+        const std::string name = "eth" + std::to_string(i);
+        dev << "  " << name << ':';
+        for (int f = 0; f < 16; ++f)
+        {
+            dev << ' ' << rng() % 1000000000;
+        }
+        dev << '\n';
+
+        auto address = openFixture(cfg, "sys/class/net/" + name + "/address");
+        char mac[18];
+        std::snprintf(mac, sizeof(mac), "02:00:%02x:%02x:%02x:%02x",
+                      (i >> 24) & 0xff, (i >> 16) & 0xff, (i >> 8) & 0xff,
+                      i & 0xff);
+        address << mac << '\n';
+        openFixture(cfg, "sys/class/net/" + name + "/mtu") << "1500\n";
+        openFixture(cfg, "sys/class/net/" + name + "/operstate") << "up\n";
+    }
+}
+
+static void writeThermal(const FixtureConfig &cfg, std::mt19937_64 &rng)
+{
+    std::uniform_int_distribution<int> celsius(35000, 85000);
+    const uint32_t packages = cfg.cpus >= 2 ? 2 : 1;
+    const uint32_t cores = std::min<uint32_t>(cfg.cpus / packages, 64);
+
+    auto zone = [&](uint32_t n, const char *type)
+    {
+        const std::string dir =
+            "sys/class/thermal/thermal_zone" + std::to_string(n) + "/";
+        openFixture(cfg, dir + "type") << type << '\n';
+        openFixture(cfg, dir + "temp") << celsius(rng) << '\n';
+    };
+    zone(0, "acpitz");
+
+    for (uint32_t p = 0; p < packages; ++p)
+    {
+        zone(p + 1, "x86_pkg_temp");
+
+        // coretemp: датчик пакета и по датчику на каждое физическое ядро
+        const std::string hwmon =
+            "sys/class/hwmon/hwmon" + std::to_string(p) + "/";
+        openFixture(cfg, hwmon + "name") << "coretemp\n";
+        for (uint32_t c = 0; c <= cores; ++c)
+        {
+            const std::string temp = hwmon + "temp" + std::to_string(c + 1);
+            openFixture(cfg, temp + "_input") << celsius(rng) << '\n';
+            openFixture(cfg, temp + "_label")
+                << (c == 0 ? "Package id " + std::to_string(p)
+                           : "Core " + std::to_string(c - 1))
+                << '\n';
+        }
+
+        // RAPL: пакет и его поддомены core и dram
+        const std::string rapl =
+            "sys/class/powercap/intel-rapl:" + std::to_string(p);
+        auto domain = [&](const std::string &dir, const std::string &name)
+        {
+            openFixture(cfg, dir + "/name") << name << '\n';
+            openFixture(cfg, dir + "/max_energy_range_uj") << "262143328850\n";
+            openFixture(cfg, dir + "/energy_uj") << rng() % 262143328850
+                                                 << '\n';
+        };
+        domain(rapl, "package-" + std::to_string(p));
+        domain(rapl + ":0", "core");
+        domain(rapl + ":1", "dram");
+    }
+    fs::create_directories(cfg.root / "sys/class/powercap/intel-rapl");
+
+    // Микросхема мониторинга материнской платы с вентиляторами
+    const std::string board =
+        "sys/class/hwmon/hwmon" + std::to_string(packages) + "/";
+    openFixture(cfg, board + "name") << "nct6775\n";
+    for (int f = 1; f <= 4; ++f)
+    {
+        openFixture(cfg, board + "fan" + std::to_string(f) + "_input")
+            << 800 + rng() % 2000 << '\n';
+    }
+}
+
+static void writeUtmp(const FixtureConfig &cfg, std::mt19937_64 &rng)
+{
+    auto out = openFixture(cfg, "var/run/utmp");
+    for (uint32_t i = 0; i < cfg.users; ++i)
+    {
+        utmp entry;
+        std::memset(&entry, 0, sizeof(entry));
+        entry.ut_type = USER_PROCESS;
+        entry.ut_pid = 1000 + i;
+        std::snprintf(entry.ut_user, sizeof(entry.ut_user), "user%u", i);
+        std::snprintf(entry.ut_line, sizeof(entry.ut_line), "pts/%u", i);
+        entry.ut_tv.tv_sec = 1700000000 + rng() % 100000;
+        out.write(reinterpret_cast<const char *>(&entry), sizeof(entry));
+    }
+}
+
+static void printUsage(const char *argv0)
+{
+    std::cerr << "Usage: " << argv0
+              << " <output dir> [--cpus N] [--mounts N] [--interfaces N]"
+                 " [--disks N] [--irqs N] [--users N] [--cgroups N]"
+                 " [--seed N]\n";
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    FixtureConfig cfg;
+    cfg.root = argv[1];
+
+    for (int i = 2; i < argc; ++i)
+    {
+        std::string opt = argv[i];
+        if (i + 1 >= argc)
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+        uint64_t value = std::stoull(argv[++i]);
+
+        if (opt == "--cpus")
+            cfg.cpus = value;
+        else if (opt == "--mounts")
+            cfg.mounts = value;
+        else if (opt == "--interfaces")
+            cfg.interfaces = value;
+        else if (opt == "--disks")
+            cfg.disks = value;
+        else if (opt == "--irqs")
+            cfg.irqs = value;
+        else if (opt == "--users")
+            cfg.users = value;
+        else if (opt == "--cgroups")
+            cfg.cgroups = value;
+        else if (opt == "--seed")
+            cfg.seed = value;
+        else
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (cfg.cpus == 0)
+    {
+        std::cerr << "--cpus must be positive\n";
+        return 1;
+    }
+
+    std::mt19937_64 rng(cfg.seed);
+    writeProcStat(cfg, rng);
+    writeScheduler(cfg, rng);
+    writeCPUInfo(cfg, rng);
+    writeCPUTopology(cfg, rng);
+    writeMemInfo(cfg, rng);
+    writeVM(cfg, rng);
+    writeCgroups(cfg, rng);
+    writeMountInfo(cfg, rng);
+    writeDiskStats(cfg, rng);
+    writeInterrupts(cfg, rng);
+    writeNetwork(cfg, rng);
+    writeThermal(cfg, rng);
+    writeUtmp(cfg, rng);
+
+    std::cout << "Fixture tree written to " << cfg.root << std::endl;
+    return 0;
+}
@@ -157,9 +157,16 @@ void __test_MemoryInfo(info::ProbeUtilities &probe)
               << std::endl;
 }
 
-int main()
+int main(int argc, char **argv)
 {
-    info::ProbeUtilities probe;
+    // Первым аргументом можно передать корень сгенерированного дерева /proc
+    info::ProbeOptions options;
+    if (argc > 1)
+    {
+        options.sysroot = argv[1];
+    }
+
+    info::ProbeUtilities probe(options);
     __test_OSInfo(probe);
     __test_UserInfo(probe);
     __test_DiscPartitionInfo(probe);
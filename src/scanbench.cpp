@@ -0,0 +1,141 @@
+#include <ProcScanner.hpp>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/*
+ *
+ * Сравнение скорости разбора счетчиков /proc разными реализациями
+ * ProcScanner. Без аргументов разбирается синтетический /proc/stat на 256
+ * ядер, иначе - переданные файлы (например, из дерева fixturegen)
+ *
+ */
+
+// /proc/stat так, как он выглядит на машине с cpus ядрами
+static std::string syntheticStat(uint32_t cpus)
+{
+    std::mt19937_64 rng(42);
+    std::ostringstream out;
+    for (uint32_t i = 0; i <= cpus; ++i)
+    {
+        out << (i == 0 ? std::string("cpu ") : "cpu" + std::to_string(i - 1));
+        for (int f = 0; f < 10; ++f)
+        {
+            out << ' ' << rng() % 1000000000;
+        }
+        out << '\n';
+    }
+    return out.str();
+}
+
+// Разбор построчно, как это делают парсеры библиотеки
+template <typename Scan>
+static uint64_t parseLines(const std::string &buf, Scan scan)
+{
+    uint64_t checksum = 0;
+    std::vector<uint64_t> values(4096);
+    const char *pos = buf.data(), *end = buf.data() + buf.size();
+    while (pos < end)
+    {
+        const char *eol = pos;
+        while (eol < end && *eol != '\n')
+        {
+            ++eol;
+        }
+        const char *fields = pos;
+        std::size_t count = scan(fields, eol, values.data(), values.size());
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            checksum += values[i];
+        }
+        pos = eol + 1;
+    }
+    return checksum;
+}
+
+template <typename Fn>
+static void bench(const char *name, const std::string &buf, Fn fn)
+{
+    constexpr int ITERATIONS = 200;
+    uint64_t checksum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; ++i)
+    {
+        checksum += fn(buf);
+    }
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    double mbps = buf.size() * ITERATIONS / elapsed.count() / 1e6;
+    std::cout << "  " << name << ": " << elapsed.count() / ITERATIONS * 1e6
+              << " us/pass, " << mbps << " MB/s (checksum " << checksum
+              << ")\n";
+}
+
+static void benchBuffer(const std::string &title, const std::string &buf)
+{
+    std::cout << title << " (" << buf.size() << " bytes)\n";
+
+    bench("stringstream", buf,
+          [](const std::string &b)
+          {
+              uint64_t checksum = 0;
+              std::istringstream in(b);
+              for (std::string line; std::getline(in, line);)
+              {
+                  std::istringstream fields(line);
+                  std::string token;
+                  while (fields >> token)
+                  {
+                      if (!token.empty() && std::isdigit(token[0]))
+                      {
+                          checksum += std::stoull(token);
+                      }
+                  }
+              }
+              return checksum;
+          });
+
+    const std::pair<const char *, info::ScanLevel> levels[] = {
+        {"scalar", info::ScanLevel::Scalar},
+        {"sse", info::ScanLevel::SSE},
+        {"avx2", info::ScanLevel::AVX2}};
+
+    for (const auto &[name, level] : levels)
+    {
+        bench(name, buf,
+              [level = level](const std::string &b)
+              {
+                  return parseLines(b,
+                                    [level](const char *&p, const char *e,
+                                            uint64_t *out, std::size_t max) {
+                                        return info::scanNumbersWith(
+                                            level, p, e, out, max);
+                                    });
+              });
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        benchBuffer("synthetic /proc/stat, 256 cpus", syntheticStat(256));
+        return 0;
+    }
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::ifstream in(argv[i], std::ios_base::in | std::ios_base::binary);
+        benchBuffer(argv[i], std::string(std::istreambuf_iterator<char>(in), {}));
+    }
+    return 0;
+}
@@ -0,0 +1,822 @@
+#include "ProbeUtilities.hpp"
+#include "RuleEngine.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include "MetricStore.hpp"
+#include "SharedSnapshot.hpp"
+#endif
+
+/*
+ *
+ * Утилита периодического опроса в духе vmstat. Опрашиваются только методы,
+ * нужные для выбранных полей; строка каждого замера собирается в один буфер
+ * и выводится одним вызовом fwrite
+ *
+ */
+
+namespace
+{
+
+// Группы полей. Каждая группа соответствует одному методу ProbeUtilities
+enum Group : unsigned
+{
+    CPU = 1 << 0,
+    Memory = 1 << 1,
+    Scheduler = 1 << 2,
+    Sockets = 1 << 3,
+    Thermal = 1 << 4,
+    Interrupts = 1 << 5,
+    VM = 1 << 6
+};
+
+// Результаты одного замера. Заполняются только выбранные группы
+struct Sample
+{
+    info::CPUTimesInfo cpu;
+    info::MemoryInfo memory{};
+    info::SchedulerInfo scheduler;
+    info::SocketInfo sockets;
+    info::ThermalInfo thermal;
+    info::InterruptInfo interrupts;
+    info::VMInfo vm;
+};
+
+struct Field
+{
+    const char *name;
+    unsigned group;
+    const char *description;
+    double (*get)(const Sample &);
+};
+
+double perSecond(uint64_t count, std::chrono::duration<float> interval)
+{
+    return interval.count() > 0 ? count / interval.count() : 0;
+}
+
+uint64_t rowsSum(const info::InterruptMatrix &matrix, const char *label)
+{
+    uint64_t sum = 0;
+    std::size_t cols = matrix.cpus.size();
+    for (std::size_t row = 0; row < matrix.rows(); ++row)
+    {
+        if (label && matrix.labels[row] != label)
+        {
+            continue;
+        }
+        for (std::size_t col = 0; col < cols; ++col)
+        {
+            sum += matrix.at(row, col);
+        }
+    }
+    return sum;
+}
+
+using info::CPUState;
+using info::TCPState;
+using info::VMCounter;
+
+const Field FIELDS[] = {
+    {"cpu.user", CPU, "время в пользовательском коде (user + nice), %",
+     [](const Sample &s) -> double
+     {
+         return s.cpu.total.percentOf(CPUState::User) +
+                s.cpu.total.percentOf(CPUState::Nice);
+     }},
+    {"cpu.system", CPU, "время в коде ядра, %",
+     [](const Sample &s) -> double
+     { return s.cpu.total.percentOf(CPUState::System); }},
+    {"cpu.idle", CPU, "простой, %",
+     [](const Sample &s) -> double
+     { return s.cpu.total.percentOf(CPUState::Idle); }},
+    {"cpu.iowait", CPU, "простой в ожидании ввода-вывода, %",
+     [](const Sample &s) -> double
+     { return s.cpu.total.percentOf(CPUState::IOWait); }},
+    {"cpu.irq", CPU, "обработка аппаратных прерываний, %",
+     [](const Sample &s) -> double
+     { return s.cpu.total.percentOf(CPUState::IRQ); }},
+    {"cpu.softirq", CPU, "обработка программных прерываний, %",
+     [](const Sample &s) -> double
+     { return s.cpu.total.percentOf(CPUState::SoftIRQ); }},
+    {"cpu.steal", CPU, "время, отнятое гипервизором, %",
+     [](const Sample &s) -> double
+     { return s.cpu.total.percentOf(CPUState::Steal); }},
+    {"cpu.load", CPU, "загрузка (все, кроме idle и iowait), %",
+     [](const Sample &s) -> double
+     {
+         if (s.cpu.interval.count() == 0)
+         {
+             return 0;
+         }
+         return 100.0 - s.cpu.total.percentOf(CPUState::Idle) -
+                s.cpu.total.percentOf(CPUState::IOWait);
+     }},
+    {"mem.total", Memory, "емкость ОЗУ, МБ",
+     [](const Sample &s) -> double
+     { return s.memory.capacity / 1048576.0; }},
+    {"mem.free", Memory, "доступная память (MemAvailable), МБ",
+     [](const Sample &s) -> double
+     { return s.memory.freeSpace / 1048576.0; }},
+    {"mem.used", Memory, "занятая память, %",
+     [](const Sample &s) -> double
+     {
+         if (s.memory.capacity == 0)
+         {
+             return 0;
+         }
+         return 100.0 * (s.memory.capacity - s.memory.freeSpace) /
+                s.memory.capacity;
+     }},
+    {"vm.pgscan", VM, "страниц просмотрено для освобождения в секунду",
+     [](const Sample &s) -> double
+     {
+         return s.vm.rate(VMCounter::PgscanKswapd) +
+                s.vm.rate(VMCounter::PgscanDirect);
+     }},
+    {"vm.direct", VM, "страниц просмотрено прямым освобождением в секунду",
+     [](const Sample &s) -> double
+     { return s.vm.rate(VMCounter::PgscanDirect); }},
+    {"vm.compact", VM, "выделений, ожидавших уплотнения, в секунду",
+     [](const Sample &s) -> double
+     { return s.vm.rate(VMCounter::CompactStall); }},
+    {"vm.majfault", VM, "страничных прерываний с чтением с диска в секунду",
+     [](const Sample &s) -> double
+     { return s.vm.rate(VMCounter::PgMajFault); }},
+    {"vm.swapin", VM, "страниц прочитано из подкачки в секунду",
+     [](const Sample &s) -> double { return s.vm.rate(VMCounter::PswpIn); }},
+    {"vm.swapout", VM, "страниц записано в подкачку в секунду",
+     [](const Sample &s) -> double { return s.vm.rate(VMCounter::PswpOut); }},
+    {"vm.thpfallback", VM, "прерываний, не получивших огромную страницу, в с",
+     [](const Sample &s) -> double
+     { return s.vm.rate(VMCounter::ThpFaultFallback); }},
+    {"sched.load1", Scheduler, "средняя длина очереди за 1 минуту",
+     [](const Sample &s) -> double { return s.scheduler.loadAverage[0]; }},
+    {"sched.load5", Scheduler, "средняя длина очереди за 5 минут",
+     [](const Sample &s) -> double { return s.scheduler.loadAverage[1]; }},
+    {"sched.load15", Scheduler, "средняя длина очереди за 15 минут",
+     [](const Sample &s) -> double { return s.scheduler.loadAverage[2]; }},
+    {"sched.running", Scheduler, "выполняемых задач (procs_running)",
+     [](const Sample &s) -> double { return s.scheduler.procsRunning; }},
+    {"sched.blocked", Scheduler, "задач, ожидающих ввода-вывода",
+     [](const Sample &s) -> double { return s.scheduler.procsBlocked; }},
+    {"sched.ctxt", Scheduler, "переключений контекста в секунду",
+     [](const Sample &s) -> double { return s.scheduler.contextSwitches; }},
+    {"sched.forks", Scheduler, "созданных задач в секунду",
+     [](const Sample &s) -> double { return s.scheduler.forks; }},
+    {"sched.rundelay", Scheduler,
+     "суммарное ожидание в очередях выполнения, с/с (schedstat)",
+     [](const Sample &s) -> double
+     {
+         double sum = 0;
+         for (const auto &core : s.scheduler.cores)
+         {
+             sum += core.runDelay;
+         }
+         return sum;
+     }},
+    {"sock.tcp", Sockets, "TCP-сокетов",
+     [](const Sample &s) -> double
+     { return s.sockets.tcp4 + s.sockets.tcp6; }},
+    {"sock.udp", Sockets, "UDP-сокетов",
+     [](const Sample &s) -> double
+     { return s.sockets.udp4 + s.sockets.udp6; }},
+    {"sock.estab", Sockets, "установленных TCP-соединений",
+     [](const Sample &s) -> double
+     { return s.sockets[TCPState::Established]; }},
+    {"sock.timewait", Sockets, "TCP-сокетов в TIME_WAIT",
+     [](const Sample &s) -> double
+     { return s.sockets[TCPState::TimeWait]; }},
+    {"sock.listen", Sockets, "слушающих TCP-сокетов",
+     [](const Sample &s) -> double { return s.sockets[TCPState::Listen]; }},
+    {"sock.retrans", Sockets, "TCP-сокетов с неподтвержденным повтором",
+     [](const Sample &s) -> double { return s.sockets.retransmitting; }},
+    {"thermal.max", Thermal, "максимальная температура зон и датчиков, C",
+     [](const Sample &s) -> double
+     {
+         float result = 0;
+         for (const auto &zone : s.thermal.zones)
+         {
+             result = std::max(result, zone.temperature);
+         }
+         for (const auto &sensor : s.thermal.temperatures)
+         {
+             result = std::max(result, sensor.value);
+         }
+         return result;
+     }},
+    {"power.watts", Thermal, "мощность доменов RAPL верхнего уровня, Вт",
+     [](const Sample &s) -> double
+     {
+         // Вложенные домены ("intel-rapl:0:1") уже входят в пакет
+         double sum = 0;
+         for (const auto &zone : s.thermal.power)
+         {
+             if (std::count(zone.path.begin(), zone.path.end(), ':') == 1)
+             {
+                 sum += zone.power;
+             }
+         }
+         return sum;
+     }},
+    {"irq.total", Interrupts, "аппаратных прерываний в секунду",
+     [](const Sample &s) -> double
+     {
+         return perSecond(rowsSum(s.interrupts.interrupts, nullptr),
+                          s.interrupts.interval);
+     }},
+    {"irq.soft", Interrupts, "программных прерываний в секунду",
+     [](const Sample &s) -> double
+     {
+         return perSecond(rowsSum(s.interrupts.softirqs, nullptr),
+                          s.interrupts.interval);
+     }},
+    {"irq.netrx", Interrupts, "программных прерываний NET_RX в секунду",
+     [](const Sample &s) -> double
+     {
+         return perSecond(rowsSum(s.interrupts.softirqs, "NET_RX"),
+                          s.interrupts.interval);
+     }},
+};
+
+const char *DEFAULT_FIELDS =
+    "cpu.load,cpu.user,cpu.system,cpu.iowait,mem.free,sched.load1,"
+    "sched.running,sched.ctxt";
+
+enum class Format
+{
+    Table,
+    JSON,
+    CSV,
+    Binary
+};
+
+// Заголовок таблицы повторяется через это количество строк
+constexpr unsigned TABLE_HEADER_PERIOD = 20;
+
+// Заголовок бинарного потока: сигнатура и версия формата
+constexpr char BINARY_MAGIC[8] = {'S', 'P', 'C', 'L', 'I', 0, 0, 1};
+
+volatile std::sig_atomic_t stopRequested = 0;
+
+void onSignal(int) { stopRequested = 1; }
+
+// Продвигает момент следующего замера на период. Если замер занял больше
+// периода или процесс был приостановлен, прошедшие моменты пропускаются, а
+// не выполняются подряд без пауз, и о пропуске сообщается в stderr
+void advance(std::chrono::steady_clock::time_point &next,
+             std::chrono::steady_clock::duration period)
+{
+    next += period;
+    const auto now = std::chrono::steady_clock::now();
+    if (next >= now || period <= std::chrono::steady_clock::duration::zero())
+    {
+        return;
+    }
+    const auto missed = (now - next) / period + 1;
+    next += missed * period;
+    std::fprintf(stderr, "sysprobe: пропущено замеров: %lld\n",
+                 static_cast<long long>(missed));
+}
+
+void sample(info::ProbeUtilities &probe, unsigned groups, Sample &output)
+{
+    if (groups & CPU)
+    {
+        output.cpu = probe.getCPUTimes();
+    }
+    if (groups & Memory)
+    {
+        output.memory = probe.getMemoryInfo();
+    }
+    if (groups & VM)
+    {
+        output.vm = probe.getVMInfo();
+    }
+    if (groups & Scheduler)
+    {
+        output.scheduler = probe.getSchedulerInfo();
+    }
+    if (groups & Sockets)
+    {
+        output.sockets = probe.getSocketInfo();
+    }
+    if (groups & Thermal)
+    {
+        output.thermal = probe.getThermalInfo();
+    }
+    if (groups & Interrupts)
+    {
+        probe.getInterruptInfo(output.interrupts);
+    }
+}
+
+void appendNumber(std::string &out, double value, bool json)
+{
+    if (!std::isfinite(value))
+    {
+        out += json ? "null" : "nan";
+        return;
+    }
+    char buffer[32];
+    int size;
+    if (value == static_cast<int64_t>(value) && value < 1e15 && value > -1e15)
+    {
+        size = std::snprintf(buffer, sizeof(buffer), "%lld",
+                             static_cast<long long>(value));
+    }
+    else
+    {
+        size = std::snprintf(buffer, sizeof(buffer), "%.2f", value);
+    }
+    out.append(buffer, size);
+}
+
+void appendPadded(std::string &out, const std::string &text, std::size_t width)
+{
+    if (text.size() < width)
+    {
+        out.append(width - text.size(), ' ');
+    }
+    out += text;
+}
+
+void appendTime(std::string &out, std::chrono::system_clock::time_point time)
+{
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                  time.time_since_epoch())
+                  .count();
+    char buffer[32];
+    int size = std::snprintf(buffer, sizeof(buffer), "%lld.%03lld",
+                             static_cast<long long>(ms / 1000),
+                             static_cast<long long>(ms % 1000));
+    out.append(buffer, size);
+}
+
+template <typename T> void appendRaw(std::string &out, const T &value)
+{
+    out.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+void printUsage(std::FILE *stream)
+{
+    std::fputs(
+        "Использование: sysprobe [параметры]\n"
+        "  --interval <с>      период опроса в секундах (по умолчанию 1)\n"
+        "  --count <n>         количество замеров, 0 - без ограничения\n"
+        "  --fields <a,b,...>  выводимые поля (см. --list)\n"
+        "  --format <формат>   table, json, csv или binary\n"
+        "  --sysroot <путь>    корень /proc и /sys\n"
+        "  --record <файл>     записать прочитанные данные\n"
+        "  --replay <файл>     воспроизвести записанные данные\n"
+#ifndef _WIN32
+        "  --publish <имя>     публиковать снимки в разделяемой памяти\n"
+        "                      вместо вывода (см. SharedSnapshot.hpp)\n"
+        "  --store <дир>       дописывать замеры в историю на диске\n"
+        "                      (см. MetricStore.hpp)\n"
+#endif
+        "  --alert <правило>   сообщать в stderr о срабатывании правила,\n"
+        "                      например cpu.load>90~5@30s (см. RuleEngine.hpp);\n"
+        "                      можно указать несколько раз\n"
+        "  --list              список полей\n"
+        "  --help              эта справка\n",
+        stream);
+}
+
+#ifndef _WIN32
+int publish(const std::string &name, const info::ProbeOptions &options,
+            std::chrono::steady_clock::duration period,
+            unsigned long long count, bool replaying)
+{
+    info::SnapshotPublisher publisher(name, options);
+    if (!publisher.valid())
+    {
+        std::fprintf(stderr, "sysprobe: не удалось создать сегмент %s\n",
+                     name.c_str());
+        return 1;
+    }
+    auto next = std::chrono::steady_clock::now();
+    for (unsigned long long tick = 0; !stopRequested && (!count || tick < count);
+         ++tick)
+    {
+        if (!replaying)
+        {
+            advance(next, period);
+            std::this_thread::sleep_until(next);
+        }
+        if (!stopRequested)
+        {
+            publisher.publish();
+        }
+    }
+    return 0;
+}
+#endif
+
+const Field *findField(const std::string &name)
+{
+    for (const auto &field : FIELDS)
+    {
+        if (name == field.name)
+        {
+            return &field;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    double interval = 1;
+    unsigned long long count = 0;
+    std::string fieldList = DEFAULT_FIELDS;
+    Format format = Format::Table;
+    info::ProbeOptions options;
+    std::string publishName;
+    std::string storeDirectory;
+    std::vector<std::string> alertSpecs;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i], value;
+        auto eq = arg.find('=');
+        bool inlineValue = eq != std::string::npos;
+        if (inlineValue)
+        {
+            value = arg.substr(eq + 1);
+            arg.resize(eq);
+        }
+
+        if (arg == "--help" || arg == "-h")
+        {
+            printUsage(stdout);
+            return 0;
+        }
+        if (arg == "--list")
+        {
+            for (const auto &field : FIELDS)
+            {
+                std::printf("%-16s %s\n", field.name, field.description);
+            }
+            return 0;
+        }
+
+        if (!inlineValue)
+        {
+            if (i + 1 >= argc)
+            {
+                std::fprintf(stderr, "sysprobe: %s требует значения\n",
+                             arg.c_str());
+                return 2;
+            }
+            value = argv[++i];
+        }
+
+        char *end = nullptr;
+        if (arg == "--interval")
+        {
+            interval = std::strtod(value.c_str(), &end);
+            if (*end != '\0' || !(interval > 0))
+            {
+                std::fprintf(stderr, "sysprobe: неверный период: %s\n",
+                             value.c_str());
+                return 2;
+            }
+        }
+        else if (arg == "--count")
+        {
+            count = std::strtoull(value.c_str(), &end, 10);
+            if (value.empty() || *end != '\0')
+            {
+                std::fprintf(stderr, "sysprobe: неверное количество: %s\n",
+                             value.c_str());
+                return 2;
+            }
+        }
+        else if (arg == "--fields")
+        {
+            fieldList = value;
+        }
+        else if (arg == "--format")
+        {
+            if (value == "table")
+            {
+                format = Format::Table;
+            }
+            else if (value == "json")
+            {
+                format = Format::JSON;
+            }
+            else if (value == "csv")
+            {
+                format = Format::CSV;
+            }
+            else if (value == "binary")
+            {
+                format = Format::Binary;
+            }
+            else
+            {
+                std::fprintf(stderr, "sysprobe: неизвестный формат: %s\n",
+                             value.c_str());
+                return 2;
+            }
+        }
+        else if (arg == "--alert")
+        {
+            alertSpecs.push_back(value);
+        }
+        else if (arg == "--sysroot")
+        {
+            options.sysroot = value;
+        }
+        else if (arg == "--record")
+        {
+            options.recordPath = value;
+        }
+        else if (arg == "--replay")
+        {
+            options.replayPath = value;
+        }
+#ifndef _WIN32
+        else if (arg == "--publish")
+        {
+            publishName = value;
+        }
+        else if (arg == "--store")
+        {
+            storeDirectory = value;
+        }
+#endif
+        else
+        {
+            std::fprintf(stderr, "sysprobe: неизвестный параметр: %s\n",
+                         arg.c_str());
+            printUsage(stderr);
+            return 2;
+        }
+    }
+
+    std::vector<const Field *> fields;
+    unsigned groups = 0;
+    for (std::size_t begin = 0; begin <= fieldList.size();)
+    {
+        std::size_t end = fieldList.find(',', begin);
+        if (end == std::string::npos)
+        {
+            end = fieldList.size();
+        }
+        std::string name = fieldList.substr(begin, end - begin);
+        begin = end + 1;
+        if (name.empty())
+        {
+            continue;
+        }
+        const Field *field = findField(name);
+        if (!field)
+        {
+            std::fprintf(stderr, "sysprobe: неизвестное поле: %s\n",
+                         name.c_str());
+            return 2;
+        }
+        fields.push_back(field);
+        groups |= field->group;
+    }
+    if (fields.empty())
+    {
+        std::fprintf(stderr, "sysprobe: не выбрано ни одного поля\n");
+        return 2;
+    }
+
+    // Поля правил опрашиваются, даже если не выводятся
+    info::RuleEngine alerts;
+    std::vector<std::pair<const Field *, std::size_t>> alertFields;
+    for (const auto &spec : alertSpecs)
+    {
+        info::AlertRule rule;
+        if (!info::AlertRule::parse(spec, rule))
+        {
+            std::fprintf(stderr, "sysprobe: неверное правило: %s\n",
+                         spec.c_str());
+            return 2;
+        }
+        const Field *field = findField(rule.metric);
+        if (!field)
+        {
+            std::fprintf(stderr, "sysprobe: неизвестное поле: %s\n",
+                         rule.metric.c_str());
+            return 2;
+        }
+        groups |= field->group;
+        const std::size_t id = alerts.metric(rule.metric);
+        if (std::none_of(alertFields.begin(), alertFields.end(),
+                         [&](const auto &entry) { return entry.second == id; }))
+        {
+            alertFields.emplace_back(field, id);
+        }
+        alerts.addRule(std::move(rule),
+                       [](const info::AlertEvent &event)
+                       {
+                           std::fprintf(stderr, "sysprobe: %s %s (%.2f)\n",
+                                        event.rule.name.c_str(),
+                                        event.firing ? "сработало" : "снято",
+                                        event.value);
+                       });
+    }
+
+    // Точкой отсчета служит начальный замер ниже, ждать внутри методов
+    // не нужно
+    options.warmupDelay = std::chrono::milliseconds::zero();
+    bool replaying = !options.replayPath.empty();
+
+    auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(interval));
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+#ifdef _WIN32
+    if (format == Format::Binary)
+    {
+        _setmode(_fileno(stdout), _O_BINARY);
+    }
+#else
+    if (!publishName.empty())
+    {
+        return publish(publishName, options, period, count, replaying);
+    }
+#endif
+
+#ifndef _WIN32
+    std::unique_ptr<info::MetricStore> store;
+    std::vector<double> stored;
+    if (!storeDirectory.empty())
+    {
+        std::vector<info::SeriesSpec> series;
+        for (const Field *field : fields)
+        {
+            series.push_back({field->name, info::SeriesKind::Gauge});
+        }
+        store = std::make_unique<info::MetricStore>(storeDirectory,
+                                                    std::move(series));
+        if (!store->valid())
+        {
+            std::fprintf(stderr, "sysprobe: не удалось создать сегмент в %s\n",
+                         storeDirectory.c_str());
+            return 1;
+        }
+    }
+#endif
+
+    info::ProbeUtilities probe(options);
+    Sample current;
+    sample(probe, groups, current);
+
+    std::vector<std::string> names;
+    std::size_t width = 0;
+    for (const Field *field : fields)
+    {
+        names.emplace_back(field->name);
+        width = std::max(width, names.back().size());
+    }
+    width = std::max<std::size_t>(width, 10);
+
+    std::string out;
+    if (format == Format::CSV)
+    {
+        out += "time";
+        for (const auto &name : names)
+        {
+            out += ',';
+            out += name;
+        }
+        out += '\n';
+    }
+    else if (format == Format::Binary)
+    {
+        out.append(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+        appendRaw(out, static_cast<uint32_t>(names.size()));
+        for (const auto &name : names)
+        {
+            out.append(name.c_str(), name.size() + 1);
+        }
+    }
+
+    auto next = std::chrono::steady_clock::now();
+    for (unsigned long long tick = 0; !stopRequested && (!count || tick < count);
+         ++tick)
+    {
+        // Следующий момент отсчитывается от предыдущего, а не от конца
+        // замера, поэтому время опроса не накапливает сдвиг
+        if (replaying)
+        {
+            next += period;
+        }
+        else
+        {
+            advance(next, period);
+            std::this_thread::sleep_until(next);
+        }
+        if (stopRequested)
+        {
+            break;
+        }
+        // Время правил - момент замера: при воспроизведении оно идет с
+        // записанным периодом, а не со скоростью чтения файла
+        const auto sampled =
+            replaying ? next : std::chrono::steady_clock::now();
+        sample(probe, groups, current);
+        auto now = std::chrono::system_clock::now();
+        for (const auto &[field, id] : alertFields)
+        {
+            alerts.update(id, sampled, field->get(current));
+        }
+#ifndef _WIN32
+        if (store)
+        {
+            stored.clear();
+            for (const Field *field : fields)
+            {
+                stored.push_back(field->get(current));
+            }
+            store->append(now, stored);
+        }
+#endif
+
+        switch (format)
+        {
+        case Format::Table:
+            if (tick % TABLE_HEADER_PERIOD == 0)
+            {
+                for (std::size_t i = 0; i < names.size(); ++i)
+                {
+                    appendPadded(out, names[i], width + (i ? 1 : 0));
+                }
+                out += '\n';
+            }
+            for (std::size_t i = 0; i < fields.size(); ++i)
+            {
+                std::string number;
+                appendNumber(number, fields[i]->get(current), false);
+                appendPadded(out, number, width + (i ? 1 : 0));
+            }
+            out += '\n';
+            break;
+        case Format::CSV:
+            appendTime(out, now);
+            for (const Field *field : fields)
+            {
+                out += ',';
+                appendNumber(out, field->get(current), false);
+            }
+            out += '\n';
+            break;
+        case Format::JSON:
+            out += "{\"time\":";
+            appendTime(out, now);
+            for (std::size_t i = 0; i < fields.size(); ++i)
+            {
+                out += ",\"";
+                out += names[i];
+                out += "\":";
+                appendNumber(out, fields[i]->get(current), true);
+            }
+            out += "}\n";
+            break;
+        case Format::Binary:
+            appendRaw(out, static_cast<int64_t>(
+                               std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                   now.time_since_epoch())
+                                   .count()));
+            for (const Field *field : fields)
+            {
+                appendRaw(out, field->get(current));
+            }
+            break;
+        }
+
+        if (std::fwrite(out.data(), 1, out.size(), stdout) != out.size() ||
+            std::fflush(stdout) != 0)
+        {
+            // Читатель закрыл поток
+            return 1;
+        }
+        out.clear();
+    }
+    return 0;
+}